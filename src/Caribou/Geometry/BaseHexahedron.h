@@ -184,6 +184,9 @@ private:
                IN_CLOSED_INTERVAL(-1-eps, v, 1+eps) and
                IN_CLOSED_INTERVAL(-1-eps, w, 1+eps);
     }
+    inline auto get_clamped_local_coordinates(const LocalCoordinates & xi) const -> LocalCoordinates {
+        return xi.cwiseMax(-1).cwiseMin(1);
+    }
 
     /**
     * Test if the cube intersects the given 3D segment (in the hexahedron's local coordinates).
@@ -151,6 +151,9 @@ private:
         return IN_CLOSED_INTERVAL(-1-eps, u, 1+eps) and
                IN_CLOSED_INTERVAL(-1-eps, v, 1+eps);
     }
+    inline auto get_clamped_local_coordinates(const LocalCoordinates & xi) const -> LocalCoordinates {
+        return xi.cwiseMax(-1).cwiseMin(1);
+    }
 
     auto self() -> Derived& { return *static_cast<Derived*>(this); }
     auto self() const -> const Derived& { return *static_cast<const Derived*>(this); }
@@ -92,6 +92,11 @@ private:
     inline auto get_center() const {return p_center;};
     [[nodiscard]]
     inline auto get_number_of_boundary_elements() const -> UNSIGNED_INTEGER_TYPE {return 4;};
+    inline auto get_local_coordinates(const WorldCoordinates & coordinates) const -> LocalCoordinates {
+        // Inverse of T: rotation back into the frame of the quad, followed by a scaling
+        const WorldCoordinates p = p_R.transpose() * (coordinates - p_center);
+        return p.template head<CanonicalDimension>().cwiseQuotient(p_H / 2.);
+    }
 
     auto self() -> Derived& { return *static_cast<Derived*>(this); }
     auto self() const -> const Derived& { return *static_cast<const Derived*>(this); }
@@ -67,6 +67,9 @@ private:
         const auto & u = xi[0];
         return IN_CLOSED_INTERVAL(-1-eps, u, 1+eps);
     }
+    inline auto get_clamped_local_coordinates(const LocalCoordinates & xi) const -> LocalCoordinates {
+        return xi.cwiseMax(-1).cwiseMin(1);
+    }
 
     template <size_t index, typename ...Nodes, REQUIRES(sizeof...(Nodes) >= 1)>
     inline
@@ -117,6 +117,9 @@ private:
         const auto & w = xi[2];
         return (u > -eps) and (v > -eps) and (w > -eps) and (1 - u - v - w > -eps);
     }
+    inline auto get_clamped_local_coordinates(const LocalCoordinates & xi) const -> LocalCoordinates {
+        return closest_point_of_canonical_simplex(xi);
+    }
 
     auto self() -> Derived& { return *static_cast<Derived*>(this); }
     auto self() const -> const Derived& { return *static_cast<const Derived*>(this); }
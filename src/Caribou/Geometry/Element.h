@@ -4,6 +4,8 @@
 #include <Caribou/traits.h>
 #include <Caribou/macros.h>
 #include <Eigen/Dense>
+#include <algorithm>
+#include <functional>
 #include <vector>
 
 #include <iostream>
@@ -24,6 +26,44 @@ struct element_has_boundaries : std::false_type {};
 template< class T>
 constexpr bool element_has_boundaries_v = element_has_boundaries<T>::value;
 
+/**
+ * Test whether or not the transformation T(xi) -> x of the Element type T is affine (ie, its Jacobian is constant).
+ *
+ * This is done by looking into the traits<T> and verify if it has a constant named IsAffine set to true.
+ */
+template<class T, class Enable = void>
+struct element_is_affine : std::false_type {};
+
+template< class T>
+constexpr bool element_is_affine_v = element_is_affine<T>::value;
+
+/**
+ * Get the point of the canonical simplex {xi >= 0, sum(xi) <= 1} closest to the given local coordinates. This is used
+ * to clamp the local coordinates of the simplicial elements (triangles and tetrahedrons).
+ */
+template <typename Derived>
+inline auto closest_point_of_canonical_simplex(const Eigen::MatrixBase<Derived> & xi) -> typename Derived::PlainObject {
+    using Scalar = typename Derived::Scalar;
+    const typename Derived::PlainObject positive = xi.cwiseMax(Scalar(0));
+    if (positive.sum() <= 1) {
+        return positive;
+    }
+
+    // Otherwise, the closest point lies on the face sum(xi) = 1. Its coordinates are max(xi - theta, 0), where the
+    // shift theta is found from the coordinates sorted in decreasing order.
+    typename Derived::PlainObject sorted = xi;
+    std::sort(sorted.data(), sorted.data() + sorted.size(), std::greater<>());
+    Scalar sum = 0, theta = 0;
+    for (Eigen::Index i = 0; i < sorted.size(); ++i) {
+        sum += sorted[i];
+        const auto t = (sum - 1) / static_cast<Scalar>(i + 1);
+        if (sorted[i] > t) {
+            theta = t;
+        }
+    }
+    return (xi.array() - theta).cwiseMax(Scalar(0)).matrix();
+}
+
 template<typename Derived, typename ScalarType = FLOATING_POINT_TYPE>
 struct Element {
     // Types
@@ -159,7 +199,11 @@ struct Element {
     }
 
     /**
-     * Get the local coordinates of a point from its world coordinates by doing a set of Newton-Raphson iterations.
+     * Get the local coordinates of a point from its world coordinates.
+     *
+     * For affine elements (see element_is_affine), the transformation is inverted in closed form:
+     * \f$ \vec{\xi}_p = \mathrm{J}^{-1} (\vec{x}_p - T(\vec{0})) \f$. Otherwise, this is done by a set of Newton-Raphson
+     * iterations.
      *
      * \sa local_coordinates() for more details.
      *
@@ -167,7 +211,7 @@ struct Element {
      *       The iterations will stop at 5 iterations, or if the norm o*       f relative residual |R|/|R0| is less than 1e-5.
      */
     inline auto local_coordinates(const WorldCoordinates & coordinates) const -> LocalCoordinates {
-        return local_coordinates(coordinates, LocalCoordinates::Constant(0), 1e-5, 5);
+        return self().get_local_coordinates(coordinates);
     }
 
     /**
@@ -244,14 +288,8 @@ struct Element {
 
         // Start the iterations
         do {
-            Matrix<Dimension, CanonicalDimension> J = jacobian(xi);
-
             LocalCoordinates dxi;
-            if constexpr (Dimension == CanonicalDimension) {
-                dxi.noalias() = J.inverse() * residual;
-            } else {
-                dxi.noalias() = (J.transpose()*J).inverse() * (J.transpose()*residual);
-            }
+            dxi.noalias() = inverse_jacobian(xi) * residual;
 
             xi.noalias() = (xi + dxi).eval();
             residual.noalias() = coordinates - world_coordinates(xi);
@@ -273,6 +311,15 @@ struct Element {
         return self().get_contains_local(xi, eps);
     }
 
+    /**
+     * Get the local coordinates of the point of the element closest (in local coordinates) to the given ones. Local
+     * coordinates inside the element are returned unchanged, while the ones outside are clamped onto its boundaries.
+     * @param xi Local coordinates of a point
+     */
+    inline auto clamped_local_coordinates(const LocalCoordinates & xi) const -> LocalCoordinates {
+        return self().get_clamped_local_coordinates(xi);
+    }
+
     /**
      * Interpolate a value at local coordinates from the given interpolation node values.
      *
@@ -379,7 +426,33 @@ struct Element {
         const auto shape_derivatives = self().dL(coordinates);
         return self().nodes().transpose() * shape_derivatives;
     }
+
+    /**
+     * Compute the inverse of the Jacobian matrix of the transformation T(xi)-> x evaluated at local coordinates xi. For
+     * non-matching manifolds (for example, a triangle in a 3D manifold), this is the pseudo-inverse
+     * \f$ (\mathrm{J}^T\mathrm{J})^{-1} \mathrm{J}^T \f$.
+     */
+    inline auto inverse_jacobian (const LocalCoordinates & coordinates) const -> Eigen::Matrix<Scalar, CanonicalDimension, Dimension>
+    {
+        const Matrix<Dimension, CanonicalDimension> J = jacobian(coordinates);
+        if constexpr (Dimension == CanonicalDimension) {
+            return J.inverse();
+        } else {
+            return (J.transpose()*J).inverse() * J.transpose();
+        }
+    }
 private:
+    // Default implementations (can be overridden by the derived elements)
+    inline auto get_local_coordinates(const WorldCoordinates & coordinates) const -> LocalCoordinates {
+        if constexpr (element_is_affine_v<Derived>) {
+            // T(xi) = T(0) + J xi, with the constant Jacobian J
+            const LocalCoordinates origin = LocalCoordinates::Zero();
+            return inverse_jacobian(origin) * (coordinates - world_coordinates(origin));
+        } else {
+            return local_coordinates(coordinates, LocalCoordinates::Constant(0), 1e-5, 5);
+        }
+    }
+
     auto self() -> Derived& { return *static_cast<Derived*>(this); }
     auto self() const -> const Derived& { return *static_cast<const Derived*>(this); }
 };
@@ -393,5 +466,13 @@ struct element_has_boundaries<T, CLASS_REQUIRES(
     caribou::internal::is_detected_v<element_boundary_type_t, T>
 )> : std::true_type {};
 
+template <class T>
+using element_is_affine_t = decltype(traits<T>::IsAffine);
+
+template<class T>
+struct element_is_affine<T, CLASS_REQUIRES(
+    caribou::internal::is_detected_v<element_is_affine_t, T>
+)> : std::bool_constant<traits<T>::IsAffine> {};
+
 
 }  /// namespace caribou::geometry
\ No newline at end of file
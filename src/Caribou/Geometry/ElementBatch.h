@@ -0,0 +1,259 @@
+#pragma once
+
+#include <Caribou/config.h>
+#include <Caribou/constants.h>
+#include <Caribou/macros.h>
+#include <Caribou/Geometry/Element.h>
+#include <Eigen/Core>
+
+#include <array>
+
+namespace caribou::geometry {
+
+/**
+ * Batch of elements of the same type stored as a structure of arrays, one element per lane.
+ *
+ * The geometric quantities of an element (Jacobian, determinant, shape derivatives w.r.t. the world coordinates)
+ * are evaluated for every element of the batch at once. The entry (i, j) of a per-element matrix is a contiguous
+ * array of BatchSize values (one per element), hence every arithmetic operation fills complete SIMD registers,
+ * instead of the partially filled ones of the small (e.g. 3x3) fixed-size matrices of a single element. The shape
+ * functions and their derivatives w.r.t. the local coordinates do not depend on the nodes of an element, and are
+ * therefore evaluated once per batch.
+ *
+ * Example:
+ * \code{.cpp}
+ * ElementBatch<Tetrahedron<Linear>, 8> batch;
+ * for (std::size_t i = 0; i < 8; ++i) {
+ *     batch.push_back(domain->element(first_element + i));
+ * }
+ * const auto & xi = batch.reference_element().gauss_node(0).position;
+ * ElementBatch<Tetrahedron<Linear>, 8>::Lanes detJ;
+ * ElementBatch<Tetrahedron<Linear>, 8>::BatchMatrix<4, 3> dN_dx;
+ * batch.evaluate(xi, detJ, dN_dx);
+ * // detJ[i] and dN_dx.row(i) are the determinant and the (column-major) shape derivatives of the ith element
+ * \endcode
+ *
+ * @tparam ElementType The type of the elements.
+ * @tparam BatchSize The number of elements of the batch (4, 8 or 16 are well suited for SIMD registers of doubles).
+ */
+template <typename ElementType, INTEGER_TYPE BatchSize = 8>
+class ElementBatch {
+public:
+    static_assert(BatchSize > 0, "The batch must contain at least one element.");
+    static_assert(traits<ElementType>::NumberOfNodesAtCompileTime != caribou::Dynamic,
+                  "The number of nodes of the elements must be known at compile time.");
+
+    static constexpr INTEGER_TYPE CanonicalDimension = traits<ElementType>::CanonicalDimension;
+    static constexpr INTEGER_TYPE Dimension = traits<ElementType>::Dimension;
+    static constexpr INTEGER_TYPE NumberOfNodes = traits<ElementType>::NumberOfNodesAtCompileTime;
+
+    using Scalar = typename ElementType::Scalar;
+    using LocalCoordinates = typename ElementType::LocalCoordinates;
+
+    /** One value per element of the batch. */
+    using Lanes = Eigen::Array<Scalar, BatchSize, 1>;
+
+    /**
+     * One Rows x Cols matrix per element of the batch. The row k contains the matrix of the kth element stored
+     * column-major, i.e. the column i + Rows*j contains the entries (i, j) of the matrices of every elements.
+     */
+    template <INTEGER_TYPE Rows, INTEGER_TYPE Cols>
+    using BatchMatrix = Eigen::Matrix<Scalar, BatchSize, Rows*Cols>;
+
+    ElementBatch() = default;
+
+    /** Maximum number of elements of the batch. */
+    static constexpr auto capacity() -> INTEGER_TYPE { return BatchSize; }
+
+    /** Number of elements added to the batch. */
+    inline auto size() const -> INTEGER_TYPE { return p_size; }
+
+    /** Remove every element of the batch. */
+    inline void clear() { p_size = 0; }
+
+    /**
+     * Add an element to the batch. The lanes not used yet are filled with the first element, hence all the lanes of a
+     * partially filled batch hold valid (non degenerated) elements, and their results can simply be ignored.
+     */
+    inline void push_back(const ElementType & element) {
+        caribou_assert(p_size < BatchSize);
+
+        const auto nodes = element.nodes();
+        for (INTEGER_TYPE axis = 0; axis < Dimension; ++axis) {
+            if (p_size == 0) {
+                p_nodes[axis].rowwise() = nodes.col(axis).transpose();
+            } else {
+                p_nodes[axis].row(p_size) = nodes.col(axis).transpose();
+            }
+        }
+        ++p_size;
+    }
+
+    /** Element at the canonical position, used to evaluate the quantities that do not depend on the nodes. */
+    static auto reference_element() -> const ElementType & {
+        static const ElementType e;
+        return e;
+    }
+
+    /** Jacobians of the transformations from the local coordinates to the world coordinates, evaluated at xi. */
+    inline auto jacobians(const LocalCoordinates & xi) const -> BatchMatrix<Dimension, CanonicalDimension> {
+        return jacobians_from(reference_element().dL(xi));
+    }
+
+    /**
+     * Determinants of the Jacobians. For manifold elements (when the canonical dimension is lower than the world
+     * dimension), this is the generalized determinant sqrt(det(J^T J)).
+     */
+    static inline auto determinants(const BatchMatrix<Dimension, CanonicalDimension> & J) -> Lanes {
+        if constexpr (Dimension == CanonicalDimension) {
+            return square_determinants<Dimension>(J);
+        } else {
+            return square_determinants<CanonicalDimension>(normal_matrices(J)).sqrt();
+        }
+    }
+
+    /**
+     * Inverses of the Jacobians. For manifold elements, this is the pseudo-inverse (J^T J)^-1 J^T.
+     */
+    static inline auto inverses(const BatchMatrix<Dimension, CanonicalDimension> & J) -> BatchMatrix<CanonicalDimension, Dimension> {
+        if constexpr (Dimension == CanonicalDimension) {
+            return square_inverses<Dimension>(J);
+        } else {
+            // (J^T J)^-1 J^T
+            const auto G_inv = square_inverses<CanonicalDimension>(normal_matrices(J));
+            BatchMatrix<CanonicalDimension, Dimension> J_inv = BatchMatrix<CanonicalDimension, Dimension>::Zero();
+            for (INTEGER_TYPE i = 0; i < CanonicalDimension; ++i) {
+                for (INTEGER_TYPE j = 0; j < Dimension; ++j) {
+                    for (INTEGER_TYPE k = 0; k < CanonicalDimension; ++k) {
+                        J_inv.col(i + CanonicalDimension*j).array() +=
+                            G_inv.col(i + CanonicalDimension*k).array() * J.col(j + Dimension*k).array();
+                    }
+                }
+            }
+            return J_inv;
+        }
+    }
+
+    /**
+     * Derivatives of the shape functions w.r.t. the world coordinates evaluated at xi (dN_dx = dL(xi) J^-1), from the
+     * (pseudo-)inverses of the Jacobians.
+     */
+    static inline auto shape_derivatives(const LocalCoordinates & xi, const BatchMatrix<CanonicalDimension, Dimension> & J_inv)
+    -> BatchMatrix<NumberOfNodes, Dimension> {
+        return shape_derivatives_from(reference_element().dL(xi), J_inv);
+    }
+
+    /**
+     * Evaluate at xi the determinants of the Jacobians and the derivatives of the shape functions w.r.t. the world
+     * coordinates of every element of the batch. These are the quantities usually stored for every integration
+     * point of an element.
+     */
+    inline void evaluate(const LocalCoordinates & xi, Lanes & determinants_of_J, BatchMatrix<NumberOfNodes, Dimension> & dN_dx) const {
+        const auto dL = reference_element().dL(xi);
+        const auto J = jacobians_from(dL);
+        determinants_of_J = determinants(J);
+        dN_dx = shape_derivatives_from(dL, inverses(J));
+    }
+
+    /** Get the matrix of the kth element of the batch from a batch matrix. */
+    template <INTEGER_TYPE Rows, INTEGER_TYPE Cols>
+    static inline auto matrix_of(const BatchMatrix<Rows, Cols> & M, const INTEGER_TYPE & k) -> Eigen::Matrix<Scalar, Rows, Cols> {
+        return Eigen::Map<const Eigen::Matrix<Scalar, Rows, Cols>, Eigen::Unaligned, Eigen::Stride<BatchSize*Rows, BatchSize>>(M.data() + k);
+    }
+
+private:
+    using ShapeDerivatives = Eigen::Matrix<Scalar, NumberOfNodes, CanonicalDimension>;
+
+    /** Jacobians from the derivatives of the shape functions w.r.t. the local coordinates. */
+    inline auto jacobians_from(const ShapeDerivatives & dL) const -> BatchMatrix<Dimension, CanonicalDimension> {
+        // J(i, j) = sum_n x_n(i) * dL_n(j) for every elements
+        BatchMatrix<Dimension, CanonicalDimension> J;
+        for (INTEGER_TYPE i = 0; i < Dimension; ++i) {
+            for (INTEGER_TYPE j = 0; j < CanonicalDimension; ++j) {
+                J.col(i + Dimension*j).noalias() = p_nodes[i] * dL.col(j);
+            }
+        }
+        return J;
+    }
+
+    /** Derivatives of the shape functions w.r.t. the world coordinates, from their derivatives w.r.t. the local ones. */
+    static inline auto shape_derivatives_from(const ShapeDerivatives & dL, const BatchMatrix<CanonicalDimension, Dimension> & J_inv)
+    -> BatchMatrix<NumberOfNodes, Dimension> {
+        BatchMatrix<NumberOfNodes, Dimension> dN_dx = BatchMatrix<NumberOfNodes, Dimension>::Zero();
+        for (INTEGER_TYPE n = 0; n < NumberOfNodes; ++n) {
+            for (INTEGER_TYPE j = 0; j < Dimension; ++j) {
+                for (INTEGER_TYPE k = 0; k < CanonicalDimension; ++k) {
+                    dN_dx.col(n + NumberOfNodes*j) += dL(n, k) * J_inv.col(k + CanonicalDimension*j);
+                }
+            }
+        }
+        return dN_dx;
+    }
+
+    /** J^T J of every elements. */
+    static inline auto normal_matrices(const BatchMatrix<Dimension, CanonicalDimension> & J) -> BatchMatrix<CanonicalDimension, CanonicalDimension> {
+        BatchMatrix<CanonicalDimension, CanonicalDimension> G = BatchMatrix<CanonicalDimension, CanonicalDimension>::Zero();
+        for (INTEGER_TYPE i = 0; i < CanonicalDimension; ++i) {
+            for (INTEGER_TYPE j = 0; j < CanonicalDimension; ++j) {
+                for (INTEGER_TYPE k = 0; k < Dimension; ++k) {
+                    G.col(i + CanonicalDimension*j).array() += J.col(k + Dimension*i).array() * J.col(k + Dimension*j).array();
+                }
+            }
+        }
+        return G;
+    }
+
+    /** Determinants of N x N matrices (N <= 3), from their cofactors. */
+    template <INTEGER_TYPE N>
+    static inline auto square_determinants(const BatchMatrix<N, N> & A) -> Lanes {
+        const auto a = [&A](INTEGER_TYPE i, INTEGER_TYPE j) { return A.col(i + N*j).array(); };
+        if constexpr (N == 1) {
+            return a(0, 0);
+        } else if constexpr (N == 2) {
+            return a(0, 0)*a(1, 1) - a(0, 1)*a(1, 0);
+        } else {
+            static_assert(N == 3, "Only matrices up to 3x3 are supported.");
+            return a(0, 0)*(a(1, 1)*a(2, 2) - a(1, 2)*a(2, 1))
+                 - a(0, 1)*(a(1, 0)*a(2, 2) - a(1, 2)*a(2, 0))
+                 + a(0, 2)*(a(1, 0)*a(2, 1) - a(1, 1)*a(2, 0));
+        }
+    }
+
+    /** Inverses of N x N matrices (N <= 3), from their adjugates. */
+    template <INTEGER_TYPE N>
+    static inline auto square_inverses(const BatchMatrix<N, N> & A) -> BatchMatrix<N, N> {
+        const auto a = [&A](INTEGER_TYPE i, INTEGER_TYPE j) { return A.col(i + N*j).array(); };
+        const Lanes inverse_of_determinants = square_determinants<N>(A).inverse();
+
+        BatchMatrix<N, N> A_inv;
+        const auto set = [&A_inv, &inverse_of_determinants](INTEGER_TYPE i, INTEGER_TYPE j, const Lanes & cofactor) {
+            A_inv.col(i + N*j).array() = cofactor * inverse_of_determinants;
+        };
+
+        if constexpr (N == 1) {
+            set(0, 0, Lanes::Ones());
+        } else if constexpr (N == 2) {
+            set(0, 0,  a(1, 1)); set(0, 1, -a(0, 1));
+            set(1, 0, -a(1, 0)); set(1, 1,  a(0, 0));
+        } else {
+            static_assert(N == 3, "Only matrices up to 3x3 are supported.");
+            set(0, 0, a(1, 1)*a(2, 2) - a(1, 2)*a(2, 1));
+            set(0, 1, a(0, 2)*a(2, 1) - a(0, 1)*a(2, 2));
+            set(0, 2, a(0, 1)*a(1, 2) - a(0, 2)*a(1, 1));
+            set(1, 0, a(1, 2)*a(2, 0) - a(1, 0)*a(2, 2));
+            set(1, 1, a(0, 0)*a(2, 2) - a(0, 2)*a(2, 0));
+            set(1, 2, a(0, 2)*a(1, 0) - a(0, 0)*a(1, 2));
+            set(2, 0, a(1, 0)*a(2, 1) - a(1, 1)*a(2, 0));
+            set(2, 1, a(0, 1)*a(2, 0) - a(0, 0)*a(2, 1));
+            set(2, 2, a(0, 0)*a(1, 1) - a(0, 1)*a(1, 0));
+        }
+        return A_inv;
+    }
+
+    /// Coordinates of the nodes: p_nodes[axis](k, n) is the coordinate along the given axis of the node n of the
+    /// kth element of the batch
+    std::array<Eigen::Matrix<Scalar, BatchSize, NumberOfNodes>, Dimension> p_nodes {};
+    INTEGER_TYPE p_size = 0;
+};
+
+} // namespace caribou::geometry
@@ -17,6 +17,7 @@ struct traits<RectangularHexahedron <Linear>> {
     static constexpr UNSIGNED_INTEGER_TYPE Dimension = 3;
     static constexpr INTEGER_TYPE NumberOfNodesAtCompileTime = 8;
     static constexpr INTEGER_TYPE NumberOfGaussNodesAtCompileTime = 8;
+    static constexpr bool IsAffine = true;
 
     using BoundaryElementType = RectangularQuad<3, Linear>;
     static constexpr INTEGER_TYPE NumberOfBoundaryElementsAtCompileTime = 6;
@@ -194,6 +195,7 @@ struct traits<RectangularHexahedron <Quadratic>> {
     static constexpr UNSIGNED_INTEGER_TYPE Dimension = 3;
     static constexpr INTEGER_TYPE NumberOfNodesAtCompileTime = 20;
     static constexpr INTEGER_TYPE NumberOfGaussNodesAtCompileTime = 4;
+    static constexpr bool IsAffine = true;
 
     using BoundaryElementType = RectangularQuad<3, Quadratic>;
     static constexpr INTEGER_TYPE NumberOfBoundaryElementsAtCompileTime = 6;
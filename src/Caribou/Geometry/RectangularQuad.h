@@ -19,6 +19,7 @@ struct traits<RectangularQuad <_Dimension, Linear>> {
     static constexpr UNSIGNED_INTEGER_TYPE Dimension = _Dimension;
     static constexpr INTEGER_TYPE NumberOfNodesAtCompileTime = 4;
     static constexpr INTEGER_TYPE NumberOfGaussNodesAtCompileTime = 4;
+    static constexpr bool IsAffine = true;
 
     using BoundaryElementType = Segment<_Dimension, Linear>;
     static constexpr INTEGER_TYPE NumberOfBoundaryElementsAtCompileTime = 4;
@@ -158,6 +159,7 @@ struct traits<RectangularQuad <_Dimension, Quadratic>> {
     static constexpr UNSIGNED_INTEGER_TYPE Dimension = _Dimension;
     static constexpr INTEGER_TYPE NumberOfNodesAtCompileTime = 8;
     static constexpr INTEGER_TYPE NumberOfGaussNodesAtCompileTime = 8;
+    static constexpr bool IsAffine = true;
 
     using BoundaryElementType = Segment<_Dimension, Quadratic>;
     static constexpr INTEGER_TYPE NumberOfBoundaryElementsAtCompileTime = 4;
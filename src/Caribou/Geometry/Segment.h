@@ -15,6 +15,7 @@ template<UNSIGNED_INTEGER_TYPE _Dimension>
      static constexpr UNSIGNED_INTEGER_TYPE Dimension = _Dimension;
      static constexpr INTEGER_TYPE NumberOfNodesAtCompileTime = 2;
      static constexpr INTEGER_TYPE NumberOfGaussNodesAtCompileTime = 1;
+     static constexpr bool IsAffine = true;
  };
 
 /**
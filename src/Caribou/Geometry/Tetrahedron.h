@@ -17,6 +17,7 @@ struct traits<Tetrahedron <Linear>> {
     static constexpr UNSIGNED_INTEGER_TYPE Dimension = 3;
     static constexpr INTEGER_TYPE NumberOfNodesAtCompileTime = 4;
     static constexpr INTEGER_TYPE NumberOfGaussNodesAtCompileTime = 1;
+    static constexpr bool IsAffine = true;
 
     using BoundaryElementType = Triangle<3, Linear>;
     static constexpr INTEGER_TYPE NumberOfBoundaryElementsAtCompileTime = 4;
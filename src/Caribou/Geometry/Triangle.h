@@ -17,6 +17,7 @@ struct traits<Triangle <_Dimension, Linear>> {
     static constexpr UNSIGNED_INTEGER_TYPE Dimension = _Dimension;
     static constexpr INTEGER_TYPE NumberOfNodesAtCompileTime = 3;
     static constexpr INTEGER_TYPE NumberOfGaussNodesAtCompileTime = 1;
+    static constexpr bool IsAffine = true;
 
     using BoundaryElementType = Segment<_Dimension, Linear>;
     static constexpr INTEGER_TYPE NumberOfBoundaryElementsAtCompileTime = 3;
@@ -23,7 +23,7 @@ auto grid(py::module & m, const std::string & name) {
     o.def(py::init<FLOATING_POINT_TYPE>(), py::arg("cell_size"));
     o.def(py::init<FLOATING_POINT_TYPE, UNSIGNED_INTEGER_TYPE>(), py::arg("cell_size"), py::arg("number_of_elements"));
     o.def("add", &HashGrid<Element>::add);
-    o.def("get", &HashGrid<Element>::get, py::arg("p"));
+    o.def("get", static_cast<std::set<typename HashGrid<Element>::Index> (HashGrid<Element>::*)(const typename HashGrid<Element>::WorldCoordinates &) const>(&HashGrid<Element>::get), py::arg("p"));
     return o;
 }
 
@@ -0,0 +1,386 @@
+#pragma once
+
+#include <Caribou/config.h>
+#include <Caribou/Geometry/Element.h>
+#include <Caribou/Topology/HashGrid.h>
+#include <Caribou/Topology/ParallelSort.h>
+#include <Eigen/Core>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace caribou::topology {
+
+/**
+ * \class BVH
+ *
+ * Bounding volume hierarchy (tree of axis-aligned bounding boxes) of a set of elements.
+ *
+ * Contrary to the HashGrid and the FlatHashGrid, which use one cell size for the whole domain, the BVH adapts to the
+ * local size of the elements. It is hence better suited for meshes having highly non-uniform element sizes (for
+ * example, adaptively refined meshes), where the large elements would otherwise be inserted into a large number of
+ * cells, and the small ones would crowd the same cells.
+ *
+ * The tree is a linear BVH: the elements are ordered along a Z-order curve using the Morton code of the center of
+ * their bounding box, and grouped by LeafSize consecutive elements into the leaves. The upper levels are then built
+ * bottom-up by merging the boxes of pairs of consecutive nodes, giving a balanced tree. The Morton codes, their
+ * sorting and every levels of the tree are computed in parallel when OpenMP is available.
+ */
+template <typename Element>
+class BVH {
+public:
+
+    static constexpr UNSIGNED_INTEGER_TYPE Dimension = caribou::geometry::traits<Element>::Dimension;
+
+    /// Maximum number of elements in a leaf of the tree
+    static constexpr std::size_t LeafSize = 4;
+
+    using Index = UNSIGNED_INTEGER_TYPE;
+    using MortonCode = std::uint64_t;
+    using WorldCoordinates = Eigen::Matrix<FLOATING_POINT_TYPE, Dimension, 1>;
+
+    BVH() = default;
+
+    /**
+     * Build the tree from a set of elements. Any previously added elements are removed.
+     *
+     * @param number_of_elements The number of elements.
+     * @param element_of A callable returning the element of a given identifier (usually its index within a topology).
+     *                   It is called concurrently from multiple threads when OpenMP is available.
+     */
+    template <typename ElementAccessor>
+    void build(const Index & number_of_elements, const ElementAccessor & element_of) {
+        std::vector<WorldCoordinates> lower_corners (number_of_elements), upper_corners (number_of_elements);
+
+#ifdef CARIBOU_WITH_OPENMP
+        #pragma omp parallel for
+#endif
+        for (INTEGER_TYPE id = 0; id < static_cast<INTEGER_TYPE>(number_of_elements); ++id) {
+            const Element e = element_of(static_cast<Index>(id));
+            const auto nodes = e.nodes();
+            lower_corners[id] = nodes.colwise().minCoeff().transpose();
+            upper_corners[id] = nodes.colwise().maxCoeff().transpose();
+        }
+
+        build(lower_corners, upper_corners);
+    }
+
+    /**
+     * Build the tree from the (precomputed) axis-aligned bounding boxes of a set of elements. The identifier of an
+     * element is the index of its bounding box. Any previously added elements are removed.
+     *
+     * @param lower_corners The lowest corner of the bounding box of every elements.
+     * @param upper_corners The highest corner of the bounding box of every elements.
+     */
+    void build(const std::vector<WorldCoordinates> & lower_corners, const std::vector<WorldCoordinates> & upper_corners) {
+        caribou_assert(lower_corners.size() == upper_corners.size());
+
+        p_elements.clear();
+        p_elements_lower.clear();
+        p_elements_upper.clear();
+        p_lower.clear();
+        p_upper.clear();
+        p_level_offsets.assign(1, 0);
+
+        const auto number_of_elements = lower_corners.size();
+        if (number_of_elements == 0) {
+            return;
+        }
+
+        const auto n = static_cast<INTEGER_TYPE>(number_of_elements);
+
+        // Bounds of the centers of the elements, and size of the domain
+        WorldCoordinates centers_min = WorldCoordinates::Constant(std::numeric_limits<FLOATING_POINT_TYPE>::max());
+        WorldCoordinates centers_max = WorldCoordinates::Constant(std::numeric_limits<FLOATING_POINT_TYPE>::lowest());
+        WorldCoordinates domain_min = centers_min;
+        WorldCoordinates domain_max = centers_max;
+
+#ifdef CARIBOU_WITH_OPENMP
+        #pragma omp parallel
+#endif
+        {
+            WorldCoordinates local_centers_min = WorldCoordinates::Constant(std::numeric_limits<FLOATING_POINT_TYPE>::max());
+            WorldCoordinates local_centers_max = WorldCoordinates::Constant(std::numeric_limits<FLOATING_POINT_TYPE>::lowest());
+            WorldCoordinates local_domain_min = local_centers_min;
+            WorldCoordinates local_domain_max = local_centers_max;
+
+#ifdef CARIBOU_WITH_OPENMP
+            #pragma omp for
+#endif
+            for (INTEGER_TYPE id = 0; id < n; ++id) {
+                const WorldCoordinates center = (lower_corners[id] + upper_corners[id]) / 2.;
+                local_centers_min = local_centers_min.cwiseMin(center);
+                local_centers_max = local_centers_max.cwiseMax(center);
+                local_domain_min = local_domain_min.cwiseMin(lower_corners[id]);
+                local_domain_max = local_domain_max.cwiseMax(upper_corners[id]);
+            }
+
+#ifdef CARIBOU_WITH_OPENMP
+            #pragma omp critical
+#endif
+            {
+                centers_min = centers_min.cwiseMin(local_centers_min);
+                centers_max = centers_max.cwiseMax(local_centers_max);
+                domain_min = domain_min.cwiseMin(local_domain_min);
+                domain_max = domain_max.cwiseMax(local_domain_max);
+            }
+        }
+
+        // Points lying at a distance smaller than this tolerance from the box of an element are considered inside
+        p_tolerance = RelativeTolerance * std::max(static_cast<FLOATING_POINT_TYPE>(1), (domain_max - domain_min).maxCoeff());
+
+        // Morton code of the center of every elements
+        const WorldCoordinates extent = centers_max - centers_min;
+        std::vector<std::pair<MortonCode, Index>> codes (number_of_elements);
+
+#ifdef CARIBOU_WITH_OPENMP
+        #pragma omp parallel for
+#endif
+        for (INTEGER_TYPE id = 0; id < n; ++id) {
+            const WorldCoordinates center = (lower_corners[id] + upper_corners[id]) / 2.;
+            std::array<MortonCode, Dimension> q {};
+            for (UNSIGNED_INTEGER_TYPE axis = 0; axis < Dimension; ++axis) {
+                const FLOATING_POINT_TYPE x = (extent[axis] > 0) ? (center[axis] - centers_min[axis]) / extent[axis] : 0.;
+                q[axis] = static_cast<MortonCode>(std::clamp(x, 0., 1.) * static_cast<FLOATING_POINT_TYPE>(MaximumQuantizedCoordinate));
+            }
+            codes[id] = {morton_code(q), static_cast<Index>(id)};
+        }
+
+        parallel_sort(codes);
+
+        // Elements (and their boxes) in the order of the leaves
+        p_elements.resize(number_of_elements);
+        p_elements_lower.resize(number_of_elements);
+        p_elements_upper.resize(number_of_elements);
+
+#ifdef CARIBOU_WITH_OPENMP
+        #pragma omp parallel for
+#endif
+        for (INTEGER_TYPE i = 0; i < n; ++i) {
+            const auto & id = codes[i].second;
+            p_elements[i] = id;
+            p_elements_lower[i] = lower_corners[id];
+            p_elements_upper[i] = upper_corners[id];
+        }
+
+        // Leaves
+        const auto number_of_leaves = (number_of_elements + LeafSize - 1) / LeafSize;
+        p_lower.resize(number_of_leaves);
+        p_upper.resize(number_of_leaves);
+
+#ifdef CARIBOU_WITH_OPENMP
+        #pragma omp parallel for
+#endif
+        for (INTEGER_TYPE leaf = 0; leaf < static_cast<INTEGER_TYPE>(number_of_leaves); ++leaf) {
+            const auto begin = static_cast<std::size_t>(leaf) * LeafSize;
+            const auto end = std::min(begin + LeafSize, number_of_elements);
+            p_lower[leaf] = p_elements_lower[begin];
+            p_upper[leaf] = p_elements_upper[begin];
+            for (auto i = begin + 1; i < end; ++i) {
+                p_lower[leaf] = p_lower[leaf].cwiseMin(p_elements_lower[i]);
+                p_upper[leaf] = p_upper[leaf].cwiseMax(p_elements_upper[i]);
+            }
+        }
+        p_level_offsets.emplace_back(number_of_leaves);
+
+        // Upper levels, up to the root node
+        while (number_of_nodes_at(number_of_levels() - 1) > 1) {
+            const auto children_level = number_of_levels() - 1;
+            const auto children_offset = p_level_offsets[children_level];
+            const auto number_of_children = number_of_nodes_at(children_level);
+            const auto number_of_parents = (number_of_children + 1) / 2;
+            const auto parents_offset = p_level_offsets.back();
+
+            p_lower.resize(parents_offset + number_of_parents);
+            p_upper.resize(parents_offset + number_of_parents);
+
+#ifdef CARIBOU_WITH_OPENMP
+            #pragma omp parallel for
+#endif
+            for (INTEGER_TYPE parent = 0; parent < static_cast<INTEGER_TYPE>(number_of_parents); ++parent) {
+                const auto first_child = children_offset + 2*static_cast<std::size_t>(parent);
+                p_lower[parents_offset + parent] = p_lower[first_child];
+                p_upper[parents_offset + parent] = p_upper[first_child];
+                if (2*static_cast<std::size_t>(parent) + 1 < number_of_children) {
+                    p_lower[parents_offset + parent] = p_lower[parents_offset + parent].cwiseMin(p_lower[first_child + 1]);
+                    p_upper[parents_offset + parent] = p_upper[parents_offset + parent].cwiseMax(p_upper[first_child + 1]);
+                }
+            }
+            p_level_offsets.emplace_back(parents_offset + number_of_parents);
+        }
+    }
+
+    /**
+     * Get all the elements having a bounding box that contains the point p. Note that the returned elements do not
+     * ensure that the point p resides inside of them. One has to further check each ones of them with an
+     * intersection test.
+     */
+    inline
+    auto get(const WorldCoordinates & p) const -> std::set<Index> {
+        std::set<Index> elements;
+        for_each_element_near(p, [&elements](const Index & element_id) {
+            elements.emplace(element_id);
+        });
+
+        return elements;
+    }
+
+    /**
+     * Call f(element_id) for every element having a bounding box that contains the point p, without any allocation.
+     * Each element is visited at most once.
+     */
+    template <typename Function>
+    inline
+    void for_each_element_near(const WorldCoordinates & p, Function && f) const {
+        traverse([this, &p](const WorldCoordinates & lower, const WorldCoordinates & upper) {
+            return box_contains(lower, upper, p);
+        }, f);
+    }
+
+    /**
+     * Call f(element_id) for every element having a bounding box that intersects the axis-aligned box
+     * [lower_corner, upper_corner], without any allocation. Each element is visited at most once.
+     */
+    template <typename Function>
+    inline
+    void for_each_element_in_box(const WorldCoordinates & lower_corner, const WorldCoordinates & upper_corner, Function && f) const {
+        traverse([this, &lower_corner, &upper_corner](const WorldCoordinates & lower, const WorldCoordinates & upper) {
+            return boxes_intersect(lower, upper, lower_corner, upper_corner);
+        }, f);
+    }
+
+    /**
+     * Get the elements having a bounding box that contains the point p, into the given set. The set is cleared first.
+     * Contrary to get(p), no allocation is made as long as the number of candidates fits the inline storage of the set.
+     */
+    template <std::size_t Capacity>
+    inline
+    void get(const WorldCoordinates & p, SmallIndexSet<Index, Capacity> & elements) const {
+        elements.clear();
+        for_each_element_near(p, [&elements](const Index & element_id) {
+            elements.insert(element_id);
+        });
+    }
+
+    /**
+     * Get the elements having a bounding box that intersects the axis-aligned box [lower_corner, upper_corner], into
+     * the given set. The set is cleared first.
+     */
+    template <std::size_t Capacity>
+    inline
+    void get(const WorldCoordinates & lower_corner, const WorldCoordinates & upper_corner, SmallIndexSet<Index, Capacity> & elements) const {
+        elements.clear();
+        for_each_element_in_box(lower_corner, upper_corner, [&elements](const Index & element_id) {
+            elements.insert(element_id);
+        });
+    }
+
+    /** Number of levels of the tree (the leaves being the level 0). */
+    inline auto number_of_levels() const -> std::size_t { return p_level_offsets.size() - 1; }
+
+    /** Total number of nodes of the tree (including its leaves). */
+    inline auto number_of_nodes() const -> std::size_t { return p_level_offsets.back(); }
+
+private:
+    /// Number of bits of the quantized coordinates used by the Morton codes
+    static constexpr unsigned int BitsPerAxis = std::min<unsigned int>(21, 63 / Dimension);
+    static constexpr MortonCode MaximumQuantizedCoordinate = (MortonCode(1) << BitsPerAxis) - 1;
+
+    /// Tolerance of the point-in-box tests, relative to the size of the domain (same as the default tolerance of
+    /// Element::contains_local)
+    static constexpr FLOATING_POINT_TYPE RelativeTolerance = 1e-10;
+
+    /// Upper bound of the number of levels of the tree (the number of nodes halves at every level)
+    static constexpr std::size_t MaximumNumberOfLevels = 64;
+
+    /**
+     * Call f(element_id) for every element having a bounding box accepted by overlaps(lower, upper), visiting only the
+     * nodes of the tree having a bounding box also accepted by it.
+     */
+    template <typename Overlaps, typename Function>
+    inline
+    void traverse(const Overlaps & overlaps, Function & f) const {
+        if (p_elements.empty()) {
+            return;
+        }
+
+        // Depth-first traversal, each stack entry being a (level, node index within the level) pair
+        std::array<std::pair<std::size_t, std::size_t>, 2*MaximumNumberOfLevels> stack;
+        std::size_t stack_size = 0;
+
+        const auto root_level = number_of_levels() - 1;
+        if (overlaps(p_lower[p_level_offsets[root_level]], p_upper[p_level_offsets[root_level]])) {
+            stack[stack_size++] = {root_level, 0};
+        }
+
+        while (stack_size > 0) {
+            const auto [level, node] = stack[--stack_size];
+
+            if (level == 0) {
+                // Leaf node
+                const auto begin = node * LeafSize;
+                const auto end = std::min(begin + LeafSize, p_elements.size());
+                for (auto i = begin; i < end; ++i) {
+                    if (overlaps(p_elements_lower[i], p_elements_upper[i])) {
+                        f(p_elements[i]);
+                    }
+                }
+                continue;
+            }
+
+            // Push the children in reverse order, to visit them following the order of the elements
+            const auto child_level = level - 1;
+            const auto first_child = 2*node;
+            for (auto child = std::min(first_child + 2, number_of_nodes_at(child_level)); child-- > first_child;) {
+                const auto k = p_level_offsets[child_level] + child;
+                if (overlaps(p_lower[k], p_upper[k])) {
+                    stack[stack_size++] = {child_level, child};
+                }
+            }
+        }
+    }
+
+    /** Interleave the bits of the quantized coordinates of a point. */
+    static inline auto morton_code(const std::array<MortonCode, Dimension> & q) -> MortonCode {
+        MortonCode code = 0;
+        for (unsigned int bit = 0; bit < BitsPerAxis; ++bit) {
+            for (UNSIGNED_INTEGER_TYPE axis = 0; axis < Dimension; ++axis) {
+                code |= ((q[axis] >> bit) & MortonCode(1)) << (bit*Dimension + axis);
+            }
+        }
+        return code;
+    }
+
+    inline auto number_of_nodes_at(const std::size_t & level) const -> std::size_t {
+        return p_level_offsets[level+1] - p_level_offsets[level];
+    }
+
+    inline auto box_contains(const WorldCoordinates & lower, const WorldCoordinates & upper, const WorldCoordinates & p) const -> bool {
+        return ((p - lower).array() >= -p_tolerance).all() and ((upper - p).array() >= -p_tolerance).all();
+    }
+
+    inline auto boxes_intersect(const WorldCoordinates & lower_a, const WorldCoordinates & upper_a,
+                                const WorldCoordinates & lower_b, const WorldCoordinates & upper_b) const -> bool {
+        return ((upper_a - lower_b).array() >= -p_tolerance).all() and ((upper_b - lower_a).array() >= -p_tolerance).all();
+    }
+
+    FLOATING_POINT_TYPE p_tolerance = RelativeTolerance;
+
+    /// Elements sorted by the Morton code of their center, and their bounding boxes. The leaf i contains the elements
+    /// p_elements[i*LeafSize] ... p_elements[(i+1)*LeafSize - 1]
+    std::vector<Index> p_elements;
+    std::vector<WorldCoordinates> p_elements_lower;
+    std::vector<WorldCoordinates> p_elements_upper;
+
+    /// Bounding boxes of the nodes of the tree, level by level, starting from the leaves. The ith node of the level l
+    /// is stored at p_level_offsets[l] + i, and its children are the nodes 2i and 2i+1 of the level l-1
+    std::vector<WorldCoordinates> p_lower;
+    std::vector<WorldCoordinates> p_upper;
+    std::vector<std::size_t> p_level_offsets = {0};
+};
+
+} // namespace caribou::topology
@@ -1,17 +1,37 @@
 #pragma once
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <vector>
 #include <unordered_map>
+#include <set>
 
 #include <Caribou/config.h>
 #include <Caribou/macros.h>
 #include <Caribou/constants.h>
+#include <Caribou/Geometry/ElementBatch.h>
 #include <Caribou/Topology/Domain.h>
 #include <Caribou/Topology/HashGrid.h>
+#include <Caribou/Topology/FlatHashGrid.h>
+#include <Caribou/Topology/BVH.h>
 
 namespace caribou::topology {
 
+/**
+ * Spatial index used to find the candidate elements containing a point.
+ */
+enum class SpatialIndex {
+    /** HashGrid: unordered map from the cells to the vectors of their elements. */
+    HashGrid,
+
+    /** FlatHashGrid: sorted (cell, element) pairs in a compressed layout, built in parallel. */
+    FlatHashGrid,
+
+    /** BVH: tree of the element bounding boxes, suited for highly non-uniform element sizes, built in parallel. */
+    BVH
+};
+
 /**
  * \class BarycentricContainer
  *
@@ -20,7 +40,8 @@ namespace caribou::topology {
  * be found in exactly one of the element of the container, or at the boundary between elements (for example, an
  * embedded node lying on a face between two elements of the container is valid). If an embedded node
  * is lying outside of the container domain (ie is not located inside any of the container
- * elements), the BarycentricContainer will ignore it. The list of ignored nodes can be retrieved.
+ * elements), the BarycentricContainer will ignore it. The list of ignored nodes can be retrieved. Alternatively, these
+ * outside nodes can be attached to their closest element (see BarycentricContainer::project_outside_nodes).
  *
  * @tparam Domain The type of the container domain.
  */
@@ -34,6 +55,10 @@ public:
     using LocalCoordinates = typename ContainerElement::LocalCoordinates;
     using WorldCoordinates = typename ContainerElement::WorldCoordinates;
     using HashGridT = HashGrid<ContainerElement>;
+    using FlatHashGridT = FlatHashGrid<ContainerElement>;
+    using BVHT = BVH<ContainerElement>;
+    using CandidateSet = SmallIndexSet<UNSIGNED_INTEGER_TYPE>;
+    using InverseJacobian = Eigen::Matrix<FLOATING_POINT_TYPE, ContainerElement::CanonicalDimension, Dimension>;
 
     /**
      * A barycentric point is a structure that contains the element index and
@@ -54,9 +79,9 @@ public:
     BarycentricContainer() = delete;
 
     /**
-     * Construct the container from the given domain. This will create an HashGrid class instance to be able
-     * to quickly retrieve the container element of a given world position. The size of the HashGrid cells will
-     * be set to the mean size of the container elements.
+     * Construct the container from the given domain. This will create a spatial index (by default, an HashGrid class
+     * instance) to be able to quickly retrieve the container element of a given world position. The size of the cells
+     * of the HashGrid and FlatHashGrid will be set to the mean size of the container elements.
      *
      * This constructs the BarycentricContainer with a set of embedded points where the barycentric coordinates
      * will be computed.
@@ -65,45 +90,89 @@ public:
      * @param container_domain The mesh domain that will contain the embedded meshes.
      * @param embedded_points The positions (in world coordinates) embedded in the container mesh for which the barycentric
      *                        points have to be found.
+     * @param spatial_index The spatial index used to find the candidate elements containing a point.
      */
     template <typename Derived>
-    BarycentricContainer(const Domain * container_domain, const Eigen::MatrixBase<Derived> & embedded_points)
-    : BarycentricContainer(container_domain) {
+    BarycentricContainer(const Domain * container_domain, const Eigen::MatrixBase<Derived> & embedded_points,
+                         const SpatialIndex & spatial_index = SpatialIndex::HashGrid)
+    : BarycentricContainer(container_domain, spatial_index) {
         // Set the embedded points
         set_embedded_points(embedded_points);
     }
 
     /**
-     * Construct the container from the given domain. This will create an HashGrid class instance to be able
-     * to quickly retrieve the container element of a given world position. The size of the HashGrid cells will
-     * be set to the mean size of the container elements.
+     * Construct the container from the given domain. This will create a spatial index (by default, an HashGrid class
+     * instance) to be able to quickly retrieve the container element of a given world position. The size of the cells
+     * of the HashGrid and FlatHashGrid will be set to the mean size of the container elements.
      *
      * @param container_domain The mesh domain that will contain the embedded nodes.
+     * @param spatial_index The spatial index used to find the candidate elements containing a point.
      */
-    explicit BarycentricContainer(const Domain * container_domain)
+    explicit BarycentricContainer(const Domain * container_domain,
+                                  const SpatialIndex & spatial_index = SpatialIndex::HashGrid)
         : p_container_domain(container_domain) {
         if (container_domain->number_of_elements() == 0) {
             throw std::runtime_error("Trying to create a barycentric container from an empty domain.");
         }
 
-        // Get the mean size of the elements
+        // Get the bounding box of every elements (each element is only constructed once), their mean size, and the
+        // bounding box of the domain
         using Scalar = typename WorldCoordinates::Scalar;
-        WorldCoordinates H_mean = WorldCoordinates::Zero();
         const auto number_of_elements = container_domain->number_of_elements();
-        for (std::size_t element_id = 0; element_id < number_of_elements; ++element_id) {
-            const ContainerElement element = container_domain->element(element_id);
-            const auto element_nodes = element.nodes();
-            const auto min = element_nodes.colwise().minCoeff();
-            const auto max = element_nodes.colwise().maxCoeff();
-            H_mean += (max - min);
-        }
-        H_mean /= static_cast<Scalar>(container_domain->number_of_elements());
-
-        // Create the Hash grid
-        p_hash_grid = std::make_unique<HashGridT>(H_mean.maxCoeff(), container_domain->number_of_elements());
+        const auto n = static_cast<INTEGER_TYPE>(number_of_elements);
+        std::vector<WorldCoordinates> lower_corners (number_of_elements), upper_corners (number_of_elements);
+        WorldCoordinates H_mean = WorldCoordinates::Zero();
+        p_domain_lower_corner = WorldCoordinates::Constant(std::numeric_limits<Scalar>::max());
+        p_domain_upper_corner = WorldCoordinates::Constant(std::numeric_limits<Scalar>::lowest());
+
+#ifdef CARIBOU_WITH_OPENMP
+        #pragma omp parallel
+#endif
+        {
+            WorldCoordinates local_H = WorldCoordinates::Zero();
+            WorldCoordinates local_lower_corner = WorldCoordinates::Constant(std::numeric_limits<Scalar>::max());
+            WorldCoordinates local_upper_corner = WorldCoordinates::Constant(std::numeric_limits<Scalar>::lowest());
+
+#ifdef CARIBOU_WITH_OPENMP
+            #pragma omp for
+#endif
+            for (INTEGER_TYPE element_id = 0; element_id < n; ++element_id) {
+                const ContainerElement element = container_domain->element(static_cast<UNSIGNED_INTEGER_TYPE>(element_id));
+                const auto element_nodes = element.nodes();
+                lower_corners[element_id] = element_nodes.colwise().minCoeff().transpose();
+                upper_corners[element_id] = element_nodes.colwise().maxCoeff().transpose();
+                local_H += upper_corners[element_id] - lower_corners[element_id];
+                local_lower_corner = local_lower_corner.cwiseMin(lower_corners[element_id]);
+                local_upper_corner = local_upper_corner.cwiseMax(upper_corners[element_id]);
+            }
 
-        for (UNSIGNED_INTEGER_TYPE element_id = 0; element_id < container_domain->number_of_elements(); ++element_id) {
-            p_hash_grid->add(container_domain->element(element_id), element_id);
+#ifdef CARIBOU_WITH_OPENMP
+            #pragma omp critical
+#endif
+            {
+                H_mean += local_H;
+                p_domain_lower_corner = p_domain_lower_corner.cwiseMin(local_lower_corner);
+                p_domain_upper_corner = p_domain_upper_corner.cwiseMax(local_upper_corner);
+            }
+        }
+        H_mean /= static_cast<Scalar>(number_of_elements);
+        p_mean_element_size = H_mean.maxCoeff();
+
+        // Create the spatial index
+        if (spatial_index == SpatialIndex::BVH) {
+            // Does not depend on the mean size of the elements, built in parallel
+            p_bvh = std::make_unique<BVHT>();
+            p_bvh->build(lower_corners, upper_corners);
+        } else if (spatial_index == SpatialIndex::FlatHashGrid) {
+            // Sort-based build, done in parallel
+            p_flat_hash_grid = std::make_unique<FlatHashGridT>(H_mean.maxCoeff());
+            p_flat_hash_grid->build(lower_corners, upper_corners);
+        } else {
+            // The buckets of the unordered map cannot be filled concurrently
+            p_hash_grid = std::make_unique<HashGridT>(H_mean.maxCoeff(), number_of_elements);
+            for (UNSIGNED_INTEGER_TYPE element_id = 0; element_id < number_of_elements; ++element_id) {
+                p_hash_grid->add(lower_corners[element_id], upper_corners[element_id], element_id);
+            }
         }
     }
 
@@ -120,13 +189,12 @@ public:
      */
     auto barycentric_point(const WorldCoordinates & p) const -> BarycentricPoint {
         // List of candidate elements that could contain the point
-        const auto candidate_element_indices = p_hash_grid->get(p);
-
+        CandidateSet candidate_element_indices;
+        candidate_elements(p, candidate_element_indices);
 
         for (const auto & element_index : candidate_element_indices) {
-            const ContainerElement e = p_container_domain->element(element_index);
-            const LocalCoordinates local_coordinates = e.local_coordinates(p);
-            if (e.contains_local(local_coordinates)) {
+            LocalCoordinates local_coordinates;
+            if (locate(element_index, p, LocalCoordinates::Zero(), local_coordinates)) {
                 // Found one, let's return it
                 return {static_cast<ElementIndex>(element_index), local_coordinates};
             }
@@ -141,11 +209,19 @@ public:
      */
     auto closest_elements(const WorldCoordinates & p) const -> std::vector<BarycentricPoint> {
         // List of candidate elements that could contain the point
-        const auto candidate_element_indices = p_hash_grid->get(p);
+        CandidateSet candidate_element_indices;
+        candidate_elements(p, candidate_element_indices);
 
         std::vector<BarycentricPoint> closest_elements;
         closest_elements.reserve(candidate_element_indices.size());
         for (const auto & element_index : candidate_element_indices) {
+            if constexpr (caribou::geometry::element_is_affine_v<ContainerElement>) {
+                if (inverse_jacobians_are_cached()) {
+                    closest_elements.emplace_back(static_cast<ElementIndex>(element_index), cached_local_coordinates(element_index, p));
+                    continue;
+                }
+            }
+
             const ContainerElement e = p_container_domain->element(element_index);
             const LocalCoordinates local_coordinates = e.local_coordinates(p);
             closest_elements.emplace_back(static_cast<ElementIndex>(element_index), local_coordinates);
@@ -154,6 +230,135 @@ public:
         return closest_elements;
     }
 
+    /**
+     * Get the element closest to the point p (in world coordinates), and the local coordinates of the projection of p
+     * onto this element. The local coordinates of p are clamped onto the element (see
+     * Element::clamped_local_coordinates), hence, for a point outside of the domain, the returned barycentric point
+     * lies on the boundary of the domain. The search box around p queried from the spatial index starts at the mean
+     * size of the elements and grows until an element is found.
+     *
+     * \note For points inside the domain, barycentric_point(p) is much faster.
+     *
+     * @param p The queried point in world coordinates.
+     * @param distance [OUTPUT] The distance between p and its projection onto the closest element.
+     */
+    auto closest_barycentric_point(const WorldCoordinates & p, FLOATING_POINT_TYPE & distance) const -> BarycentricPoint {
+        CandidateSet candidate_element_indices;
+        BarycentricPoint closest;
+        distance = std::numeric_limits<FLOATING_POINT_TYPE>::max();
+
+        for (auto radius = std::max(p_mean_element_size, static_cast<FLOATING_POINT_TYPE>(EPSILON));; radius *= 2) {
+            candidate_elements(p, radius, candidate_element_indices);
+            if (not candidate_element_indices.empty()) {
+                closest = closest_projection(candidate_element_indices, p, distance);
+                if (distance > radius) {
+                    // Elements outside of the queried box, but closer than the one found, may exist
+                    candidate_elements(p, distance, candidate_element_indices);
+                    closest = closest_projection(candidate_element_indices, p, distance);
+                }
+                return closest;
+            }
+
+            if (((p.array() - radius) <= p_domain_lower_corner.array()).all() and ((p.array() + radius) >= p_domain_upper_corner.array()).all()) {
+                // The whole domain was queried
+                return closest;
+            }
+        }
+    }
+
+    /**
+     * Attach every outside node to its closest container element, using the local coordinates of its projection onto
+     * this element (see BarycentricContainer::closest_barycentric_point). Once projected, these nodes are not outside
+     * nodes anymore. The nodes are projected in parallel when OpenMP is available.
+     *
+     * @tparam Derived NXD Eigen matrix representing the D dimensional coordinates of the N embedded positions.
+     * @param embedded_points The positions (in world coordinates) of every embedded points (including the ones
+     *                        inside the domain).
+     * @return The maximum distance between an outside node and its projection, or zero if there are no outside nodes.
+     */
+    template <typename Derived>
+    auto project_outside_nodes(const Eigen::MatrixBase<Derived> & embedded_points) -> FLOATING_POINT_TYPE {
+        if (embedded_points.cols() != Dimension) {
+            throw std::runtime_error("Trying to project " + std::to_string(embedded_points.cols()) + "D points onto a " +
+                                     std::to_string(Dimension) + "D domain");
+        }
+
+        if (static_cast<std::size_t>(embedded_points.rows()) != p_barycentric_points.size()) {
+            throw std::runtime_error("The number of positions (" + std::to_string(embedded_points.rows()) + ") must "
+                                     "match the number of embedded points (" + std::to_string(p_barycentric_points.size()) + ").");
+        }
+
+        FLOATING_POINT_TYPE maximum_distance = 0;
+        const auto number_of_outside_nodes = static_cast<INTEGER_TYPE>(p_outside_nodes.size());
+
+#ifdef CARIBOU_WITH_OPENMP
+        #pragma omp parallel
+#endif
+        {
+            FLOATING_POINT_TYPE local_maximum_distance = 0;
+
+#ifdef CARIBOU_WITH_OPENMP
+            #pragma omp for
+#endif
+            for (INTEGER_TYPE i = 0; i < number_of_outside_nodes; ++i) {
+                const auto & node_id = p_outside_nodes[i];
+                const WorldCoordinates p = embedded_points.row(node_id).transpose().template cast<typename WorldCoordinates::Scalar>();
+                FLOATING_POINT_TYPE distance;
+                p_barycentric_points[node_id] = closest_barycentric_point(p, distance);
+                local_maximum_distance = std::max(local_maximum_distance, distance);
+            }
+
+#ifdef CARIBOU_WITH_OPENMP
+            #pragma omp critical
+#endif
+            maximum_distance = std::max(maximum_distance, local_maximum_distance);
+        }
+
+        // Update the list of outside nodes
+        p_outside_nodes.clear();
+        for (std::size_t node_id = 0; node_id < p_barycentric_points.size(); ++node_id) {
+            if (p_barycentric_points[node_id].element_index < 0) {
+                p_outside_nodes.emplace_back(node_id);
+            }
+        }
+
+        return maximum_distance;
+    }
+
+    /**
+     * Get the barycentric points of a batch of points (in world coordinates). This gives the same results as calling
+     * barycentric_point(p) on every points, but the queries are done in parallel (when OpenMP is available) and
+     * without any memory allocation, the candidate elements being deduplicated in a small inline buffer.
+     *
+     * @tparam Derived NXD Eigen matrix representing the D dimensional coordinates of the N points.
+     * @param points [INPUT] The positions (in world coordinates) of the queried points.
+     * @param barycentric_points [OUTPUT] The barycentric point of every queried point. It must already contain N
+     *                                    entries. See BarycentricContainer::BarycentricPoint for more details.
+     */
+    template <typename Derived>
+    void find_barycentric_points(const Eigen::MatrixBase<Derived> & points, std::vector<BarycentricPoint> & barycentric_points) const {
+        static_assert(Eigen::MatrixBase<Derived>::ColsAtCompileTime == Dimension or Eigen::MatrixBase<Derived>::ColsAtCompileTime == Eigen::Dynamic);
+
+        if (Eigen::MatrixBase<Derived>::ColsAtCompileTime == Eigen::Dynamic and points.cols() != Dimension) {
+            throw std::runtime_error("Trying to get the barycentric coordinates of " +
+                                     std::to_string(points.cols()) + "D points from a " +
+                                     std::to_string(Dimension) + "D domain");
+        }
+
+        if (static_cast<std::size_t>(points.rows()) != barycentric_points.size()) {
+            throw std::runtime_error("The number of barycentric points must be the same as the number of queried points.");
+        }
+
+        const auto number_of_points = points.rows();
+
+#ifdef CARIBOU_WITH_OPENMP
+        #pragma omp parallel for
+#endif
+        for (Eigen::Index i = 0; i < number_of_points; ++i) {
+            barycentric_points[i] = barycentric_point(points.row(i).transpose().template cast<typename WorldCoordinates::Scalar>());
+        }
+    }
+
     /**
      * Interpolate a field (scalar or vector field) from the container domain to the embedded nodes.
      *
@@ -246,7 +451,280 @@ public:
         return p_outside_nodes;
     }
 
+    /**
+     * Update the barycentric points of a subset of the embedded points, for example after a small change of their
+     * positions. Each point is first searched inside its previous element, starting the Newton-Raphson iterations
+     * from its previous local coordinates, and then inside the elements sharing a node with its previous element.
+     * The spatial index is only queried when the point is not found in any of them. The list of outside nodes is
+     * updated accordingly. The points are updated in parallel when OpenMP is available.
+     *
+     * \note When a point lies between two or more elements, the element found may differ from the one that
+     *       barycentric_point(p) would return.
+     *
+     * @param indices The indices of the embedded points to update. An index cannot appear more than once, since the
+     *                points are updated concurrently.
+     * @param positions The new positions (in world coordinates) of these embedded points, one per row.
+     */
+    template <typename Derived>
+    void update_embedded_points(const std::vector<UNSIGNED_INTEGER_TYPE> & indices, const Eigen::MatrixBase<Derived> & positions) {
+        if (positions.cols() != Dimension) {
+            throw std::runtime_error("Trying to update the embedding of " +
+                                     std::to_string(positions.cols()) + "D points in a " +
+                                     std::to_string(Dimension) + "D domain");
+        }
+
+        if (static_cast<std::size_t>(positions.rows()) != indices.size()) {
+            throw std::runtime_error("The number of positions (" + std::to_string(positions.rows()) + ") must match the "
+                                     "number of embedded points to update (" + std::to_string(indices.size()) + ").");
+        }
+
+        std::vector<bool> is_updated (p_barycentric_points.size(), false);
+        for (const auto & index : indices) {
+            if (index >= p_barycentric_points.size()) {
+                throw std::runtime_error("Trying to update the embedded point #" + std::to_string(index) + ", but the "
+                                         "container only has " + std::to_string(p_barycentric_points.size()) + " embedded points.");
+            }
+
+            if (is_updated[index]) {
+                throw std::runtime_error("The embedded point #" + std::to_string(index) + " appears more than once in "
+                                         "the indices of the points to update.");
+            }
+            is_updated[index] = true;
+        }
+
+        if (p_node_elements_offsets.empty()) {
+            compute_node_elements();
+        }
+
+        const auto number_of_points = static_cast<INTEGER_TYPE>(indices.size());
+#ifdef CARIBOU_WITH_OPENMP
+        #pragma omp parallel for
+#endif
+        for (INTEGER_TYPE i = 0; i < number_of_points; ++i) {
+            const WorldCoordinates p = positions.row(i).transpose().template cast<typename WorldCoordinates::Scalar>();
+            auto & barycentric_point = p_barycentric_points[indices[i]];
+            barycentric_point = updated_barycentric_point(barycentric_point, p);
+        }
+
+        // Update the list of outside nodes
+        p_outside_nodes.clear();
+        for (std::size_t node_id = 0; node_id < p_barycentric_points.size(); ++node_id) {
+            if (p_barycentric_points[node_id].element_index < 0) {
+                p_outside_nodes.emplace_back(node_id);
+            }
+        }
+    }
+
+    /**
+     * Cache the inverse of the (constant) Jacobian of every container element, paired to the world position of its
+     * local origin. The local coordinates of the points queried afterward are then computed with one matrix-vector
+     * product per candidate element, without constructing it. This is only available for affine elements (see
+     * caribou::geometry::element_is_affine), and stores (D+1)xD scalars per element. The cache is computed in parallel,
+     * the Jacobians being inverted for batches of elements at once (see caribou::geometry::ElementBatch).
+     *
+     * \warning The cache is not updated if the positions of the container nodes change.
+     */
+    void cache_inverse_jacobians() {
+        static_assert(caribou::geometry::element_is_affine_v<ContainerElement>,
+                      "The inverse Jacobians can only be cached for affine elements.");
+
+        const auto number_of_elements = p_container_domain->number_of_elements();
+        p_inverse_jacobians.resize(number_of_elements);
+        p_origins.resize(number_of_elements);
+
+        // The Jacobians are inverted for batches of elements at once (one element per SIMD lane)
+        using Batch = caribou::geometry::ElementBatch<ContainerElement>;
+        const auto n = static_cast<INTEGER_TYPE>(number_of_elements);
+        const auto number_of_batches = (n + Batch::capacity() - 1) / Batch::capacity();
+
+        const LocalCoordinates origin = LocalCoordinates::Zero();
+#ifdef CARIBOU_WITH_OPENMP
+        #pragma omp parallel for
+#endif
+        for (INTEGER_TYPE batch_id = 0; batch_id < number_of_batches; ++batch_id) {
+            const auto first_element_id = batch_id * Batch::capacity();
+            const auto last_element_id = std::min(first_element_id + Batch::capacity(), n);
+
+            Batch batch;
+            for (INTEGER_TYPE element_id = first_element_id; element_id < last_element_id; ++element_id) {
+                const ContainerElement e = p_container_domain->element(static_cast<UNSIGNED_INTEGER_TYPE>(element_id));
+                batch.push_back(e);
+                p_origins[element_id] = e.world_coordinates(origin);
+            }
+
+            const auto inverse_jacobians = Batch::inverses(batch.jacobians(origin));
+            for (INTEGER_TYPE element_id = first_element_id; element_id < last_element_id; ++element_id) {
+                p_inverse_jacobians[element_id] = Batch::template matrix_of<ContainerElement::CanonicalDimension, Dimension>(
+                    inverse_jacobians, element_id - first_element_id
+                );
+            }
+        }
+    }
+
+    /** Whether or not the inverse Jacobians of the container elements are cached (see cache_inverse_jacobians). */
+    [[nodiscard]]
+    auto inverse_jacobians_are_cached () const -> bool {
+        return not p_inverse_jacobians.empty();
+    }
+
+    /**
+     * Spatial index used to find the candidate elements containing a point.
+     */
+    [[nodiscard]]
+    auto spatial_index () const -> SpatialIndex {
+        if (p_bvh) {
+            return SpatialIndex::BVH;
+        }
+        return p_flat_hash_grid ? SpatialIndex::FlatHashGrid : SpatialIndex::HashGrid;
+    }
+
 private:
+    /**
+     * Compute the local coordinates of the point p within a container element, and test if the element contains it.
+     * For non-affine elements, the Newton-Raphson iterations start at the given local coordinates.
+     */
+    auto locate(const UNSIGNED_INTEGER_TYPE & element_index, const WorldCoordinates & p,
+                const LocalCoordinates & starting_point, LocalCoordinates & local_coordinates) const -> bool {
+        if constexpr (caribou::geometry::element_is_affine_v<ContainerElement>) {
+            if (inverse_jacobians_are_cached()) {
+                // No need to construct the element
+                local_coordinates = cached_local_coordinates(element_index, p);
+                return reference_element().contains_local(local_coordinates);
+            }
+        }
+
+        const ContainerElement e = p_container_domain->element(element_index);
+        if constexpr (caribou::geometry::element_is_affine_v<ContainerElement>) {
+            local_coordinates = e.local_coordinates(p);
+        } else {
+            local_coordinates = e.local_coordinates(p, starting_point, 1e-5, 5);
+        }
+        return e.contains_local(local_coordinates);
+    }
+
+    /**
+     * Find the barycentric point of p, knowing its previous barycentric point: its previous element is tried first,
+     * then the elements sharing a node with it, and finally the candidates of the spatial index.
+     */
+    auto updated_barycentric_point(const BarycentricPoint & previous, const WorldCoordinates & p) const -> BarycentricPoint {
+        if (previous.element_index >= 0) {
+            const auto previous_element = static_cast<UNSIGNED_INTEGER_TYPE>(previous.element_index);
+            LocalCoordinates local_coordinates;
+            if (locate(previous_element, p, previous.local_coordinates, local_coordinates)) {
+                return {previous.element_index, local_coordinates};
+            }
+
+            const auto node_indices = p_container_domain->element_indices(previous_element);
+            for (Eigen::Index n = 0; n < node_indices.size(); ++n) {
+                const auto node = static_cast<std::size_t>(node_indices[n]);
+                for (auto k = p_node_elements_offsets[node]; k < p_node_elements_offsets[node+1]; ++k) {
+                    const auto & element_index = p_node_elements[k];
+                    if (element_index != previous_element and locate(element_index, p, LocalCoordinates::Zero(), local_coordinates)) {
+                        return {static_cast<ElementIndex>(element_index), local_coordinates};
+                    }
+                }
+            }
+        }
+
+        return barycentric_point(p);
+    }
+
+    /** Compute the elements around every node of the container mesh (compressed sparse row layout). */
+    void compute_node_elements() {
+        const auto number_of_nodes = p_container_domain->mesh()->number_of_nodes();
+        const auto number_of_elements = p_container_domain->number_of_elements();
+
+        p_node_elements_offsets.assign(number_of_nodes + 1, 0);
+        for (UNSIGNED_INTEGER_TYPE element_id = 0; element_id < number_of_elements; ++element_id) {
+            const auto node_indices = p_container_domain->element_indices(element_id);
+            for (Eigen::Index n = 0; n < node_indices.size(); ++n) {
+                ++p_node_elements_offsets[static_cast<std::size_t>(node_indices[n]) + 1];
+            }
+        }
+
+        for (std::size_t node = 0; node < number_of_nodes; ++node) {
+            p_node_elements_offsets[node+1] += p_node_elements_offsets[node];
+        }
+
+        p_node_elements.resize(p_node_elements_offsets.back());
+        std::vector<std::size_t> positions (p_node_elements_offsets.begin(), p_node_elements_offsets.end() - 1);
+        for (UNSIGNED_INTEGER_TYPE element_id = 0; element_id < number_of_elements; ++element_id) {
+            const auto node_indices = p_container_domain->element_indices(element_id);
+            for (Eigen::Index n = 0; n < node_indices.size(); ++n) {
+                p_node_elements[positions[static_cast<std::size_t>(node_indices[n])]++] = element_id;
+            }
+        }
+    }
+
+    /** Local coordinates of the point p within an (affine) container element, from its cached inverse Jacobian. */
+    auto cached_local_coordinates(const UNSIGNED_INTEGER_TYPE & element_index, const WorldCoordinates & p) const -> LocalCoordinates {
+        return p_inverse_jacobians[element_index] * (p - p_origins[element_index]);
+    }
+
+    /** Element used to test if local coordinates are inside the canonical element, which does not depend on its nodes. */
+    static auto reference_element() -> const ContainerElement & {
+        static const ContainerElement e;
+        return e;
+    }
+
+    /**
+     * Get the elements that could contain the point p, using the spatial index of the container. The candidates are
+     * sorted by index, hence the first element found containing a point does not depend on the spatial index.
+     */
+    void candidate_elements(const WorldCoordinates & p, CandidateSet & candidates) const {
+        if (p_bvh) {
+            p_bvh->get(p, candidates);
+        } else if (p_flat_hash_grid) {
+            p_flat_hash_grid->get(p, candidates);
+        } else {
+            p_hash_grid->get(p, candidates);
+        }
+        candidates.sort();
+    }
+
+    /**
+     * Get the elements that could lie at a distance smaller than the given radius from the point p, using the spatial
+     * index of the container. The queried box is clipped to the bounding box of the domain.
+     */
+    void candidate_elements(const WorldCoordinates & p, const FLOATING_POINT_TYPE & radius, CandidateSet & candidates) const {
+        const WorldCoordinates lower_corner = (p.array() - radius).matrix().cwiseMax(p_domain_lower_corner);
+        const WorldCoordinates upper_corner = (p.array() + radius).matrix().cwiseMin(p_domain_upper_corner);
+        if (p_bvh) {
+            p_bvh->get(lower_corner, upper_corner, candidates);
+        } else if (p_flat_hash_grid) {
+            p_flat_hash_grid->get(lower_corner, upper_corner, candidates);
+        } else {
+            p_hash_grid->get(lower_corner, upper_corner, candidates);
+        }
+        candidates.sort();
+    }
+
+    /**
+     * Project the point p onto every candidate element (clamping its local coordinates onto the element), and get the
+     * closest projection.
+     */
+    auto closest_projection(const CandidateSet & candidates, const WorldCoordinates & p, FLOATING_POINT_TYPE & distance) const -> BarycentricPoint {
+        BarycentricPoint closest;
+        distance = std::numeric_limits<FLOATING_POINT_TYPE>::max();
+        for (const auto & element_index : candidates) {
+            const ContainerElement e = p_container_domain->element(element_index);
+            LocalCoordinates local_coordinates;
+            if constexpr (caribou::geometry::element_is_affine_v<ContainerElement>) {
+                local_coordinates = inverse_jacobians_are_cached() ? cached_local_coordinates(element_index, p) : e.local_coordinates(p);
+            } else {
+                local_coordinates = e.local_coordinates(p);
+            }
+            local_coordinates = e.clamped_local_coordinates(local_coordinates);
+
+            const auto d = (p - e.world_coordinates(local_coordinates)).norm();
+            if (d < distance) {
+                distance = d;
+                closest = {static_cast<ElementIndex>(element_index), local_coordinates};
+            }
+        }
+        return closest;
+    }
+
     /**
      * Set the barycentric points from a set of positions embedded inside the container domain.
      * @tparam Derived NXD Eigen matrix representing the D dimensional coordinates of the N embedded positions.
@@ -269,17 +747,14 @@ private:
         p_outside_nodes.resize(0);
         p_outside_nodes.reserve(static_cast<std::size_t>(std::floor(embedded_points.rows() / 10.))); // Reserve 10% of the mesh size for outside nodes
 
-        p_barycentric_points.resize(0);
-        p_barycentric_points.reserve(embedded_points.rows());
+        p_barycentric_points.resize(static_cast<std::size_t>(embedded_points.rows()));
+        find_barycentric_points(embedded_points, p_barycentric_points);
 
         const auto number_of_embedded_points = embedded_points.rows();
         for (Eigen::Index node_id = 0; node_id < number_of_embedded_points; ++node_id) {
-            const BarycentricPoint bp = barycentric_point(embedded_points.row(node_id).template cast<typename WorldCoordinates::Scalar>());
-            if (bp.element_index < 0) {
+            if (p_barycentric_points[node_id].element_index < 0) {
                 p_outside_nodes.emplace_back(node_id);
             }
-
-            p_barycentric_points.emplace_back(bp);
         }
     }
 
@@ -288,6 +763,22 @@ private:
     std::vector<BarycentricPoint> p_barycentric_points;
     std::vector<UNSIGNED_INTEGER_TYPE> p_outside_nodes;
     std::unique_ptr<HashGridT> p_hash_grid;
+    std::unique_ptr<FlatHashGridT> p_flat_hash_grid;
+    std::unique_ptr<BVHT> p_bvh;
+
+    /// Bounding box of the container domain, and the mean size of its elements
+    WorldCoordinates p_domain_lower_corner;
+    WorldCoordinates p_domain_upper_corner;
+    FLOATING_POINT_TYPE p_mean_element_size = 0;
+
+    /// Cached inverse Jacobians of the (affine) container elements, and the world position of their local origin
+    std::vector<InverseJacobian> p_inverse_jacobians;
+    std::vector<WorldCoordinates> p_origins;
+
+    /// Elements around every node of the container mesh: the elements around the node n are
+    /// p_node_elements[p_node_elements_offsets[n]] ... p_node_elements[p_node_elements_offsets[n+1]-1]
+    std::vector<std::size_t> p_node_elements_offsets;
+    std::vector<UNSIGNED_INTEGER_TYPE> p_node_elements;
 };
 
 } // namespace caribou::topology
\ No newline at end of file
@@ -169,11 +169,12 @@ namespace caribou::topology {
          * can be used to interpolate field values on these embedded nodes.
          * @tparam Derived NXD Eigen matrix representing the D dimensional coordinates of the N embedded points.
          * @param points The positions (in world coordinates) of the nodes embedded in this domain.
+         * @param spatial_index The spatial index used to find the elements containing the nodes.
          * @return A BarycentricContainer instance.
          */
         template <typename Derived>
-        inline auto embed(const Eigen::MatrixBase<Derived> & points) const -> BarycentricContainer<Domain> {
-            return {this, points};
+        inline auto embed(const Eigen::MatrixBase<Derived> & points, const SpatialIndex & spatial_index = SpatialIndex::HashGrid) const -> BarycentricContainer<Domain> {
+            return {this, points, spatial_index};
         }
 
         /*!
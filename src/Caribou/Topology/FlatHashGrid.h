@@ -0,0 +1,326 @@
+#pragma once
+
+#include <Caribou/config.h>
+#include <Caribou/Geometry/Element.h>
+#include <Caribou/Topology/HashGrid.h>
+#include <Caribou/Topology/ParallelSort.h>
+#include <Eigen/Core>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace caribou::topology {
+
+/**
+ * \class FlatHashGrid
+ *
+ * Compact and cache-friendly alternative to the HashGrid.
+ *
+ * Instead of one heap allocated vector per cell stored in the node-based buckets of an unordered map, the
+ * (cell, element) pairs are sorted by cell and stored contiguously in a compressed sparse row (CSR) layout: the
+ * elements of the ith non-empty cell are found between p_cell_offsets[i] and p_cell_offsets[i+1] of a single
+ * element array. A cell is identified by its linear index (key) within the grid bounding the elements, which is
+ * compared exactly as an integer. The row of a cell is retrieved from its key using an open-addressing hash table
+ * (linear probing) that only stores the row indices.
+ *
+ * The grid is built once for all the elements. The cell ranges of the elements, the (cell, element) pairs and their
+ * sorting are computed in parallel when OpenMP is available.
+ */
+template <typename Element>
+class FlatHashGrid {
+public:
+
+    static constexpr UNSIGNED_INTEGER_TYPE Dimension = caribou::geometry::traits<Element>::Dimension;
+
+    using Index = UNSIGNED_INTEGER_TYPE;
+    using CellKey = std::uint64_t;
+    using GridCoordinates = Eigen::Matrix<INTEGER_TYPE, Dimension, 1>;
+    using WorldCoordinates = Eigen::Matrix<FLOATING_POINT_TYPE, Dimension, 1>;
+
+    explicit FlatHashGrid (const FLOATING_POINT_TYPE & cell_size) : p_cell_size(cell_size) {}
+
+    /**
+     * Build the grid from a set of elements. Any previously added elements are removed.
+     *
+     * @param number_of_elements The number of elements.
+     * @param element_of A callable returning the element of a given identifier (usually its index within a topology).
+     *                   It is called concurrently from multiple threads when OpenMP is available.
+     */
+    template <typename ElementAccessor>
+    void build(const Index & number_of_elements, const ElementAccessor & element_of) {
+        std::vector<WorldCoordinates> lower_corners (number_of_elements), upper_corners (number_of_elements);
+
+#ifdef CARIBOU_WITH_OPENMP
+        #pragma omp parallel for
+#endif
+        for (INTEGER_TYPE id = 0; id < static_cast<INTEGER_TYPE>(number_of_elements); ++id) {
+            const Element e = element_of(static_cast<Index>(id));
+            const auto nodes = e.nodes();
+            lower_corners[id] = nodes.colwise().minCoeff().transpose();
+            upper_corners[id] = nodes.colwise().maxCoeff().transpose();
+        }
+
+        build(lower_corners, upper_corners);
+    }
+
+    /**
+     * Build the grid from the (precomputed) axis-aligned bounding boxes of a set of elements. The identifier of an
+     * element is the index of its bounding box. Any previously added elements are removed.
+     *
+     * @param lower_corners The lowest corner of the bounding box of every elements.
+     * @param upper_corners The highest corner of the bounding box of every elements.
+     */
+    void build(const std::vector<WorldCoordinates> & lower_corners, const std::vector<WorldCoordinates> & upper_corners) {
+        caribou_assert(lower_corners.size() == upper_corners.size());
+
+        p_cell_keys.clear();
+        p_cell_offsets.assign(1, 0);
+        p_elements.clear();
+        p_table.clear();
+
+        const auto number_of_elements = static_cast<Index>(lower_corners.size());
+        if (number_of_elements == 0) {
+            return;
+        }
+
+        const auto n = static_cast<INTEGER_TYPE>(number_of_elements);
+
+        // Range of cells overlapped by the bounding box of every elements, and the bounds of the grid
+        std::vector<GridCoordinates> lower (number_of_elements), upper (number_of_elements);
+        p_grid_min = GridCoordinates::Constant(std::numeric_limits<INTEGER_TYPE>::max());
+        GridCoordinates grid_max = GridCoordinates::Constant(std::numeric_limits<INTEGER_TYPE>::lowest());
+
+#ifdef CARIBOU_WITH_OPENMP
+        #pragma omp parallel
+#endif
+        {
+            GridCoordinates local_min = GridCoordinates::Constant(std::numeric_limits<INTEGER_TYPE>::max());
+            GridCoordinates local_max = GridCoordinates::Constant(std::numeric_limits<INTEGER_TYPE>::lowest());
+
+#ifdef CARIBOU_WITH_OPENMP
+            #pragma omp for
+#endif
+            for (INTEGER_TYPE id = 0; id < n; ++id) {
+                lower[id] = (lower_corners[id] / p_cell_size).unaryExpr(CwiseFloor()).template cast<INTEGER_TYPE>();
+                upper[id] = (upper_corners[id] / p_cell_size).unaryExpr(CwiseFloor()).template cast<INTEGER_TYPE>();
+                local_min = local_min.cwiseMin(lower[id]);
+                local_max = local_max.cwiseMax(upper[id]);
+            }
+
+#ifdef CARIBOU_WITH_OPENMP
+            #pragma omp critical
+#endif
+            {
+                p_grid_min = p_grid_min.cwiseMin(local_min);
+                grid_max = grid_max.cwiseMax(local_max);
+            }
+        }
+
+        for (UNSIGNED_INTEGER_TYPE axis = 0; axis < Dimension; ++axis) {
+            p_grid_size[axis] = static_cast<CellKey>(grid_max[axis] - p_grid_min[axis] + 1);
+        }
+
+        // Offsets of the (cell, element) pairs of every elements
+        std::vector<std::size_t> offsets (number_of_elements + 1, 0);
+        for (std::size_t id = 0; id < number_of_elements; ++id) {
+            offsets[id+1] = offsets[id] + static_cast<std::size_t>((upper[id] - lower[id]).array().unaryExpr([](const INTEGER_TYPE & c) { return c+1; }).prod());
+        }
+
+        // (cell key, element) pairs
+        std::vector<std::pair<CellKey, Index>> pairs (offsets.back());
+
+#ifdef CARIBOU_WITH_OPENMP
+        #pragma omp parallel for
+#endif
+        for (INTEGER_TYPE id = 0; id < n; ++id) {
+            auto offset = offsets[id];
+            for (INTEGER_TYPE i = lower[id][0]; i <= upper[id][0]; ++i) {
+                if constexpr (Dimension == 1) {
+                    pairs[offset++] = {key(GridCoordinates {i}), static_cast<Index>(id)};
+                } else {
+                    for (INTEGER_TYPE j = lower[id][1]; j <= upper[id][1]; ++j) {
+                        if constexpr (Dimension == 2) {
+                            pairs[offset++] = {key(GridCoordinates {i, j}), static_cast<Index>(id)};
+                        } else {
+                            for (INTEGER_TYPE k = lower[id][2]; k <= upper[id][2]; ++k) {
+                                pairs[offset++] = {key(GridCoordinates {i, j, k}), static_cast<Index>(id)};
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // Sort the pairs by cell (and by element within a cell)
+        parallel_sort(pairs);
+
+        // Compressed sparse row layout
+        p_elements.resize(pairs.size());
+        for (std::size_t p = 0; p < pairs.size(); ++p) {
+            if (p == 0 or pairs[p].first != pairs[p-1].first) {
+                if (p > 0) {
+                    p_cell_offsets.emplace_back(p);
+                }
+                p_cell_keys.emplace_back(pairs[p].first);
+            }
+            p_elements[p] = pairs[p].second;
+        }
+        p_cell_offsets.emplace_back(pairs.size());
+
+        // Open-addressing table from the cell keys to their rows (at most half full)
+        p_table_bits = 1;
+        while ((std::size_t(1) << p_table_bits) < 2*p_cell_keys.size()) {
+            ++p_table_bits;
+        }
+        const auto capacity = std::size_t(1) << p_table_bits;
+        p_table_mask = capacity - 1;
+        p_table.assign(capacity, EmptySlot);
+        for (std::size_t row = 0; row < p_cell_keys.size(); ++row) {
+            auto slot = hash(p_cell_keys[row]);
+            while (p_table[slot] != EmptySlot) {
+                slot = (slot + 1) & p_table_mask;
+            }
+            p_table[slot] = static_cast<Index>(row);
+        }
+    }
+
+    /**
+     * Get all the data of all elements that are very close to the point p. Note that the returned elements do not
+     * ensure that the point p resides inside of them. One has to further check each ones of them with an
+     * intersection test.
+     */
+    inline
+    auto get(const WorldCoordinates & p) const -> std::set<Index> {
+        std::set<Index> elements;
+        for_each_element_near(p, [&elements](const Index & element_id) {
+            elements.emplace(element_id);
+        });
+
+        return elements;
+    }
+
+    /**
+     * Call f(element_id) for every element found in the cells very close to the point p, without any allocation.
+     * An element overlapping more than one of these cells is visited once per cell.
+     */
+    template <typename Function>
+    inline
+    void for_each_element_near(const WorldCoordinates & p, Function && f) const {
+        for_each_cell_near<Dimension>(p, p_cell_size, [this, &f](const GridCoordinates & cell) {
+            visit_cell(cell, f);
+        });
+    }
+
+    /**
+     * Call f(element_id) for every element found in the cells overlapped by the axis-aligned box
+     * [lower_corner, upper_corner], without any allocation. An element overlapping more than one of these cells is
+     * visited once per cell.
+     */
+    template <typename Function>
+    inline
+    void for_each_element_in_box(const WorldCoordinates & lower_corner, const WorldCoordinates & upper_corner, Function && f) const {
+        for_each_cell_in_box<Dimension>(lower_corner, upper_corner, p_cell_size, [this, &f](const GridCoordinates & cell) {
+            visit_cell(cell, f);
+        });
+    }
+
+    /**
+     * Get the elements that are very close to the point p, without duplicates, into the given set. The set is
+     * cleared first. Contrary to get(p), no allocation is made as long as the number of candidates fits the inline
+     * storage of the set.
+     */
+    template <std::size_t Capacity>
+    inline
+    void get(const WorldCoordinates & p, SmallIndexSet<Index, Capacity> & elements) const {
+        elements.clear();
+        for_each_element_near(p, [&elements](const Index & element_id) {
+            elements.insert(element_id);
+        });
+    }
+
+    /**
+     * Get the elements found in the cells overlapped by the axis-aligned box [lower_corner, upper_corner], without
+     * duplicates, into the given set. The set is cleared first. As for get(p), the bounding box of the returned
+     * elements may not intersect the queried box.
+     */
+    template <std::size_t Capacity>
+    inline
+    void get(const WorldCoordinates & lower_corner, const WorldCoordinates & upper_corner, SmallIndexSet<Index, Capacity> & elements) const {
+        elements.clear();
+        for_each_element_in_box(lower_corner, upper_corner, [&elements](const Index & element_id) {
+            elements.insert(element_id);
+        });
+    }
+
+    /** Number of non-empty cells. */
+    inline auto number_of_cells() const -> std::size_t { return p_cell_keys.size(); }
+
+    /** Total number of (cell, element) entries. */
+    inline auto number_of_entries() const -> std::size_t { return p_elements.size(); }
+
+private:
+    static constexpr Index EmptySlot = std::numeric_limits<Index>::max();
+
+    /** Linear index of a cell within the grid bounding the elements. The cell must be inside the grid. */
+    inline auto key(const GridCoordinates & cell) const -> CellKey {
+        CellKey k = 0;
+        for (INTEGER_TYPE axis = static_cast<INTEGER_TYPE>(Dimension) - 1; axis >= 0; --axis) {
+            k = k * p_grid_size[axis] + static_cast<CellKey>(cell[axis] - p_grid_min[axis]);
+        }
+        return k;
+    }
+
+    inline auto hash(const CellKey & k) const -> std::size_t {
+        // Fibonacci hashing
+        return static_cast<std::size_t>((k * 11400714819323198485ull) >> (64 - p_table_bits));
+    }
+
+    /** Call f(element_id) for every element of the given cell. */
+    template <typename Function>
+    inline void visit_cell(const GridCoordinates & cell, Function & f) const {
+        if (p_table.empty()) {
+            return;
+        }
+
+        for (UNSIGNED_INTEGER_TYPE axis = 0; axis < Dimension; ++axis) {
+            if (cell[axis] < p_grid_min[axis] or static_cast<CellKey>(cell[axis] - p_grid_min[axis]) >= p_grid_size[axis]) {
+                return; // Outside of the grid
+            }
+        }
+
+        const auto k = key(cell);
+        auto slot = hash(k);
+        while (p_table[slot] != EmptySlot) {
+            const auto & row = p_table[slot];
+            if (p_cell_keys[row] == k) {
+                for (auto i = p_cell_offsets[row]; i < p_cell_offsets[row+1]; ++i) {
+                    f(p_elements[i]);
+                }
+                return;
+            }
+            slot = (slot + 1) & p_table_mask;
+        }
+    }
+
+    FLOATING_POINT_TYPE p_cell_size;
+
+    /// Lowest cell of the grid bounding the elements, and its number of cells along every axis
+    GridCoordinates p_grid_min = GridCoordinates::Zero();
+    std::array<CellKey, Dimension> p_grid_size {};
+
+    /// Compressed sparse row layout: the elements of the cell p_cell_keys[i] are
+    /// p_elements[p_cell_offsets[i]] ... p_elements[p_cell_offsets[i+1]-1]
+    std::vector<CellKey> p_cell_keys;
+    std::vector<std::size_t> p_cell_offsets = {0};
+    std::vector<Index> p_elements;
+
+    /// Open-addressing table containing the row of every non-empty cell
+    std::vector<Index> p_table;
+    std::size_t p_table_mask = 0;
+    unsigned int p_table_bits = 1;
+};
+
+} // namespace caribou::topology
@@ -6,7 +6,8 @@
 #include <vector>
 #include <set>
 #include <Eigen/Core>
-#include <bitset>
+#include <algorithm>
+#include <array>
 
 namespace caribou::topology {
 
@@ -17,6 +18,124 @@ struct CwiseFloor {
     auto operator()(const FLOATING_POINT_TYPE& x) const -> FLOATING_POINT_TYPE { return std::floor(x); }
 };
 
+/**
+ * Call f(cell) for the grid cells very close to the point p (in world coordinates), without any allocation. This is
+ * the cell containing p, or, when p is very close to the boundaries of its cell, up to two cells per axis.
+ */
+template <UNSIGNED_INTEGER_TYPE Dimension, typename Function>
+inline
+void for_each_cell_near(const Eigen::Matrix<FLOATING_POINT_TYPE, Dimension, 1> & p, const FLOATING_POINT_TYPE & cell_size, Function && f) {
+    using GridCoordinates = Eigen::Matrix<INTEGER_TYPE, Dimension, 1>;
+    using VecFloat = Eigen::Matrix<FLOATING_POINT_TYPE, Dimension, 1>;
+
+    const VecFloat absolute = p / cell_size;
+    const VecFloat rounded = absolute.unaryExpr(CwiseRound());
+    const VecFloat distance = absolute - rounded;
+
+    // Let's find the axis for which our coordinate is very close to
+    std::array<std::array<INTEGER_TYPE, 2>, Dimension> axis_indices {};
+    std::array<UNSIGNED_INTEGER_TYPE, Dimension> axis_sizes {};
+    for (UNSIGNED_INTEGER_TYPE axis = 0; axis < Dimension; ++axis) {
+        if (distance[axis]*distance[axis] < EPSILON*EPSILON) {
+            axis_indices[axis] = {static_cast<INTEGER_TYPE>(std::floor(rounded[axis] - 1/2.)),
+                                  static_cast<INTEGER_TYPE>(std::floor(rounded[axis] + 1/2.))};
+            axis_sizes[axis] = 2;
+        } else {
+            axis_indices[axis][0] = static_cast<INTEGER_TYPE>(std::floor(absolute[axis]));
+            axis_sizes[axis] = 1;
+        }
+    }
+
+    for (UNSIGNED_INTEGER_TYPE a = 0; a < axis_sizes[0]; ++a) {
+        if constexpr (Dimension == 1) {
+            f(GridCoordinates {axis_indices[0][a]});
+        } else {
+            for (UNSIGNED_INTEGER_TYPE b = 0; b < axis_sizes[1]; ++b) {
+                if constexpr (Dimension == 2) {
+                    f(GridCoordinates {axis_indices[0][a], axis_indices[1][b]});
+                } else {
+                    for (UNSIGNED_INTEGER_TYPE c = 0; c < axis_sizes[2]; ++c) {
+                        f(GridCoordinates {axis_indices[0][a], axis_indices[1][b], axis_indices[2][c]});
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Call f(cell) for every grid cell overlapped by the axis-aligned box [lower_corner, upper_corner] (in world
+ * coordinates), without any allocation.
+ */
+template <UNSIGNED_INTEGER_TYPE Dimension, typename Function>
+inline
+void for_each_cell_in_box(const Eigen::Matrix<FLOATING_POINT_TYPE, Dimension, 1> & lower_corner,
+                          const Eigen::Matrix<FLOATING_POINT_TYPE, Dimension, 1> & upper_corner,
+                          const FLOATING_POINT_TYPE & cell_size, Function && f) {
+    using GridCoordinates = Eigen::Matrix<INTEGER_TYPE, Dimension, 1>;
+
+    const GridCoordinates min = (lower_corner / cell_size).unaryExpr(CwiseFloor()).template cast<INTEGER_TYPE>();
+    const GridCoordinates max = (upper_corner / cell_size).unaryExpr(CwiseFloor()).template cast<INTEGER_TYPE>();
+
+    for (INTEGER_TYPE i = min[0]; i <= max[0]; ++i) {
+        if constexpr (Dimension == 1) {
+            f(GridCoordinates {i});
+        } else {
+            for (INTEGER_TYPE j = min[1]; j <= max[1]; ++j) {
+                if constexpr (Dimension == 2) {
+                    f(GridCoordinates {i, j});
+                } else {
+                    for (INTEGER_TYPE k = min[2]; k <= max[2]; ++k) {
+                        f(GridCoordinates {i, j, k});
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Small set of indices, used to deduplicate the candidate elements of a point query. The indices are stored inline
+ * (without any allocation) until the capacity is exceeded, after which they are moved into a heap vector.
+ */
+template <typename Index, std::size_t Capacity = 32>
+class SmallIndexSet {
+public:
+    /** Insert the index if it is not already in the set. */
+    inline void insert(const Index & index) {
+        if (std::find(begin(), end(), index) != end()) {
+            return;
+        }
+
+        if (p_size < Capacity) {
+            p_inline[p_size] = index;
+        } else {
+            if (p_size == Capacity) {
+                p_overflow.assign(p_inline.begin(), p_inline.end());
+            }
+            p_overflow.emplace_back(index);
+        }
+        ++p_size;
+    }
+
+    /** Sort the indices in ascending order. */
+    inline void sort() { std::sort(begin(), end()); }
+
+    inline void clear() { p_size = 0; p_overflow.clear(); }
+    inline auto size() const -> std::size_t { return p_size; }
+    inline auto empty() const -> bool { return p_size == 0; }
+
+    inline auto begin() -> Index * { return (p_size > Capacity) ? p_overflow.data() : p_inline.data(); }
+    inline auto end() -> Index * { return begin() + p_size; }
+    inline auto begin() const -> const Index * { return (p_size > Capacity) ? p_overflow.data() : p_inline.data(); }
+    inline auto end() const -> const Index * { return begin() + p_size; }
+
+private:
+    std::array<Index, Capacity> p_inline {};
+    std::vector<Index> p_overflow;
+    std::size_t p_size = 0;
+};
+
 template <typename Element>
 class HashGrid {
 public:
@@ -41,8 +160,20 @@ public:
      */
     inline
     void add(const Element & e, const Index & id) {
-        const auto min = (e.nodes().colwise().minCoeff() * 1/p_cell_size).unaryExpr(CwiseFloor()).eval();
-        const auto max = (e.nodes().colwise().maxCoeff() * 1/p_cell_size).unaryExpr(CwiseFloor()).eval();
+        const auto nodes = e.nodes();
+        add(nodes.colwise().minCoeff().transpose(), nodes.colwise().maxCoeff().transpose(), id);
+    }
+
+    /**
+     * Add an element's data to the hash grid from its (precomputed) axis-aligned bounding box
+     * @param lower_corner The lowest corner of the bounding box of the element.
+     * @param upper_corner The highest corner of the bounding box of the element.
+     * @param id The element's identifier (usually its index within a topology).
+     */
+    inline
+    void add(const WorldCoordinates & lower_corner, const WorldCoordinates & upper_corner, const Index & id) {
+        const auto min = (lower_corner * 1/p_cell_size).unaryExpr(CwiseFloor()).eval();
+        const auto max = (upper_corner * 1/p_cell_size).unaryExpr(CwiseFloor()).eval();
 
         for (INTEGER_TYPE i = static_cast<INTEGER_TYPE>(min[0]); i <= static_cast<INTEGER_TYPE>(max[0]); ++i) {
             if constexpr (Dimension == 1) {
@@ -68,69 +199,75 @@ public:
      */
     inline
     auto get(const WorldCoordinates & p) const -> std::set<Index> {
-        const VecFloat absolute = p / p_cell_size;
-        const VecFloat rounded = absolute.unaryExpr(CwiseRound());
-        const VecFloat distance = absolute - rounded;
-
-        auto close_to_axis = std::bitset<Dimension>();
-
-        std::vector<GridCoordinates> cells;
-        cells.reserve((unsigned) 1<<Dimension);
-
-        // Let's find the axis for which our coordinate is very close to
-        for (UNSIGNED_INTEGER_TYPE axis = 0; axis < Dimension; ++axis) {
-            if (distance[axis]*distance[axis] < EPSILON*EPSILON )
-                close_to_axis[axis] = true;
-        }
-
-        if (close_to_axis.none()) {
-            // We are not near any axis, which means we are well inside a cell's boundaries
-            cells.emplace_back(absolute.unaryExpr(CwiseFloor()). template cast<INTEGER_TYPE>());
-        } else {
-            const VecFloat d = VecFloat::Constant(1 / 2.);
-
-            std::array<std::vector<INTEGER_TYPE>, Dimension> axis_indices;
-            for (auto & indices  : axis_indices) {
-                indices.reserve(Dimension);
-            }
+        std::set<Index> elements;
+        for_each_element_near(p, [&elements](const Index & element_id) {
+            elements.emplace(element_id);
+        });
 
-            for (UNSIGNED_INTEGER_TYPE axis = 0; axis < Dimension; ++axis) {
-                if (close_to_axis[axis]) {
-                    axis_indices[axis].emplace_back(static_cast<INTEGER_TYPE>(floor(rounded[axis]-d[axis])));
-                    axis_indices[axis].emplace_back(static_cast<INTEGER_TYPE>(floor(rounded[axis]+d[axis])));
-                } else {
-                    axis_indices[axis].emplace_back(static_cast<INTEGER_TYPE>(floor(absolute[axis])));
-                }
-            }
+        return elements;
+    }
 
-            for (const INTEGER_TYPE & i : axis_indices[0]) {
-                if constexpr (Dimension == 1) {
-                    cells.emplace_back(GridCoordinates{i});
-                } else {
-                    for (const INTEGER_TYPE & j : axis_indices[1]) {
-                        if constexpr (Dimension == 2) {
-                            cells.emplace_back(GridCoordinates{i, j});
-                        } else {
-                            for (const INTEGER_TYPE & k : axis_indices[2]) {
-                                cells.emplace_back(GridCoordinates{i, j, k});
-                            }
-                        }
-                    }
+    /**
+     * Call f(element_id) for every element found in the cells very close to the point p, without any allocation.
+     * An element overlapping more than one of these cells is visited once per cell.
+     */
+    template <typename Function>
+    inline
+    void for_each_element_near(const WorldCoordinates & p, Function && f) const {
+        for_each_cell_near<Dimension>(p, p_cell_size, [this, &f](const GridCoordinates & cell_coordinates) {
+            const auto & iter = p_hash_table.find(cell_coordinates);
+            if (iter != p_hash_table.end()) {
+                for (const auto & element_data : iter->second) {
+                    f(element_data);
                 }
             }
-        }
+        });
+    }
 
-        std::set<Index> elements;
-        for (const auto & cell_coordinates : cells) {
+    /**
+     * Call f(element_id) for every element found in the cells overlapped by the axis-aligned box
+     * [lower_corner, upper_corner], without any allocation. An element overlapping more than one of these cells is
+     * visited once per cell.
+     */
+    template <typename Function>
+    inline
+    void for_each_element_in_box(const WorldCoordinates & lower_corner, const WorldCoordinates & upper_corner, Function && f) const {
+        for_each_cell_in_box<Dimension>(lower_corner, upper_corner, p_cell_size, [this, &f](const GridCoordinates & cell_coordinates) {
             const auto & iter = p_hash_table.find(cell_coordinates);
             if (iter != p_hash_table.end()) {
-                for (const auto &element_data : iter->second) {
-                    elements.emplace(element_data);
+                for (const auto & element_data : iter->second) {
+                    f(element_data);
                 }
             }
-        }
+        });
+    }
 
-        return elements;
+    /**
+     * Get the elements that are very close to the point p, without duplicates, into the given set. The set is
+     * cleared first. Contrary to get(p), no allocation is made as long as the number of candidates fits the inline
+     * storage of the set.
+     */
+    template <std::size_t Capacity>
+    inline
+    void get(const WorldCoordinates & p, SmallIndexSet<Index, Capacity> & elements) const {
+        elements.clear();
+        for_each_element_near(p, [&elements](const Index & element_id) {
+            elements.insert(element_id);
+        });
+    }
+
+    /**
+     * Get the elements found in the cells overlapped by the axis-aligned box [lower_corner, upper_corner], without
+     * duplicates, into the given set. The set is cleared first. As for get(p), the bounding box of the returned
+     * elements may not intersect the queried box.
+     */
+    template <std::size_t Capacity>
+    inline
+    void get(const WorldCoordinates & lower_corner, const WorldCoordinates & upper_corner, SmallIndexSet<Index, Capacity> & elements) const {
+        elements.clear();
+        for_each_element_in_box(lower_corner, upper_corner, [&elements](const Index & element_id) {
+            elements.insert(element_id);
+        });
     }
 
 private:
@@ -155,7 +292,7 @@ private:
     {
         auto operator()(const GridCoordinates &a, const GridCoordinates &b) const -> bool
         {
-            return ((a - b).norm() == 0);
+            return (a == b);
         }
     };
 
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <Caribou/config.h>
+#include <algorithm>
+#include <vector>
+#ifdef CARIBOU_WITH_OPENMP
+#include <omp.h>
+#endif
+
+namespace caribou::topology {
+
+/**
+ * Sort the vector with one sorted chunk per thread, followed by pairwise merges of the chunks. Without OpenMP (or
+ * for small vectors), this is a simple std::sort.
+ */
+template <typename T>
+void parallel_sort(std::vector<T> & values) {
+#ifdef CARIBOU_WITH_OPENMP
+    const auto number_of_chunks = static_cast<std::size_t>(std::max(1, omp_get_max_threads()));
+    if (number_of_chunks > 1 and values.size() > 4096) {
+        std::vector<std::size_t> bounds (number_of_chunks + 1);
+        for (std::size_t c = 0; c <= number_of_chunks; ++c) {
+            bounds[c] = values.size() * c / number_of_chunks;
+        }
+
+        #pragma omp parallel for
+        for (INTEGER_TYPE c = 0; c < static_cast<INTEGER_TYPE>(number_of_chunks); ++c) {
+            std::sort(values.begin() + bounds[c], values.begin() + bounds[c+1]);
+        }
+
+        for (std::size_t width = 1; width < number_of_chunks; width *= 2) {
+            #pragma omp parallel for
+            for (INTEGER_TYPE c = 0; c < static_cast<INTEGER_TYPE>(number_of_chunks); c += 2*width) {
+                const auto middle = std::min(static_cast<std::size_t>(c) + width, number_of_chunks);
+                const auto end = std::min(static_cast<std::size_t>(c) + 2*width, number_of_chunks);
+                std::inplace_merge(values.begin() + bounds[c], values.begin() + bounds[middle], values.begin() + bounds[end]);
+            }
+        }
+        return;
+    }
+#endif
+    std::sort(values.begin(), values.end());
+}
+
+} // namespace caribou::topology
@@ -1,5 +1,6 @@
 #include <SofaCaribou/config.h>
 #include <SofaCaribou/Algebra/BaseVectorOperations.h>
+#include <SofaCaribou/Algebra/EigenVector.h>
 
 DISABLE_ALL_WARNINGS_BEGIN
 #include <sofa/version.h>
@@ -7,112 +8,199 @@ DISABLE_ALL_WARNINGS_BEGIN
 #include <SofaBaseLinearSolver/FullVector.h>
 DISABLE_ALL_WARNINGS_END
 
-#if (defined(SOFA_VERSION) && SOFA_VERSION < 201200)
-namespace sofa {
-using Size = sofa::defaulttype::BaseVector::Index;
-using Index = sofa::defaulttype::BaseVector::Index;
-}
+#include <Eigen/Dense>
+
+#include <cmath>
+#include <type_traits>
+
+#ifdef CARIBOU_WITH_OPENMP
+#include <omp.h>
 #endif
 
 namespace SofaCaribou::Algebra {
 
 namespace { // Anonymous
+using sofa::defaulttype::BaseVector;
+using sofa::component::linearsolver::FullVector;
+
+// True if the storage is a pointer to the contiguous scalars of a vector, false if it is a generic BaseVector pointer
+template <typename Storage>
+constexpr bool is_contiguous_v = std::is_arithmetic_v<std::remove_const_t<std::remove_pointer_t<Storage>>>;
+
+// Get a pointer to the contiguous storage of the vector if its scalars are of type Real, nullptr otherwise
 template <typename Real>
-auto to_full_vector(const sofa::defaulttype::BaseVector* v) -> const sofa::component::linearsolver::FullVector<Real> * {
-    return dynamic_cast<const sofa::component::linearsolver::FullVector<Real> *>(v);
-}
+auto contiguous_storage_of(const BaseVector * v) -> const Real * {
+    using Vector = Eigen::Matrix<Real, Eigen::Dynamic, 1>;
 
-// Dot product between a SOFA full vector and any BaseVector
-template <typename ReturnValue, typename Real>
-ReturnValue dot(const sofa::component::linearsolver::FullVector<Real> * v1, const sofa::defaulttype::BaseVector * v2) {
-    const auto n = static_cast<sofa::Size>(v1->size());
-    auto value = static_cast<ReturnValue>(0);
-    for (sofa::Index i = 0; i < n; ++i) {
-        value +=  ( v1->element(i) * v2->element(i) );
+    if (const auto * full_vector = dynamic_cast<const FullVector<Real> *>(v)) {
+        return full_vector->ptr();
     }
 
-    return value;
-}
+    if (const auto * eigen_vector = dynamic_cast<const EigenVector<Vector> *>(v)) {
+        return eigen_vector->vector().data();
+    }
 
-// Dot product between a two SOFA full vectors
-template <typename ReturnValue, typename Real1, typename Real2>
-ReturnValue dot(const sofa::component::linearsolver::FullVector<Real1> * v1, const sofa::component::linearsolver::FullVector<Real2> * v2) {
-    const auto n = static_cast<sofa::Size>(v1->size());
-    auto value = static_cast<ReturnValue>(0);
-    for (sofa::Index i = 0; i < n; ++i) {
-        value +=  ( v1->element(i) * v2->element(i) );
+    if (const auto * eigen_vector = dynamic_cast<const EigenVector<Eigen::Map<Vector>> *>(v)) {
+        return eigen_vector->vector().data();
     }
 
-    return value;
-}
+    return nullptr;
 }
 
-/** Compute the dot product between two BaseVector, i.e. scalar = v1.dot(v2) */
-CARIBOU_API double dot(const sofa::defaulttype::BaseVector * v1, const sofa::defaulttype::BaseVector * v2) {
-    caribou_assert(v1->size() == v2->size());
+// Resolve the type of the vector once, and call the function f with either a pointer to its contiguous storage (double
+// or float), or with the BaseVector pointer itself when its storage is unknown
+template <typename Function>
+auto visit(const BaseVector * v, Function && f) {
+    if (const auto * storage = contiguous_storage_of<double>(v)) {
+        return f(storage);
+    }
+
+    if (const auto * storage = contiguous_storage_of<float>(v)) {
+        return f(storage);
+    }
 
-    // todo(jnbrunet2000@gmail.com): This function is awful. I'm sure there is a much much cleaner and faster way
-    //                               to do this. But I'm running out of time.
+    return f(v);
+}
 
-    // Most common case first FullVector<SReal> - FullVector<SReal> :
-    {
-        const auto * full_v1 = to_full_vector<SReal >(v1);
-        const auto * full_v2 = to_full_vector<SReal >(v2);
-        if (full_v1 && full_v2) {
-            return full_v1->dot(*full_v2);
-        }
+template <typename Function>
+auto visit(BaseVector * v, Function && f) {
+    // The vector itself is not const, hence its storage can be modified
+    return visit(static_cast<const BaseVector *>(v), [&f](auto storage) {
+        return f(const_cast<std::remove_const_t<std::remove_pointer_t<decltype(storage)>> *>(storage));
+    });
+}
+
+// Entry i of a vector
+template <typename Storage>
+auto entry(Storage v, Eigen::Index i) -> double {
+    if constexpr (is_contiguous_v<Storage>) {
+        return static_cast<double>(v[i]);
+    } else {
+        return static_cast<double>(v->element(static_cast<BaseVector::Index>(i)));
     }
+}
+
+// Segment [begin, end[ of a contiguous storage as an Eigen vector
+template <typename Real>
+auto segment(Real * v, Eigen::Index begin, Eigen::Index end) {
+    using Vector = Eigen::Matrix<std::remove_const_t<Real>, Eigen::Dynamic, 1>;
+    using Map = std::conditional_t<std::is_const_v<Real>, Eigen::Map<const Vector>, Eigen::Map<Vector>>;
+    return Map(v + begin, end - begin);
+}
 
-    // Next, we need to find the good virtual type....
-
-    // FullVector<double> - *
-    if (const auto * full_v1 = to_full_vector<double>(v1)) {
-        if (const auto * full_v2 = to_full_vector<double>(v2)) {
-            // FullVector<double> - FullVector<double>
-            return full_v1->dot(*full_v2);
-        } else if (const auto * full_v2 = to_full_vector<float>(v2)) {
-            // FullVector<double> - FullVector<float>
-            return dot<double>(full_v1, full_v2);
-        } else {
-            // FullVector<double> - BaseVector
-            return dot<double>(full_v1, v2);
+// Call f(begin, end) on chunks of [0, n[ (in parallel for large contiguous vectors) and sum up the results
+template <bool Contiguous, typename Function>
+auto sum_over_chunks(Eigen::Index n, Function && f) -> double {
+#ifdef CARIBOU_WITH_OPENMP
+    const auto number_of_chunks = static_cast<Eigen::Index>(omp_get_max_threads());
+    if (Contiguous and number_of_chunks > 1 and n >= minimum_size_for_multithreading) {
+        double value = 0;
+#pragma omp parallel for reduction(+:value) schedule(static, 1)
+        for (Eigen::Index c = 0; c < number_of_chunks; ++c) {
+            value += f(c*n/number_of_chunks, (c+1)*n/number_of_chunks);
         }
+        return value;
     }
+#endif
+    return f(0, n);
+}
 
-    // FullVector<float> - *
-    if (const auto * full_v1 = to_full_vector<float>(v1)) {
-        if (const auto * full_v2 = to_full_vector<float>(v2)) {
-            // FullVector<float> - FullVector<float>
-            return full_v1->dot(*full_v2);
-        } else if (const auto * full_v2 = to_full_vector<double>(v2)) {
-            // FullVector<float> - FullVector<double>
-            return dot<double>(full_v1, full_v2);
-        } else {
-            // FullVector<float> - BaseVector
-            return dot<double>(full_v1, v2);
+// Call f(begin, end) on chunks of [0, n[ (in parallel for large contiguous vectors)
+template <bool Contiguous, typename Function>
+void for_each_chunk(Eigen::Index n, Function && f) {
+#ifdef CARIBOU_WITH_OPENMP
+    const auto number_of_chunks = static_cast<Eigen::Index>(omp_get_max_threads());
+    if (Contiguous and number_of_chunks > 1 and n >= minimum_size_for_multithreading) {
+#pragma omp parallel for schedule(static, 1)
+        for (Eigen::Index c = 0; c < number_of_chunks; ++c) {
+            f(c*n/number_of_chunks, (c+1)*n/number_of_chunks);
         }
+        return;
     }
+#endif
+    f(0, n);
+}
+} // namespace
 
-    // v1 isn't a full vector... Maybe v2 is?
-    // * - FullVector<double>
-    if (const auto * full_v2 = to_full_vector<double>(v2)) {
-        return dot<double>(full_v2, v1);
-    }
+double dot(const sofa::defaulttype::BaseVector * v1, const sofa::defaulttype::BaseVector * v2) {
+    caribou_assert(v1->size() == v2->size());
+    const auto n = static_cast<Eigen::Index>(v1->size());
+
+    return visit(v1, [n, v2](auto storage_1) {
+        return visit(v2, [n, storage_1](auto storage_2) {
+            using Storage1 = decltype(storage_1);
+            using Storage2 = decltype(storage_2);
+            constexpr bool contiguous = is_contiguous_v<Storage1> and is_contiguous_v<Storage2>;
+
+            return sum_over_chunks<contiguous>(n, [storage_1, storage_2](Eigen::Index begin, Eigen::Index end) {
+                if constexpr (contiguous and std::is_same_v<Storage1, Storage2>) {
+                    return static_cast<double>(segment(storage_1, begin, end).dot(segment(storage_2, begin, end)));
+                } else if constexpr (contiguous) {
+                    return segment(storage_1, begin, end).template cast<double>().dot(
+                           segment(storage_2, begin, end).template cast<double>());
+                } else {
+                    double value = 0;
+                    for (Eigen::Index i = begin; i < end; ++i) {
+                        value += entry(storage_1, i) * entry(storage_2, i);
+                    }
+                    return value;
+                }
+            });
+        });
+    });
+}
 
-    // * - FullVector<float>
-    if (const auto * full_v2 = to_full_vector<float>(v2)) {
-        return dot<double>(full_v2, v1);
-    }
+double norm(const sofa::defaulttype::BaseVector * v) {
+    return std::sqrt(dot(v, v));
+}
 
-    // Generic case (unoptimized!)
-    // * - *
-    const auto n = static_cast<sofa::Size>(v1->size());
-    auto value = static_cast<SReal>(0);
-    for (sofa::Index i = 0; i < n; ++i) {
-        value +=  ( v1->element(i) * v2->element(i) );
-    }
+void axpy(double alpha, const sofa::defaulttype::BaseVector * x, sofa::defaulttype::BaseVector * y) {
+    caribou_assert(x->size() == y->size());
+    const auto n = static_cast<Eigen::Index>(x->size());
+
+    visit(x, [n, alpha, y](auto storage_x) {
+        visit(y, [n, alpha, storage_x](auto storage_y) {
+            using StorageX = decltype(storage_x);
+            using StorageY = decltype(storage_y);
+            constexpr bool contiguous = is_contiguous_v<StorageX> and is_contiguous_v<StorageY>;
+
+            for_each_chunk<contiguous>(n, [alpha, storage_x, storage_y](Eigen::Index begin, Eigen::Index end) {
+                if constexpr (contiguous) {
+                    using RealY = std::remove_pointer_t<StorageY>;
+                    segment(storage_y, begin, end) +=
+                        static_cast<RealY>(alpha) * segment(storage_x, begin, end).template cast<RealY>();
+                } else if constexpr (is_contiguous_v<StorageY>) {
+                    for (Eigen::Index i = begin; i < end; ++i) {
+                        storage_y[i] += static_cast<std::remove_pointer_t<StorageY>>(alpha * entry(storage_x, i));
+                    }
+                } else {
+                    for (Eigen::Index i = begin; i < end; ++i) {
+                        storage_y->add(static_cast<BaseVector::Index>(i), static_cast<SReal>(alpha * entry(storage_x, i)));
+                    }
+                }
+            });
+        });
+    });
+}
 
-    return static_cast<double> (value);
+void scale(double alpha, sofa::defaulttype::BaseVector * x) {
+    const auto n = static_cast<Eigen::Index>(x->size());
+
+    visit(x, [n, alpha](auto storage) {
+        using Storage = decltype(storage);
+        constexpr bool contiguous = is_contiguous_v<Storage>;
+
+        for_each_chunk<contiguous>(n, [alpha, storage](Eigen::Index begin, Eigen::Index end) {
+            if constexpr (contiguous) {
+                segment(storage, begin, end) *= static_cast<std::remove_pointer_t<Storage>>(alpha);
+            } else {
+                for (Eigen::Index i = begin; i < end; ++i) {
+                    const auto index = static_cast<BaseVector::Index>(i);
+                    storage->set(index, static_cast<SReal>(alpha * storage->element(index)));
+                }
+            }
+        });
+    });
 }
 
-} // namespace SofaCaribou::Algebra
\ No newline at end of file
+} // namespace SofaCaribou::Algebra
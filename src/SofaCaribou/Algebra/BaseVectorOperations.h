@@ -5,6 +5,11 @@
 // Various utilities to perform numerical operations on SOFA's BaseVector.
 // These utilities are responsible to automatically find the type of vector
 // and perform the optimal operations on them.
+//
+// When the vectors are stored contiguously (SOFA's FullVector, or Caribou's EigenVector), the type of each vector is
+// resolved once per call, and the operation is done directly on the raw storage using Eigen's vectorized kernels. When
+// compiled with OpenMP, vectors having at least minimum_size_for_multithreading entries are split into chunks that
+// are processed in parallel. Other vector types fall back to the (slow) virtual element accessors of BaseVector.
 
 namespace sofa::defaulttype {
 class BaseVector;
@@ -12,15 +17,19 @@ class BaseVector;
 
 namespace SofaCaribou::Algebra {
 
+/** Minimum number of entries of a vector for which the operations are done using multiple threads. */
+constexpr int minimum_size_for_multithreading = 50000;
 
-/**
- * Compute the dot product between two BaseVector, i.e. scalar = v1.dot(v2) *
- *
- * @todo (jnbrunet2000@gmail.com) : this could be much more optimal using delegate functions. For example, we could first
- *                                  get a callback to an optimal dot function for these types of v1 and v2, and later
- *                                  simply reuse this callback. Hence we avoid the need to do multiple virtual checks
- *                                  each time this function is called
- */
+/** Compute the dot product between two BaseVector, i.e. scalar = v1.dot(v2) */
 CARIBOU_API double dot(const sofa::defaulttype::BaseVector * v1, const sofa::defaulttype::BaseVector * v2);
 
-} // namespace SofaCaribou::Algebra
\ No newline at end of file
+/** Compute the euclidean norm of a BaseVector, i.e. scalar = |v| */
+CARIBOU_API double norm(const sofa::defaulttype::BaseVector * v);
+
+/** Add a scaled BaseVector to another one, i.e. y = y + alpha*x */
+CARIBOU_API void axpy(double alpha, const sofa::defaulttype::BaseVector * x, sofa::defaulttype::BaseVector * y);
+
+/** Scale a BaseVector, i.e. x = alpha*x */
+CARIBOU_API void scale(double alpha, sofa::defaulttype::BaseVector * x);
+
+} // namespace SofaCaribou::Algebra
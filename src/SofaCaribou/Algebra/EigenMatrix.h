@@ -1,5 +1,6 @@
 #pragma once
 #include <SofaCaribou/config.h>
+#include <SofaCaribou/Algebra/ParallelTriplets.h>
 #include <Caribou/macros.h>
 #include <Caribou/traits.h>
 
@@ -27,6 +28,9 @@ using Mat = ::sofa::defaulttype::Mat<N, M, Real>;
 #include <Eigen/Core>
 #include <Eigen/Sparse>
 
+#include <algorithm>
+#include <array>
+
 namespace SofaCaribou::Algebra {
 
 /**
@@ -212,6 +216,24 @@ public:
      */
     inline void set_symmetric(bool is_symmetric) { p_is_symmetric = is_symmetric; }
 
+    /**
+     * States if the sparsity pattern of the matrix is locked. When it is true, the pattern built from the
+     * triplets of the first assembly (the first call to compress()) is kept for all subsequent assemblies.
+     * The clear() and resize() (with the same dimensions) methods will then only set the values to zero, and
+     * the add() methods will directly accumulate into the existing entries instead of going through the
+     * triplet list.
+     */
+    inline bool pattern_locked() const {return p_pattern_is_locked;}
+
+    /**
+     * Explicitly states if the sparsity pattern of this matrix should be locked after its first assembly.
+     *
+     * \note Adding a value to an entry that is not part of the locked pattern is still allowed, but it will
+     *       be much slower since the entry has to be inserted in the compressed storage. The entry will then
+     *       be part of the pattern for the next assemblies.
+     */
+    inline void set_pattern_locked(bool is_locked) { p_pattern_is_locked = is_locked; }
+
     /**
      * @brief Return the matrix entry (i,j).
      * \warning If the matrix hasn't been initialized by calling compress() or set(), this
@@ -222,15 +244,33 @@ public:
         return this->p_eigen_matrix.coeff(i,j);
     }
 
-    /** Resize the matrix to nbRow x nbCol dimensions. This method resets to zero all entries. */
+    /**
+     * Resize the matrix to nbRow x nbCol dimensions. This method resets to zero all entries.
+     *
+     * \note If the pattern is locked and the dimensions didn't change, the sparsity pattern is kept.
+     */
     inline void  resize(Index nbRow, Index nbCol) final {
+        if (p_pattern_is_locked and p_initialized and nbRow == rowSize() and nbCol == colSize()) {
+            clear_values();
+            return;
+        }
+
         p_triplets.clear();
         this->p_eigen_matrix.resize(nbRow, nbCol);
         p_initialized = false;
     }
 
-    /** Set all entries to zero. Keeps the current matrix dimensions. */
+    /**
+     * Set all entries to zero. Keeps the current matrix dimensions.
+     *
+     * \note If the pattern is locked, the sparsity pattern is kept and only the values are set to zero.
+     */
     inline void  clear() final {
+        if (p_pattern_is_locked and p_initialized) {
+            clear_values();
+            return;
+        }
+
         p_triplets.clear();
         this->p_eigen_matrix.setZero();
         p_initialized = false;
@@ -249,6 +289,13 @@ public:
             initialize();
         }
 
+        if (p_pattern_is_locked) {
+            if (Scalar * value = find_in_pattern(i, j)) {
+                *value = static_cast<Scalar>(v);
+                return;
+            }
+        }
+
         this->p_eigen_matrix.coeffRef(i, j) = static_cast<Scalar>(v);
     }
 
@@ -264,6 +311,8 @@ public:
         //       X calls to add until compress is called).
         if (not p_initialized) {
             p_triplets.emplace_back(i, j, static_cast<Scalar>(v));
+        } else if (Scalar * value = (p_pattern_is_locked ? find_in_pattern(i, j) : nullptr)) {
+            *value += static_cast<Scalar>(v);
         } else {
             p_eigen_matrix.coeffRef(i, j) += static_cast<Scalar>(v);
         }
@@ -442,6 +491,12 @@ private:
     template <typename Scalar, unsigned int N, unsigned int C>
     void add_block(Index i, Index j, const sofa::type::Mat<N, C, Scalar> & m) {
         using StorageIndex = typename Eigen::SparseMatrix<typename EigenType::Scalar>::StorageIndex;
+
+        if (p_initialized and p_pattern_is_locked) {
+            add_block_in_pattern<Scalar, N, C>(i, j, m);
+            return;
+        }
+
         for (unsigned int k=0;k<N;++k) {
             for (unsigned int l=0;l<C;++l) {
                 const auto value = static_cast<typename EigenType::Scalar>(m[k][l]);
@@ -454,17 +509,133 @@ private:
         }
     }
 
+    /**
+     * Block addition with a NxC matrix into the locked pattern.
+     *
+     * For each outer vector (column in column-major, row in row-major) touched by the block, the position of the
+     * first inner entry is found with a single binary search. The remaining inner entries of the block are
+     * usually stored contiguously after it, hence the cursor only has to move forward. Entries that are not found
+     * in the locked pattern are inserted once the whole block has been traversed.
+     */
+    template <typename Scalar, unsigned int N, unsigned int C>
+    void add_block_in_pattern(Index i, Index j, const sofa::type::Mat<N, C, Scalar> & m) {
+        using StorageIndex = typename EigenType::StorageIndex;
+        constexpr unsigned int nb_outer = EigenType::IsRowMajor ? N : C;
+        constexpr unsigned int nb_inner = EigenType::IsRowMajor ? C : N;
+        const Index first_outer = EigenType::IsRowMajor ? i : j;
+        const Index first_inner = EigenType::IsRowMajor ? j : i;
+
+        std::array<std::pair<unsigned int, unsigned int>, N*C> misses;
+        unsigned int nb_misses = 0;
+
+        auto & storage = p_eigen_matrix.data();
+        for (unsigned int o = 0; o < nb_outer; ++o) {
+            const auto outer = first_outer + o;
+            const auto start = p_eigen_matrix.outerIndexPtr()[outer];
+            const auto end = outer_end(outer);
+            auto cursor = storage.searchLowerIndex(start, end, static_cast<StorageIndex>(first_inner));
+            for (unsigned int in = 0; in < nb_inner; ++in) {
+                const auto inner = static_cast<StorageIndex>(first_inner + in);
+                while (cursor < end and storage.index(cursor) < inner) {
+                    ++cursor;
+                }
+
+                const unsigned int k = EigenType::IsRowMajor ? o : in;
+                const unsigned int l = EigenType::IsRowMajor ? in : o;
+                if (cursor < end and storage.index(cursor) == inner) {
+                    storage.value(cursor) += static_cast<typename EigenType::Scalar>(m[k][l]);
+                } else {
+                    misses[nb_misses++] = {k, l};
+                }
+            }
+        }
+
+        for (unsigned int n = 0; n < nb_misses; ++n) {
+            const auto & [k, l] = misses[n];
+            p_eigen_matrix.coeffRef(i+k, j+l) += static_cast<typename EigenType::Scalar>(m[k][l]);
+        }
+    }
+
+    /**
+     * Get a pointer to the value of the entry (i, j) if it is part of the current pattern, or nullptr otherwise.
+     *
+     * The position of the last entry found is cached. Since entries are usually added in increasing order of
+     * their inner index (for example, when emitting a row of an element matrix), the next entry is often found
+     * right after the cached one, which avoids the binary search.
+     */
+    inline Scalar * find_in_pattern(Index i, Index j) {
+        using StorageIndex = typename EigenType::StorageIndex;
+        const Index outer = EigenType::IsRowMajor ? i : j;
+        const auto inner = static_cast<StorageIndex>(EigenType::IsRowMajor ? j : i);
+
+        auto & storage = p_eigen_matrix.data();
+        const auto start = p_eigen_matrix.outerIndexPtr()[outer];
+        const auto end = outer_end(outer);
+
+        Eigen::Index position = end;
+        if (outer == p_cursor_outer and p_cursor_position >= start and p_cursor_position < end) {
+            const auto next = p_cursor_position + 1;
+            if (storage.index(p_cursor_position) == inner) {
+                position = p_cursor_position;
+            } else if (next < end and storage.index(next) == inner) {
+                position = next;
+            }
+        }
+
+        if (position == end) {
+            position = storage.searchLowerIndex(start, end, inner);
+        }
+
+        if (position < end and storage.index(position) == inner) {
+            p_cursor_outer = outer;
+            p_cursor_position = position;
+            return &storage.value(position);
+        }
+
+        return nullptr;
+    }
+
+    /** Get the storage position following the last entry of the given outer vector. */
+    inline auto outer_end(Index outer) const -> Eigen::Index {
+        if (p_eigen_matrix.isCompressed()) {
+            return p_eigen_matrix.outerIndexPtr()[outer+1];
+        }
+        return p_eigen_matrix.outerIndexPtr()[outer] + p_eigen_matrix.innerNonZeroPtr()[outer];
+    }
+
+    /** Set all the values of the current pattern to zero without modifying the pattern. */
+    inline void clear_values() {
+        p_eigen_matrix.makeCompressed();
+        std::fill_n(p_eigen_matrix.valuePtr(), p_eigen_matrix.nonZeros(), static_cast<Scalar>(0));
+    }
+
     /**
      * @brief initialize the matrix with the accumulated triplets. The resulting matrix will be
      *        compressed. Once this is done, the operation add and addblock will be much slower
      *        if the entries to be added were zero before hand.
+     *
+     * When compiled with OpenMP and more than one thread is available, large lists of triplets are
+     * converted using multiple threads
+     * (see parallel_set_from_triplets()).
      */
     void initialize() {
-        p_eigen_matrix.setFromTriplets(p_triplets.begin(), p_triplets.end());
+#ifdef CARIBOU_WITH_OPENMP
+        const bool use_multiple_threads = omp_get_max_threads() > 1 and p_triplets.size() >= parallel_conversion_threshold;
+#else
+        const bool use_multiple_threads = false;
+#endif
+        if (use_multiple_threads) {
+            parallel_set_from_triplets(p_eigen_matrix, p_triplets);
+        } else {
+            p_eigen_matrix.setFromTriplets(p_triplets.begin(), p_triplets.end());
+        }
         p_triplets.clear();
         p_initialized = true;
     }
 
+    ///< Minimum number of triplets for which the conversion to the compressed storage is done using multiple threads.
+    static constexpr std::size_t parallel_conversion_threshold = 50000;
+
     ///< Triplets are used to store matrix entries before the call to 'compress'.
     /// Duplicates entries are summed up.
     std::vector<Eigen::Triplet<typename EigenType::Scalar>> p_triplets;
@@ -480,6 +651,13 @@ private:
     ///< States if the matrix is symmetric. Note that this value isn't set automatically, the user must
     ///< explicitly specify it using set_symmetric(true). When it is true, some optimizations will be enabled.
     bool p_is_symmetric = false;
+
+    ///< States if the sparsity pattern is kept between assemblies (see set_pattern_locked()).
+    bool p_pattern_is_locked = false;
+
+    ///< Outer index and storage position of the last entry found in the locked pattern.
+    Index p_cursor_outer = -1;
+    Eigen::Index p_cursor_position = -1;
 };
 
 } // namespace SofaCaribou::Algebra
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <SofaCaribou/config.h>
+
+#include <Eigen/Sparse>
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#ifdef CARIBOU_WITH_OPENMP
+#include <omp.h>
+#endif
+
+namespace SofaCaribou::Algebra {
+
+/**
+ * Fill a sparse matrix from a list of triplets (i, j, value) using multiple threads.
+ *
+ * This is the multithreaded counterpart of Eigen's SparseMatrix::setFromTriplets. Duplicated entries are summed up,
+ * and the resulting matrix is compressed. The conversion is done in four passes:
+ *   1. The triplets are counted per outer vector (row in row-major, column in column-major), each thread
+ *      counting its own chunk of the list.
+ *   2. A prefix sum of these counts gives the position of each outer vector's bucket (and of each thread
+ *      inside the bucket), and every triplet is copied into the bucket of its outer vector.
+ *   3. Each bucket is sorted by inner index in parallel, and its duplicated entries are counted.
+ *   4. The compressed storage of the matrix is allocated once, and each outer vector is filled in parallel
+ *      by summing up its duplicated entries.
+ *
+ * The buckets are sorted using both the inner index and the position of the triplet inside the list. Hence,
+ * duplicated entries are always summed up in the same order, and the result does not depend on the number of
+ * threads used.
+ *
+ * \note The dimensions of the matrix must be set before calling this function. Without OpenMP support, the same
+ *       algorithm is executed on a single thread.
+ *
+ * @tparam SparseMatrix An Eigen::SparseMatrix type (row-major or column-major)
+ * @tparam Triplets A random access container of Eigen::Triplet
+ * @param matrix The sparse matrix to fill. Its previous content is discarded.
+ * @param triplets The list of triplets.
+ */
+template <typename SparseMatrix, typename Triplets>
+void parallel_set_from_triplets(SparseMatrix & matrix, const Triplets & triplets) {
+    using Scalar = typename SparseMatrix::Scalar;
+    using StorageIndex = typename SparseMatrix::StorageIndex;
+    constexpr bool IsRowMajor = SparseMatrix::IsRowMajor;
+
+    const auto number_of_triplets = static_cast<long>(triplets.size());
+    const auto outer_size = static_cast<long>(IsRowMajor ? matrix.rows() : matrix.cols());
+
+    // Position of the triplet inside the list, its inner index and its value
+    struct Entry {
+        long k;
+        StorageIndex inner;
+        Scalar value;
+    };
+
+    const auto outer_of = [&triplets](const long & k) -> StorageIndex {
+        return static_cast<StorageIndex>(IsRowMajor ? triplets[k].row() : triplets[k].col());
+    };
+    const auto inner_of = [&triplets](const long & k) -> StorageIndex {
+        return static_cast<StorageIndex>(IsRowMajor ? triplets[k].col() : triplets[k].row());
+    };
+
+    // 1. Count the number of triplets of each outer vector. Each thread counts the triplets of its own contiguous
+    //    chunk of the list, which gives, for each outer vector, the position at which the thread will write its
+    //    triplets inside the bucket.
+    // 2. Copy each triplet into the bucket of its outer vector. The buckets hence keep the order of the list.
+    std::vector<long> bucket_start (outer_size+1, 0);
+    std::vector<Entry> buckets (static_cast<std::size_t>(number_of_triplets));
+    std::vector<long> offsets;
+#pragma omp parallel
+    {
+#ifdef CARIBOU_WITH_OPENMP
+        const long thread_id = omp_get_thread_num();
+        const long number_of_threads = omp_get_num_threads();
+#else
+        const long thread_id = 0;
+        const long number_of_threads = 1;
+#endif
+        const long chunk_size = (number_of_triplets + number_of_threads - 1) / number_of_threads;
+        const long chunk_begin = std::min(thread_id*chunk_size, number_of_triplets);
+        const long chunk_end = std::min(chunk_begin + chunk_size, number_of_triplets);
+
+#pragma omp single
+        offsets.resize(static_cast<std::size_t>(number_of_threads*outer_size), 0);
+
+        long * thread_offsets = offsets.data() + thread_id*outer_size;
+        for (long k = chunk_begin; k < chunk_end; ++k) {
+            thread_offsets[outer_of(k)]++;
+        }
+
+#pragma omp barrier
+#pragma omp for
+        for (long outer = 0; outer < outer_size; ++outer) {
+            for (long t = 0; t < number_of_threads; ++t) {
+                bucket_start[outer+1] += offsets[t*outer_size + outer];
+            }
+        }
+
+#pragma omp single
+        std::partial_sum(bucket_start.begin(), bucket_start.end(), bucket_start.begin());
+
+#pragma omp for
+        for (long outer = 0; outer < outer_size; ++outer) {
+            long position = bucket_start[outer];
+            for (long t = 0; t < number_of_threads; ++t) {
+                const auto count = offsets[t*outer_size + outer];
+                offsets[t*outer_size + outer] = position;
+                position += count;
+            }
+        }
+
+        for (long k = chunk_begin; k < chunk_end; ++k) {
+            const auto position = thread_offsets[outer_of(k)]++;
+            buckets[position] = {k, inner_of(k), static_cast<Scalar>(triplets[k].value())};
+        }
+    }
+
+    // 3. Sort each bucket by inner indices and count the number of unique entries
+    std::vector<StorageIndex> outer_index (outer_size+1, 0);
+#pragma omp parallel for schedule(dynamic, 256)
+    for (long outer = 0; outer < outer_size; ++outer) {
+        const auto begin = buckets.begin() + bucket_start[outer];
+        const auto end   = buckets.begin() + bucket_start[outer+1];
+        std::sort(begin, end, [](const Entry & a, const Entry & b) {
+            return (a.inner < b.inner) or (a.inner == b.inner and a.k < b.k);
+        });
+
+        StorageIndex number_of_entries = 0;
+        for (auto it = begin; it != end; ++it) {
+            if (it == begin or it->inner != (it-1)->inner) {
+                ++number_of_entries;
+            }
+        }
+        outer_index[outer+1] = number_of_entries;
+    }
+    std::partial_sum(outer_index.begin(), outer_index.end(), outer_index.begin());
+
+    // 4. Build the compressed storage in place, summing up duplicated entries
+    matrix.resize(matrix.rows(), matrix.cols());
+    matrix.resizeNonZeros(outer_index[outer_size]);
+    std::copy(outer_index.begin(), outer_index.end(), matrix.outerIndexPtr());
+
+    StorageIndex * inner_indices = matrix.innerIndexPtr();
+    Scalar * values = matrix.valuePtr();
+#pragma omp parallel for schedule(dynamic, 256)
+    for (long outer = 0; outer < outer_size; ++outer) {
+        auto position = static_cast<long>(outer_index[outer]) - 1;
+        for (auto b = bucket_start[outer]; b < bucket_start[outer+1]; ++b) {
+            const auto & entry = buckets[b];
+            if (b == bucket_start[outer] or entry.inner != inner_indices[position]) {
+                ++position;
+                inner_indices[position] = entry.inner;
+                values[position] = entry.value;
+            } else {
+                values[position] += entry.value;
+            }
+        }
+    }
+}
+
+} // namespace SofaCaribou::Algebra
@@ -0,0 +1,197 @@
+#include <SofaCaribou/Algebra/ReducedBasis.h>
+
+#include <Eigen/SVD>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+namespace SofaCaribou::Algebra {
+
+auto proper_orthogonal_decomposition(const Eigen::MatrixXd & snapshots,
+                                     double tolerance,
+                                     Eigen::Index maximum_size) -> Eigen::MatrixXd {
+    if (snapshots.rows() == 0 or snapshots.cols() == 0) {
+        return Eigen::MatrixXd(snapshots.rows(), 0);
+    }
+
+    Eigen::BDCSVD<Eigen::MatrixXd> svd (snapshots, Eigen::ComputeThinU);
+    const auto & singular_values = svd.singularValues();
+
+    // Energy of the snapshots (squared Frobenius norm) not captured by the first r vectors
+    const auto number_of_values = singular_values.size();
+    const double energy = singular_values.squaredNorm();
+    const double zero = singular_values[0] * std::numeric_limits<double>::epsilon() * static_cast<double>(snapshots.rows());
+
+    Eigen::Index r = 0;
+    double remaining_energy = energy;
+    while (r < number_of_values and singular_values[r] > zero) {
+        if (maximum_size > 0 and r >= maximum_size) {
+            break;
+        }
+
+        if (r > 0 and remaining_energy <= tolerance*tolerance*energy) {
+            break;
+        }
+
+        remaining_energy -= singular_values[r]*singular_values[r];
+        ++r;
+    }
+
+    return svd.matrixU().leftCols(r);
+}
+
+auto non_negative_least_squares(const Eigen::MatrixXd & A,
+                                const Eigen::VectorXd & b,
+                                double tolerance,
+                                Eigen::Index maximum_number_of_nonzeros) -> Eigen::VectorXd {
+    const auto n = A.cols();
+    const double b_norm = b.norm();
+    const double epsilon = 10 * std::numeric_limits<double>::epsilon() * A.lpNorm<Eigen::Infinity>() * static_cast<double>(std::max(A.rows(), n));
+    const auto maximum_number_of_iterations = 3*n;
+
+    Eigen::VectorXd x = Eigen::VectorXd::Zero(n);
+    Eigen::VectorXd residual = b;
+    std::vector<bool> is_passive (static_cast<std::size_t>(n), false);
+    std::vector<Eigen::Index> passive_set;
+
+    Eigen::Index iteration = 0;
+    while (residual.norm() > tolerance * b_norm and iteration < maximum_number_of_iterations) {
+        if (maximum_number_of_nonzeros > 0 and static_cast<Eigen::Index>(passive_set.size()) >= maximum_number_of_nonzeros) {
+            break;
+        }
+
+        // Add the column the most correlated with the residual to the passive set
+        const Eigen::VectorXd w = A.transpose() * residual;
+        Eigen::Index j = -1;
+        double w_max = epsilon;
+        for (Eigen::Index i = 0; i < n; ++i) {
+            if (not is_passive[static_cast<std::size_t>(i)] and w[i] > w_max) {
+                w_max = w[i];
+                j = i;
+            }
+        }
+
+        if (j < 0) {
+            break; // The Karush-Kuhn-Tucker conditions are satisfied
+        }
+
+        is_passive[static_cast<std::size_t>(j)] = true;
+        passive_set.push_back(j);
+
+        // Unconstrained least squares on the passive set, moving back towards the feasible region while some entries
+        // of the solution are negative
+        while (iteration < maximum_number_of_iterations) {
+            ++iteration;
+
+            const auto p = static_cast<Eigen::Index>(passive_set.size());
+            Eigen::MatrixXd A_p (A.rows(), p);
+            for (Eigen::Index k = 0; k < p; ++k) {
+                A_p.col(k) = A.col(passive_set[static_cast<std::size_t>(k)]);
+            }
+            const Eigen::VectorXd z = A_p.colPivHouseholderQr().solve(b);
+
+            if (z.minCoeff() > 0) {
+                for (Eigen::Index k = 0; k < p; ++k) {
+                    x[passive_set[static_cast<std::size_t>(k)]] = z[k];
+                }
+                break;
+            }
+
+            double alpha = 1;
+            for (Eigen::Index k = 0; k < p; ++k) {
+                const auto & x_k = x[passive_set[static_cast<std::size_t>(k)]];
+                if (z[k] <= 0) {
+                    alpha = std::min(alpha, x_k / (x_k - z[k]));
+                }
+            }
+
+            for (Eigen::Index k = 0; k < p; ++k) {
+                auto & x_k = x[passive_set[static_cast<std::size_t>(k)]];
+                x_k += alpha * (z[k] - x_k);
+            }
+
+            // Move the entries that reached zero back to the active set
+            std::vector<Eigen::Index> remaining;
+            for (const auto & i : passive_set) {
+                if (x[i] > epsilon) {
+                    remaining.push_back(i);
+                } else {
+                    x[i] = 0;
+                    is_passive[static_cast<std::size_t>(i)] = false;
+                }
+            }
+            passive_set = std::move(remaining);
+
+            if (passive_set.empty()) {
+                break;
+            }
+        }
+
+        residual = b - A * x;
+    }
+
+    return x;
+}
+
+bool write_column_vectors(const std::string & filename, const Eigen::MatrixXd & vectors) {
+    std::ofstream file (filename);
+    if (not file.is_open()) {
+        return false;
+    }
+
+    file << std::setprecision(std::numeric_limits<double>::max_digits10);
+    for (Eigen::Index j = 0; j < vectors.cols(); ++j) {
+        for (Eigen::Index i = 0; i < vectors.rows(); ++i) {
+            if (i > 0) {
+                file << ' ';
+            }
+            file << vectors(i, j);
+        }
+        file << '\n';
+    }
+
+    return file.good();
+}
+
+bool read_column_vectors(const std::string & filename, Eigen::MatrixXd & vectors) {
+    std::ifstream file (filename);
+    if (not file.is_open()) {
+        return false;
+    }
+
+    std::vector<std::vector<double>> columns;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream stream (line);
+        std::vector<double> column;
+        double value;
+        while (stream >> value) {
+            column.push_back(value);
+        }
+
+        if (column.empty()) {
+            continue; // Blank line
+        }
+
+        if (not columns.empty() and column.size() != columns.front().size()) {
+            return false;
+        }
+
+        columns.emplace_back(std::move(column));
+    }
+
+    const auto n = static_cast<Eigen::Index>(columns.empty() ? 0 : columns.front().size());
+    vectors.resize(n, static_cast<Eigen::Index>(columns.size()));
+    for (std::size_t j = 0; j < columns.size(); ++j) {
+        vectors.col(static_cast<Eigen::Index>(j)) = Eigen::Map<const Eigen::VectorXd>(columns[j].data(), n);
+    }
+
+    return true;
+}
+
+} // namespace SofaCaribou::Algebra
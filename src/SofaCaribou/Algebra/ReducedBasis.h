@@ -0,0 +1,69 @@
+#pragma once
+
+#include <SofaCaribou/config.h>
+
+#include <Eigen/Core>
+
+#include <string>
+
+// Utilities used by the projection-based reduced order models and their hyper reduction.
+//
+// A reduced basis is a dense n x r matrix whose columns are orthonormal vectors of the full order space (for example,
+// the global displacement vector of the top level mechanical states). It is extracted offline from a set of snapshots
+// (the columns of a n x m matrix) by a proper orthogonal decomposition (POD).
+//
+// The snapshots and the bases are stored in plain text files containing one vector per line, the entries being
+// separated by spaces. These files can be read directly with numpy.loadtxt (which gives the transpose of the matrix).
+
+namespace SofaCaribou::Algebra {
+
+/**
+ * Extract an orthonormal basis from a set of snapshots using a proper orthogonal decomposition (thin singular value
+ * decomposition of the snapshot matrix).
+ *
+ * The size r of the basis is the smallest one for which the relative projection error of the snapshots,
+ * sqrt(sum_{i>r} s_i^2 / sum_i s_i^2) where s_i are the singular values, is lower or equal to the given tolerance.
+ * Directions having a singular value that is numerically zero are never kept.
+ *
+ * @param snapshots The n x m snapshot matrix (one snapshot per column).
+ * @param tolerance The maximum relative projection error of the snapshots onto the basis.
+ * @param maximum_size The maximum number of vectors in the basis (0 for no limit).
+ * @return The n x r basis (one vector per column).
+ */
+CARIBOU_API auto proper_orthogonal_decomposition(const Eigen::MatrixXd & snapshots,
+                                                 double tolerance,
+                                                 Eigen::Index maximum_size = 0) -> Eigen::MatrixXd;
+
+/**
+ * Find a sparse non-negative solution of the least squares problem min |A x - b| subject to x >= 0, using the
+ * active set method of Lawson and Hanson.
+ *
+ * The columns of A are added to the (passive) set of non-zero entries one at a time, the column most correlated with
+ * the current residual first. Hence, stopping as soon as the residual is small enough gives a sparse solution. This
+ * is used to select the elements (and their weights) of the energy-conserving sampling and weighting (ECSW) hyper
+ * reduction.
+ *
+ * @param A The m x n matrix.
+ * @param b The m vector.
+ * @param tolerance The iterations stop as soon as |A x - b| <= tolerance |b|.
+ * @param maximum_number_of_nonzeros The maximum number of non-zero entries in x (0 for no limit).
+ * @return The n vector x.
+ */
+CARIBOU_API auto non_negative_least_squares(const Eigen::MatrixXd & A,
+                                            const Eigen::VectorXd & b,
+                                            double tolerance,
+                                            Eigen::Index maximum_number_of_nonzeros = 0) -> Eigen::VectorXd;
+
+/**
+ * Write the columns of a matrix into a text file, one column per line.
+ * @return False if the file could not be written.
+ */
+CARIBOU_API bool write_column_vectors(const std::string & filename, const Eigen::MatrixXd & vectors);
+
+/**
+ * Read a matrix from a text file containing one column per line.
+ * @return False if the file could not be read, or if its lines do not all have the same number of entries.
+ */
+CARIBOU_API bool read_column_vectors(const std::string & filename, Eigen::MatrixXd & vectors);
+
+} // namespace SofaCaribou::Algebra
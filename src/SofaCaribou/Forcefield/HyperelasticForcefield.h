@@ -6,6 +6,13 @@
 #include <SofaCaribou/config.h>
 #include <SofaCaribou/Material/HyperelasticMaterial.h>
 #include <SofaCaribou/Forcefield/CaribouForcefield.h>
+#include <SofaCaribou/Ode/CombinedMBKdxProvider.h>
+#include <SofaCaribou/Ode/CriticalTimeStepProvider.h>
+#include <SofaCaribou/Ode/HyperReducible.h>
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/core/objectmodel/DataFileName.h>
+DISABLE_ALL_WARNINGS_END
 
 #include <Caribou/config.h>
 #include <Caribou/constants.h>
@@ -23,7 +30,7 @@ namespace sofa { using Index = unsigned int; }
 namespace SofaCaribou::forcefield {
 
 template <typename Element>
-class HyperelasticForcefield : public CaribouForcefield<Element> {
+class HyperelasticForcefield : public CaribouForcefield<Element>, public ode::CriticalTimeStepProvider, public ode::CombinedMBKdxProvider, public ode::HyperReducible {
 public:
     SOFA_CLASS(SOFA_TEMPLATE(HyperelasticForcefield, Element), SOFA_TEMPLATE(CaribouForcefield, Element));
 
@@ -155,6 +162,54 @@ public:
     CARIBOU_API
     auto cond() -> Real;
 
+    /**
+     * Get the critical time step of each element as the ratio of the element's characteristic length (the smallest
+     * distance between two of its nodes) over the speed of the dilatational wave at the undeformed state of its
+     * material. The mass density is taken from a CaribouMass found in the current context, and the wave speed from the
+     * P-wave modulus of the material (an empty vector is returned when the material doesn't provide it).
+     *
+     * @see SofaCaribou::ode::CriticalTimeStepProvider
+     */
+    CARIBOU_API
+    auto elements_critical_time_step() const -> std::vector<FLOATING_POINT_TYPE> override;
+
+    /**
+     * Accumulate df += K [k1 dx1 + k2 dx2] with a single traversal of the tangent stiffness matrix.
+     *
+     * @see SofaCaribou::ode::CombinedMBKdxProvider
+     */
+    CARIBOU_API
+    void add_combined_MBKdx(const sofa::core::MechanicalParams * mparams_1,
+                            const sofa::core::MechanicalParams * mparams_2,
+                            sofa::core::MultiVecDerivId df_id) override;
+
+    /** @see SofaCaribou::ode::HyperReducible */
+    bool hyper_reduction_is_active() const override { return p_hyper_reduction_is_active; }
+
+    /** @see SofaCaribou::ode::HyperReducible */
+    CARIBOU_API
+    void set_hyper_reduction_active(bool active) override;
+
+    /**
+     * Select the weighted subset of elements from training snapshots by energy-conserving sampling and weighting
+     * (ECSW). The reduced internal forces of every elements are computed for every snapshots, and the weights are
+     * the sparse non-negative least squares solution reproducing their sum.
+     *
+     * @see SofaCaribou::ode::HyperReducible
+     */
+    CARIBOU_API
+    bool train_hyper_reduction(const Eigen::MatrixXd & snapshots, const Eigen::MatrixXd & basis, double tolerance) override;
+
+    /** @see SofaCaribou::ode::HyperReducible */
+    CARIBOU_API
+    bool write_hyper_reduction_weights(const std::string & filename) const override;
+
+    /** Indices of the elements integrated when the hyper reduction is active. */
+    auto hyper_reduction_elements() const -> const std::vector<std::size_t> & { return p_hyper_reduction_elements; }
+
+    /** Weights of the elements integrated when the hyper reduction is active. */
+    auto hyper_reduction_weights() const -> const std::vector<Real> & { return p_hyper_reduction_weights; }
+
     /**
      *  Assemble the stiffness matrix K.
      *
@@ -203,9 +258,31 @@ private:
     /** Get the set of Gauss integration nodes of the given element */
     virtual auto get_gauss_nodes(const std::size_t & element_id, const Element & element) const -> GaussContainer;
 
+    /** Compute the internal forces of the nodes of an element at their given current positions */
+    auto element_internal_forces(const std::size_t & element_id,
+                                 const Matrix<NumberOfNodesPerElement, Dimension> & current_nodes_position,
+                                 const material::HyperelasticMaterial<DataTypes> & material) const
+                                 -> Matrix<NumberOfNodesPerElement, Dimension>;
+
+    /** Read the hyper reduction elements and weights from a file written by write_hyper_reduction_weights */
+    bool read_hyper_reduction_weights(const std::string & filename);
+
+    /** Number of elements integrated: all of them, or the ones having a weight when the hyper reduction is active */
+    inline auto number_of_integrated_elements() const -> std::size_t {
+        return p_hyper_reduction_is_active ? p_hyper_reduction_elements.size() : this->number_of_elements();
+    }
+
+    /** Get the element index and weight of the kth integrated element */
+    inline auto integrated_element(const std::size_t & k) const -> std::pair<std::size_t, Real> {
+        return p_hyper_reduction_is_active ? std::make_pair(p_hyper_reduction_elements[k], p_hyper_reduction_weights[k])
+                                           : std::make_pair(k, Real(1));
+    }
+
     // Data members
     Link<material::HyperelasticMaterial<DataTypes>> d_material;
     sofa::core::objectmodel::Data<bool> d_enable_multithreading;
+    sofa::core::objectmodel::DataFileName d_hyper_reduction_weights;
+    sofa::core::objectmodel::Data<unsigned int> d_number_of_integrated_elements;
 
     // Private variables
     std::vector<GaussContainer> p_elements_quadrature_nodes;
@@ -217,6 +294,11 @@ private:
     sofa::core::ConstMultiVecCoordId p_X_id = sofa::core::ConstVecCoordId::position();
     bool K_is_up_to_date = false;
     bool eigenvalues_are_up_to_date = false;
+
+    /// Elements selected by the hyper reduction, and their weights
+    std::vector<std::size_t> p_hyper_reduction_elements;
+    std::vector<Real> p_hyper_reduction_weights;
+    bool p_hyper_reduction_is_active = false;
 };
 
 } // namespace SofaCaribou::forcefield
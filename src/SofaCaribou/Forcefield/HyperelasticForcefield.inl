@@ -3,7 +3,10 @@
 #include <SofaCaribou/config.h>
 #include <SofaCaribou/Forcefield/HyperelasticForcefield.h>
 #include <SofaCaribou/Forcefield/CaribouForcefield.inl>
+#include <SofaCaribou/Mass/CaribouMass.h>
 #include <SofaCaribou/Topology/CaribouTopology.h>
+#include <SofaCaribou/Algebra/ReducedBasis.h>
+#include <SofaCaribou/Ode/ReducedStaticODESolver.h>
 
 DISABLE_ALL_WARNINGS_BEGIN
 #include <sofa/helper/AdvancedTimer.h>
@@ -15,6 +18,11 @@ DISABLE_ALL_WARNINGS_END
 #include <omp.h>
 #endif
 
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
 namespace SofaCaribou::forcefield {
 
 template <typename Element>
@@ -28,6 +36,19 @@ HyperelasticForcefield<Element>::HyperelasticForcefield()
     "Enable the multithreading computation of the stiffness matrix. Only use this if you have a "
     "very large number of elements, otherwise performance might be worse than single threading."
     "When enabled, use the environment variable OMP_NUM_THREADS=N to use N threads."))
+, d_hyper_reduction_weights(initData(&d_hyper_reduction_weights,
+    "hyper_reduction_weights",
+    "File containing the elements and weights of the hyper reduction (one 'element_index weight' pair per line), for "
+    "example, the one written by a SnapshotRecorder. When set, the forces and their derivatives are only integrated "
+    "over these elements. This is only valid with a reduced order solver, hence the weights are ignored when the "
+    "node is not solved by a ReducedStaticODESolver."))
+, d_number_of_integrated_elements(initData(&d_number_of_integrated_elements,
+    (unsigned int) 0,
+    "number_of_integrated_elements",
+    "Number of elements over which the forces are integrated (smaller than the number of elements when the hyper "
+    "reduction is active).",
+    true /*is_displayed_in_gui*/,
+    true /*is_read_only*/))
 {
 }
 
@@ -56,6 +77,29 @@ void HyperelasticForcefield<Element>::init()
     // Compute and store the shape functions and their derivatives for every integration points
     initialize_elements();
 
+    // Load the elements and weights of the hyper reduction
+    const auto & weights_filename = d_hyper_reduction_weights.getFullPath();
+    if (not weights_filename.empty()) {
+        if (read_hyper_reduction_weights(weights_filename)) {
+            msg_info() << "Hyper reduction of " << p_hyper_reduction_elements.size() << " elements (out of "
+                       << this->number_of_elements() << ") loaded from '" << weights_filename << "'.";
+        } else {
+            msg_error() << "Unable to read the hyper reduction weights from '" << weights_filename << "'. The forces "
+                        << "will be integrated over every elements.";
+        }
+    }
+
+    // The hyper reduced forces are only valid in the reduced space of a reduced order solver
+    bool is_solved_in_a_reduced_space = false;
+    if (not p_hyper_reduction_elements.empty()) {
+        is_solved_in_a_reduced_space = (this->getContext()->template get<ode::ReducedStaticODESolver>(BaseContext::SearchUp) != nullptr);
+        if (not is_solved_in_a_reduced_space) {
+            msg_warning() << "The hyper reduction weights are ignored since this node is not solved by a reduced order "
+                          << "solver (ReducedStaticODESolver). The forces will be integrated over every elements.";
+        }
+    }
+    set_hyper_reduction_active(is_solved_in_a_reduced_space);
+
     // Assemble the initial stiffness matrix
     assemble_stiffness();
 }
@@ -113,7 +157,9 @@ void HyperelasticForcefield<Element>::addForce(
 
     sofa::helper::AdvancedTimer::stepBegin("HyperelasticForcefield::addForce");
 
-    for (std::size_t element_id = 0; element_id < nb_elements; ++element_id) {
+    const auto nb_integrated_elements = number_of_integrated_elements();
+    for (std::size_t k = 0; k < nb_integrated_elements; ++k) {
+        const auto [element_id, weight] = integrated_element(k);
 
         // Fetch the node indices of the element
         auto node_indices = this->topology()->domain()->element_indices(element_id);
@@ -126,39 +172,8 @@ void HyperelasticForcefield<Element>::addForce(
         }
 
         // Compute the nodal forces
-        Matrix<NumberOfNodesPerElement, Dimension> nodal_forces;
-        nodal_forces.fill(0);
-
-        for (GaussNode &gauss_node : p_elements_quadrature_nodes[element_id]) {
-
-            // Jacobian of the gauss node's transformation mapping from the elementary space to the world space
-            const auto & detJ = gauss_node.jacobian_determinant;
-
-            // Derivatives of the shape functions at the gauss node with respect to global coordinates x,y and z
-            const auto & dN_dx = gauss_node.dN_dx;
-
-            // Gauss quadrature node weight
-            const auto & w = gauss_node.weight;
-
-            // Deformation tensor at gauss node
-            const Mat33 F = current_nodes_position.transpose()*dN_dx;
-            const auto J = F.determinant();
-
-            // Right Cauchy-Green strain tensor at gauss node
-            const Mat33 C = F.transpose() * F;
-
-            // Second Piola-Kirchhoff stress tensor at gauss node
-            const Mat33 S = material->PK2_stress(J, C);
-
-            // Elastic forces w.r.t the gauss node applied on each nodes
-            for (size_t i = 0; i < NumberOfNodesPerElement; ++i) {
-                const auto dx = dN_dx.row(i).transpose();
-                const Vector<Dimension> f_ = (detJ * w) * F*S*dx;
-                for (size_t j = 0; j < Dimension; ++j) {
-                    nodal_forces(i, j) += f_[j];
-                }
-            }
-        }
+        const Matrix<NumberOfNodesPerElement, Dimension> nodal_forces =
+            weight * element_internal_forces(element_id, current_nodes_position, *material);
 
         for (size_t i = 0; i < NumberOfNodesPerElement; ++i) {
             for (size_t j = 0; j < Dimension; ++j) {
@@ -212,6 +227,54 @@ void HyperelasticForcefield<Element>::addDForce(
     sofa::helper::AdvancedTimer::stepEnd("HyperelasticForcefield::addDForce");
 }
 
+template <typename Element>
+void HyperelasticForcefield<Element>::add_combined_MBKdx(
+    const sofa::core::MechanicalParams * mparams_1,
+    const sofa::core::MechanicalParams * mparams_2,
+    sofa::core::MultiVecDerivId df_id)
+{
+    using namespace sofa::core::objectmodel;
+
+    if (!this->mstate)
+        return;
+
+    // Only the stiffness terms are computed by this force field (no mass or damping matrices)
+    const auto k1 = static_cast<Real> (mparams_1->kFactorIncludingRayleighDamping(this->rayleighStiffness.getValue()));
+    const auto k2 = static_cast<Real> (mparams_2->kFactorIncludingRayleighDamping(this->rayleighStiffness.getValue()));
+    if (k1 == 0 and k2 == 0) {
+        return;
+    }
+
+    if (not K_is_up_to_date) {
+        assemble_stiffness();
+    }
+
+    sofa::helper::ReadAccessor<Data<VecDeriv>> sofa_dx1 = *mparams_1->readDx(this->mstate.get());
+    sofa::helper::ReadAccessor<Data<VecDeriv>> sofa_dx2 = *mparams_2->readDx(this->mstate.get());
+    sofa::helper::WriteAccessor<Data<VecDeriv>> sofa_df = *df_id[this->mstate.get()].write();
+
+    Eigen::Map<const Eigen::Matrix<Real, Eigen::Dynamic, 1>> DX1  (&(sofa_dx1[0][0]), sofa_dx1.size()*3);
+    Eigen::Map<const Eigen::Matrix<Real, Eigen::Dynamic, 1>> DX2  (&(sofa_dx2[0][0]), sofa_dx2.size()*3);
+    Eigen::Map<Eigen::Matrix<Real, Eigen::Dynamic, 1>>       DF   (&(sofa_df[0][0]), sofa_df.size()*3);
+
+    sofa::helper::ScopedAdvancedTimer _t_ ("HyperelasticForcefield::add_combined_MBKdx");
+
+    // Same traversal as addDForce, but with the linear combination of the two vectors
+    for (int k = 0; k < p_K.outerSize(); ++k) {
+        for (typename Eigen::SparseMatrix<Real>::InnerIterator it(p_K, k); it; ++it) {
+            const auto i = it.row();
+            const auto j = it.col();
+            const auto v = -1 * it.value();
+            if (i != j) {
+                DF[i] += v*(k1*DX1[j] + k2*DX2[j]);
+                DF[j] += v*(k1*DX1[i] + k2*DX2[i]);
+            } else {
+                DF[i] += v*(k1*DX1[i] + k2*DX2[i]);
+            }
+        }
+    }
+}
+
 template <typename Element>
 void HyperelasticForcefield<Element>::addKToMatrix(
     sofa::defaulttype::BaseMatrix * matrix,
@@ -287,7 +350,10 @@ SReal HyperelasticForcefield<Element>::getPotentialEnergy (
 
     sofa::helper::AdvancedTimer::stepBegin("HyperelasticForcefield::getPotentialEnergy");
 
-    for (std::size_t element_id = 0; element_id < nb_elements; ++element_id) {
+    const auto nb_integrated_elements = number_of_integrated_elements();
+    for (std::size_t k = 0; k < nb_integrated_elements; ++k) {
+        const auto [element_id, weight] = integrated_element(k);
+
         // Fetch the node indices of the element
         auto node_indices = this->topology()->domain()->element_indices(element_id);
 
@@ -330,7 +396,7 @@ SReal HyperelasticForcefield<Element>::getPotentialEnergy (
             const Mat33 C = F.transpose() * F;
 
             // Add the potential energy at gauss node
-            Psi += (detJ * w) *  material->strain_energy_density(J, C);
+            Psi += (weight * detJ * w) *  material->strain_energy_density(J, C);
         }
     }
 
@@ -419,7 +485,6 @@ void HyperelasticForcefield<Element>::assemble_stiffness(const Eigen::MatrixBase
     material->before_update();
 
     static const auto Id = Mat33::Identity();
-    const auto nb_elements = this->number_of_elements();
     const auto nb_nodes = x.rows();
     const auto nDofs = nb_nodes*Dimension;
     p_K.resize(nDofs, nDofs);
@@ -430,8 +495,11 @@ void HyperelasticForcefield<Element>::assemble_stiffness(const Eigen::MatrixBase
     triplets.reserve(nDofs*24*2);
 
     sofa::helper::AdvancedTimer::stepBegin("HyperelasticForcefield::update_stiffness");
+    const auto nb_integrated_elements = number_of_integrated_elements();
 #pragma omp parallel for if (enable_multithreading)
-    for (int element_id = 0; element_id < static_cast<int>(nb_elements); ++element_id) {
+    for (int k = 0; k < static_cast<int>(nb_integrated_elements); ++k) {
+        const auto [element_id, weight] = integrated_element(static_cast<std::size_t>(k));
+
         // Fetch the node indices of the element
         auto node_indices = this->topology()->domain()->element_indices(element_id);
 
@@ -452,8 +520,8 @@ void HyperelasticForcefield<Element>::assemble_stiffness(const Eigen::MatrixBase
             // Derivatives of the shape functions at the gauss node with respect to global coordinates x,y and z
             const auto dN_dx = gauss_node.dN_dx;
 
-            // Gauss quadrature node weight
-            const auto w = gauss_node.weight;
+            // Gauss quadrature node weight (scaled by the weight of the element in the hyper reduction)
+            const auto w = weight * gauss_node.weight;
 
             // Deformation tensor at gauss node
             const Mat33 F = current_nodes_position.transpose()*dN_dx;
@@ -539,6 +607,195 @@ void HyperelasticForcefield<Element>::assemble_stiffness(const Eigen::MatrixBase
     eigenvalues_are_up_to_date = false;
 }
 
+template <typename Element>
+auto HyperelasticForcefield<Element>::element_internal_forces(
+    const std::size_t & element_id,
+    const Matrix<NumberOfNodesPerElement, Dimension> & current_nodes_position,
+    const material::HyperelasticMaterial<DataTypes> & material) const -> Matrix<NumberOfNodesPerElement, Dimension>
+{
+    Matrix<NumberOfNodesPerElement, Dimension> nodal_forces;
+    nodal_forces.fill(0);
+
+    for (const GaussNode & gauss_node : p_elements_quadrature_nodes[element_id]) {
+
+        // Jacobian of the gauss node's transformation mapping from the elementary space to the world space
+        const auto & detJ = gauss_node.jacobian_determinant;
+
+        // Derivatives of the shape functions at the gauss node with respect to global coordinates x,y and z
+        const auto & dN_dx = gauss_node.dN_dx;
+
+        // Gauss quadrature node weight
+        const auto & w = gauss_node.weight;
+
+        // Deformation tensor at gauss node
+        const Mat33 F = current_nodes_position.transpose()*dN_dx;
+        const auto J = F.determinant();
+
+        // Right Cauchy-Green strain tensor at gauss node
+        const Mat33 C = F.transpose() * F;
+
+        // Second Piola-Kirchhoff stress tensor at gauss node
+        const Mat33 S = material.PK2_stress(J, C);
+
+        // Elastic forces w.r.t the gauss node applied on each nodes
+        for (size_t i = 0; i < NumberOfNodesPerElement; ++i) {
+            const auto dx = dN_dx.row(i).transpose();
+            const Vector<Dimension> f_ = (detJ * w) * F*S*dx;
+            for (size_t j = 0; j < Dimension; ++j) {
+                nodal_forces(i, j) += f_[j];
+            }
+        }
+    }
+
+    return nodal_forces;
+}
+
+template <typename Element>
+void HyperelasticForcefield<Element>::set_hyper_reduction_active(bool active) {
+    if (active and p_hyper_reduction_elements.empty()) {
+        msg_warning() << "The hyper reduction cannot be activated since no weights were trained or loaded.";
+    }
+
+    const bool is_active = active and not p_hyper_reduction_elements.empty();
+    if (is_active != p_hyper_reduction_is_active) {
+        K_is_up_to_date = false;
+        eigenvalues_are_up_to_date = false;
+    }
+
+    p_hyper_reduction_is_active = is_active;
+    d_number_of_integrated_elements.setValue(static_cast<unsigned int>(number_of_integrated_elements()));
+}
+
+template <typename Element>
+bool HyperelasticForcefield<Element>::train_hyper_reduction(const Eigen::MatrixXd & snapshots, const Eigen::MatrixXd & basis, double tolerance) {
+    using namespace sofa::core::objectmodel;
+
+    const auto material = d_material.get();
+    if (not this->mstate or not material) {
+        return false;
+    }
+
+    sofa::helper::ReadAccessor<Data<VecCoord>> sofa_x0 = this->mstate->readRestPositions();
+    const auto nb_nodes = sofa_x0.size();
+    const auto nb_elements = this->number_of_elements();
+    const auto n = static_cast<Eigen::Index>(nb_nodes*Dimension);
+    if (snapshots.rows() != n or basis.rows() != n or snapshots.cols() == 0 or basis.cols() == 0
+        or p_elements_quadrature_nodes.size() != nb_elements) {
+        msg_error() << "The size of the snapshots (" << snapshots.rows() << ") or of the reduced basis ("
+                    << basis.rows() << ") does not match the size of the mechanical state (" << n << ").";
+        return false;
+    }
+
+    sofa::helper::ScopedAdvancedTimer _t_ ("HyperelasticForcefield::train_hyper_reduction");
+
+    material->before_update();
+
+    const Eigen::Map<const Eigen::Matrix<Real, Eigen::Dynamic, Dimension, Eigen::RowMajor>> X0 (sofa_x0.ref().data()->data(), nb_nodes, Dimension);
+    const auto m = snapshots.cols();
+    const auto r = basis.cols();
+
+    // Reduced internal forces of every elements (columns) for every snapshots (blocks of r rows)
+    Eigen::MatrixXd G (m*r, static_cast<Eigen::Index>(nb_elements));
+    for (Eigen::Index s = 0; s < m; ++s) {
+        for (std::size_t element_id = 0; element_id < nb_elements; ++element_id) {
+            auto node_indices = this->topology()->domain()->element_indices(element_id);
+
+            Matrix<NumberOfNodesPerElement, Dimension> current_nodes_position;
+            for (std::size_t i = 0; i < NumberOfNodesPerElement; ++i) {
+                const auto offset = static_cast<Eigen::Index>(node_indices[i]*Dimension);
+                current_nodes_position.row(i).noalias() =
+                    X0.row(node_indices[i]) + snapshots.col(s).template segment<Dimension>(offset).transpose().template cast<Real>();
+            }
+
+            const auto nodal_forces = element_internal_forces(element_id, current_nodes_position, *material);
+
+            auto g = G.col(static_cast<Eigen::Index>(element_id)).segment(s*r, r);
+            g.setZero();
+            for (std::size_t i = 0; i < NumberOfNodesPerElement; ++i) {
+                const auto offset = static_cast<Eigen::Index>(node_indices[i]*Dimension);
+                g.noalias() += basis.middleRows(offset, Dimension).transpose() * nodal_forces.row(i).transpose().template cast<double>();
+            }
+        }
+    }
+
+    // The exact integration (every weights equal to one) is reproduced by the sparse non-negative weights
+    const Eigen::VectorXd b = G.rowwise().sum();
+    const Eigen::VectorXd xi = SofaCaribou::Algebra::non_negative_least_squares(G, b, tolerance);
+
+    p_hyper_reduction_elements.clear();
+    p_hyper_reduction_weights.clear();
+    for (Eigen::Index e = 0; e < xi.size(); ++e) {
+        if (xi[e] > 0) {
+            p_hyper_reduction_elements.emplace_back(static_cast<std::size_t>(e));
+            p_hyper_reduction_weights.emplace_back(static_cast<Real>(xi[e]));
+        }
+    }
+
+    if (p_hyper_reduction_elements.empty()) {
+        msg_error() << "The hyper reduction training did not select any elements.";
+        set_hyper_reduction_active(false);
+        return false;
+    }
+
+    msg_info() << "Hyper reduction trained on " << m << " snapshots: " << p_hyper_reduction_elements.size()
+               << " elements selected out of " << nb_elements << " (relative error of "
+               << (G*xi - b).norm() / b.norm() << ").";
+
+    // Force the update of the number of integrated elements and of the stiffness matrix
+    p_hyper_reduction_is_active = false;
+    set_hyper_reduction_active(true);
+
+    return true;
+}
+
+template <typename Element>
+bool HyperelasticForcefield<Element>::write_hyper_reduction_weights(const std::string & filename) const {
+    std::ofstream file (filename);
+    if (not file.is_open()) {
+        return false;
+    }
+
+    file << std::setprecision(std::numeric_limits<Real>::max_digits10);
+    for (std::size_t k = 0; k < p_hyper_reduction_elements.size(); ++k) {
+        file << p_hyper_reduction_elements[k] << ' ' << p_hyper_reduction_weights[k] << '\n';
+    }
+
+    return file.good();
+}
+
+template <typename Element>
+bool HyperelasticForcefield<Element>::read_hyper_reduction_weights(const std::string & filename) {
+    std::ifstream file (filename);
+    if (not file.is_open()) {
+        return false;
+    }
+
+    const auto nb_elements = this->number_of_elements();
+    std::vector<std::size_t> elements;
+    std::vector<Real> weights;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream stream (line);
+        std::size_t element_id;
+        Real weight;
+        if (not (stream >> element_id)) {
+            continue; // Blank line
+        }
+
+        if (not (stream >> weight) or element_id >= nb_elements or weight <= 0) {
+            return false;
+        }
+
+        elements.emplace_back(element_id);
+        weights.emplace_back(weight);
+    }
+
+    p_hyper_reduction_elements = std::move(elements);
+    p_hyper_reduction_weights = std::move(weights);
+
+    return true;
+}
+
 template <typename Element>
 auto HyperelasticForcefield<Element>::get_gauss_nodes(const std::size_t & /*element_id*/, const Element & element) const -> GaussContainer {
     GaussContainer gauss_nodes {};
@@ -597,4 +854,41 @@ auto HyperelasticForcefield<Element>::cond() -> Real {
     return min/max;
 }
 
+template <typename Element>
+auto HyperelasticForcefield<Element>::elements_critical_time_step() const -> std::vector<FLOATING_POINT_TYPE> {
+    using sofa::core::objectmodel::BaseContext;
+
+    const auto material = d_material.get();
+    const auto mass = this->getContext()->template get<mass::CaribouMass<Element>>(BaseContext::Local);
+    if (not material or not mass or not this->topology() or mass->density() <= 0) {
+        return {};
+    }
+
+    // Dilatational wave speed at the undeformed state, c = sqrt((lambda + 2mu) / rho). The P-wave modulus (lambda + 2mu)
+    // is computed from the material parameters, which leaves the coefficients updated by the material untouched.
+    const auto P_wave_modulus = static_cast<FLOATING_POINT_TYPE>(material->P_wave_modulus());
+    if (P_wave_modulus <= 0) {
+        return {};
+    }
+    const auto c = std::sqrt(P_wave_modulus / mass->density());
+
+    const auto nb_elements = this->number_of_elements();
+    std::vector<FLOATING_POINT_TYPE> critical_time_steps (nb_elements);
+    for (std::size_t element_id = 0; element_id < nb_elements; ++element_id) {
+        const auto element = this->topology()->element(element_id);
+
+        // Characteristic length of the element taken as the smallest distance between two of its nodes
+        auto L = std::numeric_limits<FLOATING_POINT_TYPE>::max();
+        for (std::size_t i = 0; i < NumberOfNodesPerElement; ++i) {
+            for (std::size_t j = i+1; j < NumberOfNodesPerElement; ++j) {
+                L = std::min(L, static_cast<FLOATING_POINT_TYPE>((element.node(i) - element.node(j)).norm()));
+            }
+        }
+
+        critical_time_steps[element_id] = L / c;
+    }
+
+    return critical_time_steps;
+}
+
 } // namespace SofaCaribou::forcefield
@@ -6,6 +6,7 @@
 
 DISABLE_ALL_WARNINGS_BEGIN
 #include <sofa/core/Mapping.h>
+#include <sofa/helper/OptionsGroup.h>
 DISABLE_ALL_WARNINGS_END
 
 namespace SofaCaribou::mapping {
@@ -66,18 +67,69 @@ public:
         return SofaCaribou::topology::CaribouTopology<Element>::templateName();
     }
 
+    /** Spatial index used to find the elements containing the mapped nodes. */
+    CARIBOU_API
+    auto spatial_index() const -> caribou::topology::SpatialIndex;
+
+    /** Set the spatial index used to find the elements containing the mapped nodes. */
+    CARIBOU_API
+    void set_spatial_index(const caribou::topology::SpatialIndex & spatial_index);
+
+    /**
+     * Update the embedding of a subset of the mapped nodes from their current rest positions (for example, after a
+     * cut or a needle insertion moved them). The container elements of these nodes are found incrementally from their
+     * previous ones (see caribou::topology::BarycentricContainer::update_embedded_points), and their rows of the
+     * mapping matrix are updated in place. Every index must appear only once, otherwise nothing is updated.
+     */
+    CARIBOU_API
+    void update_embedding(const std::vector<sofa::Index> & mapped_node_indices);
+
     template <typename Derived>
     CARIBOU_API
     static auto canCreate(Derived * o, sofa::core::objectmodel::BaseContext* context, sofa::core::objectmodel::BaseObjectDescription* arg) -> bool;
 
 private:
+    /**
+     * Assemble the mapping matrix J (and its transpose) from the barycentric points of the mapped nodes.
+     */
+    void compute_mapping_matrix();
+
+    /**
+     * Attach the mapped nodes found outside of the topology to their closest element (when enabled), and update the
+     * maximum projection distance.
+     */
+    void project_outside_nodes();
+
+    /**
+     * Compute the mapped values y = J x from the values x of the container nodes (one value per row), using the
+     * precomputed mapping matrix. The rows of y (mapped nodes) are computed in parallel when OpenMP is available.
+     */
+    template <typename Derived1, typename Derived2>
+    void apply_mapping_matrix(const Eigen::MatrixBase<Derived1> & x, Eigen::MatrixBase<Derived2> & y) const;
+
+    /**
+     * Accumulate x += J^T y into the values x of the container nodes from the mapped values y (one value per row),
+     * using the precomputed transposed mapping matrix. Every row of x (container node) gathers the values of its own
+     * mapped nodes, hence the rows are computed in parallel when OpenMP is available without any write conflicts.
+     */
+    template <typename Derived1, typename Derived2>
+    void apply_transposed_mapping_matrix(const Eigen::MatrixBase<Derived1> & y, Eigen::MatrixBase<Derived2> & x) const;
+
     // Data members
     Link<SofaCaribou::topology::CaribouTopology<Element>> d_topology;
+    sofa::core::objectmodel::Data<sofa::helper::OptionsGroup> d_spatial_index;
+    sofa::core::objectmodel::Data<bool> d_project_outside_nodes;
+    sofa::core::objectmodel::Data<Scalar> d_maximum_projection_distance;
 
     // Private members
     std::unique_ptr<caribou::topology::BarycentricContainer<Domain>> p_barycentric_container;
 
-    Eigen::SparseMatrix<Scalar> p_J; ///< Mapping matrix
+    /// Mapping matrix (one row per mapped node). It is stored row-major in the precision of the mapped model, so that
+    /// mapping positions and velocities is a streaming sparse matrix-vector product over independent rows.
+    Eigen::SparseMatrix<MappedScalar, Eigen::RowMajor> p_J;
+
+    /// Explicit copy of the transposed mapping matrix (one row per container node), used to accumulate the forces
+    Eigen::SparseMatrix<MappedScalar, Eigen::RowMajor> p_JT;
 };
 
 } // namespace SofaCaribou::mapping
@@ -7,6 +7,9 @@ DISABLE_ALL_WARNINGS_BEGIN
 #include <sofa/core/visual/VisualParams.h>
 DISABLE_ALL_WARNINGS_END
 
+#include <algorithm>
+#include <array>
+
 #if (defined(SOFA_VERSION) && SOFA_VERSION < 201200)
 namespace sofa { using Index = unsigned int; }
 #endif
@@ -23,7 +26,35 @@ namespace SofaCaribou::mapping {
 template<typename Element, typename MappedDataTypes>
 CaribouBarycentricMapping<Element, MappedDataTypes>::CaribouBarycentricMapping()
 : d_topology(initLink("topology", "Topology that contains the embedding (parent) elements."))
+, d_spatial_index(initData(&d_spatial_index,
+    "spatial_index",
+    R"(
+    Spatial index used to find the elements containing the mapped nodes.
+      HASH_GRID:      Hash table from the grid cells to the vectors of their elements.
+      FLAT_HASH_GRID: Sorted (cell, element) pairs stored contiguously, built in parallel. Uses less memory and is
+                      faster to build on large domains.
+      BVH:            Tree of the element bounding boxes, built in parallel. Suited for meshes having highly
+                      non-uniform element sizes (for example, adaptively refined meshes).
+    )"))
+, d_project_outside_nodes(initData(&d_project_outside_nodes,
+    false,
+    "project_outside_nodes",
+    "If true, the mapped nodes found outside of the topology are attached to their closest element, using the "
+    "local coordinates of their projection onto this element. Otherwise, every mapped nodes must be found inside "
+    "the topology."))
+, d_maximum_projection_distance(initData(&d_maximum_projection_distance,
+    static_cast<Scalar>(0),
+    "maximum_projection_distance",
+    "Maximum distance between a mapped node found outside of the topology and its projection onto its closest "
+    "element (only computed when project_outside_nodes is true).",
+    true /*is_displayed_in_gui*/, true /*is_read_only*/))
 {
+    d_spatial_index.setValue(sofa::helper::OptionsGroup(std::vector<std::string> {
+        "HASH_GRID", "FLAT_HASH_GRID", "BVH"
+    }));
+
+    // Select the default value
+    set_spatial_index(caribou::topology::SpatialIndex::HashGrid);
 }
 
 template<typename Element, typename MappedDataTypes>
@@ -92,23 +123,59 @@ void CaribouBarycentricMapping<Element, MappedDataTypes>::init() {
             this->getToModel()->readRestPositions().size(),
             Dimension
         );
-    p_barycentric_container.reset(new caribou::topology::BarycentricContainer<Domain>(d_topology->domain()->embed(mapped_rest_positions)));
+    p_barycentric_container.reset(new caribou::topology::BarycentricContainer<Domain>(d_topology->domain()->embed(mapped_rest_positions, spatial_index())));
+
+    d_maximum_projection_distance.setValue(0);
+    project_outside_nodes();
 
     if (not p_barycentric_container->outside_nodes().empty()) {
         const auto n = p_barycentric_container->outside_nodes().size();
         msg_error() << n << " / " << mapped_rest_positions.rows() << " "
                       << "mapped nodes were found outside of the embedding topology, i.e., they are not "
-                      << "contained inside any elements. Every nodes must be found inside the domain.";
+                      << "contained inside any elements. Every nodes must be found inside the domain, unless "
+                      << "project_outside_nodes is enabled.";
         return;
     }
 
     // Precompute the mapping matrix (derivative of the mapping function w.r.t rest position).
+    compute_mapping_matrix();
+
+    // This is needed to map the initial nodal positions and velocities (and, optionally, rest positions).
+    Inherit1 ::init();
+}
+
+template<typename Element, typename MappedDataTypes>
+auto CaribouBarycentricMapping<Element, MappedDataTypes>::spatial_index() const -> caribou::topology::SpatialIndex {
+    using caribou::topology::SpatialIndex;
+    const auto v = d_spatial_index.getValue().getSelectedId();
+    switch (v) {
+        case 0:
+            return SpatialIndex::HashGrid;
+        case 1:
+            return SpatialIndex::FlatHashGrid;
+        case 2:
+            return SpatialIndex::BVH;
+    }
+
+    // Default value
+    return SpatialIndex::HashGrid;
+}
+
+template<typename Element, typename MappedDataTypes>
+void CaribouBarycentricMapping<Element, MappedDataTypes>::set_spatial_index(const caribou::topology::SpatialIndex & spatial_index) {
+    using namespace sofa::helper;
+    auto spatial_index_option = WriteOnlyAccessor<sofa::core::objectmodel::Data<OptionsGroup>>(d_spatial_index);
+    spatial_index_option->setSelectedItem(static_cast<unsigned int> (spatial_index));
+}
+
+template<typename Element, typename MappedDataTypes>
+void CaribouBarycentricMapping<Element, MappedDataTypes>::compute_mapping_matrix() {
     p_J.setZero(); // Let's clear it just in case init was called previously
     p_J.resize(this->getToModel()->getSize(), this->getFromModel()->getSize());
-    std::vector<Eigen::Triplet<Scalar>> entries;
-    entries.reserve(this->getFromModel()->getSize());
+    std::vector<Eigen::Triplet<MappedScalar>> entries;
     const auto * domain = d_topology->domain();
     const auto & barycentric_points = p_barycentric_container->barycentric_points();
+    entries.reserve(barycentric_points.size()*domain->number_of_nodes_per_elements());
     for (std::size_t i = 0; i < barycentric_points.size(); ++i) {
         const auto & bp = barycentric_points[i];
         const auto & node_indices = domain->element_indices(bp.element_index);
@@ -116,13 +183,118 @@ void CaribouBarycentricMapping<Element, MappedDataTypes>::init() {
         const auto L = e.L(bp.local_coordinates); // Shape functions at barycentric coordinates
         for (Eigen::Index j = 0; j < node_indices.rows(); ++j) {
             const auto & node_index = node_indices[j];
-            entries.emplace_back(i, node_index, L[j]);
+            entries.emplace_back(i, node_index, static_cast<MappedScalar>(L[j]));
         }
     }
     p_J.setFromTriplets(entries.begin(), entries.end());
+    p_JT = p_J.transpose();
+}
 
-    // This is needed to map the initial nodal positions and velocities (and, optionally, rest positions).
-    Inherit1 ::init();
+template<typename Element, typename MappedDataTypes>
+void CaribouBarycentricMapping<Element, MappedDataTypes>::project_outside_nodes() {
+    const auto number_of_outside_nodes = p_barycentric_container->outside_nodes().size();
+    if (not d_project_outside_nodes.getValue() or number_of_outside_nodes == 0) {
+        return;
+    }
+
+    auto mapped_rest_positions =
+        Eigen::Map<const Eigen::Matrix<Scalar, Eigen::Dynamic, Dimension, Eigen::RowMajor>> (
+            this->getToModel()->readRestPositions()[0].ptr(),
+            this->getToModel()->readRestPositions().size(),
+            Dimension
+        );
+    const auto distance = static_cast<Scalar>(p_barycentric_container->project_outside_nodes(mapped_rest_positions));
+
+    // Nodes projected previously (for example, before an update of the embedding) are kept in the maximum
+    d_maximum_projection_distance.setValue(std::max(d_maximum_projection_distance.getValue(), distance));
+
+    msg_info() << number_of_outside_nodes << " / " << mapped_rest_positions.rows() << " "
+               << "mapped nodes were found outside of the embedding topology, and were attached to their closest "
+               << "element. The maximum distance between these nodes and their projection is " << distance << ".";
+}
+
+template<typename Element, typename MappedDataTypes>
+void CaribouBarycentricMapping<Element, MappedDataTypes>::update_embedding(const std::vector<sofa::Index> & mapped_node_indices) {
+    if (not p_barycentric_container) {
+        msg_error() << "The mapping must be initialized before updating its embedding.";
+        return;
+    }
+
+    // New rest positions of the mapped nodes
+    const auto mapped_rest_positions = this->getToModel()->readRestPositions();
+    const auto number_of_updated_nodes = static_cast<Eigen::Index>(mapped_node_indices.size());
+    Eigen::Matrix<Scalar, Eigen::Dynamic, Dimension, Eigen::RowMajor> positions (number_of_updated_nodes, Dimension);
+    std::vector<UNSIGNED_INTEGER_TYPE> indices (mapped_node_indices.size());
+    std::vector<bool> is_updated (mapped_rest_positions.size(), false);
+    for (Eigen::Index i = 0; i < number_of_updated_nodes; ++i) {
+        const auto & node_index = mapped_node_indices[static_cast<std::size_t>(i)];
+        if (node_index >= mapped_rest_positions.size()) {
+            msg_error() << "Trying to update the mapped node #" << node_index << ", but the mapped model only has "
+                        << mapped_rest_positions.size() << " nodes.";
+            return;
+        }
+
+        // Each row of the mapping matrix is rewritten by a single thread
+        if (is_updated[node_index]) {
+            msg_error() << "The mapped node #" << node_index << " appears more than once in the nodes to update.";
+            return;
+        }
+        is_updated[node_index] = true;
+        indices[static_cast<std::size_t>(i)] = node_index;
+        for (Eigen::Index j = 0; j < Dimension; ++j) {
+            positions(i, j) = static_cast<Scalar>(mapped_rest_positions[node_index][j]);
+        }
+    }
+
+    p_barycentric_container->update_embedded_points(indices, positions);
+    project_outside_nodes();
+
+    if (not p_barycentric_container->outside_nodes().empty()) {
+        msg_error() << p_barycentric_container->outside_nodes().size() << " / " << mapped_rest_positions.size() << " "
+                    << "mapped nodes were found outside of the embedding topology after the update.";
+        return;
+    }
+
+    const auto * domain = d_topology->domain();
+
+    // The mapping matrix was never assembled (some nodes were outside at initialization), assemble it completely
+    if (p_J.rows() != static_cast<Eigen::Index>(mapped_rest_positions.size()) or p_J.nonZeros() != p_J.rows()*domain->number_of_nodes_per_elements()) {
+        compute_mapping_matrix();
+        return;
+    }
+
+    // Update the rows of the mapping matrix in place: a row always contains the shape values of the nodes of one
+    // element, hence its number of entries does not change
+    const auto & barycentric_points = p_barycentric_container->barycentric_points();
+    const auto * outer_indices = p_J.outerIndexPtr();
+    auto * inner_indices = p_J.innerIndexPtr();
+    auto * values = p_J.valuePtr();
+
+    #pragma omp parallel for
+    for (Eigen::Index i = 0; i < number_of_updated_nodes; ++i) {
+        const auto & row = indices[static_cast<std::size_t>(i)];
+        const auto & bp = barycentric_points[row];
+        const auto & node_indices = domain->element_indices(bp.element_index);
+        const auto e = domain->element(bp.element_index);
+        const auto L = e.L(bp.local_coordinates); // Shape functions at barycentric coordinates
+
+        // The column indices of a row must be sorted
+        std::array<std::pair<Eigen::Index, MappedScalar>, Element::NumberOfNodesAtCompileTime> entries;
+        for (std::size_t j = 0; j < entries.size(); ++j) {
+            const auto jj = static_cast<Eigen::Index>(j);
+            entries[j] = {static_cast<Eigen::Index>(node_indices[jj]), static_cast<MappedScalar>(L[jj])};
+        }
+        std::sort(entries.begin(), entries.end());
+
+        auto k = outer_indices[row];
+        for (const auto & [node_index, shape_value] : entries) {
+            inner_indices[k] = static_cast<typename decltype(p_J)::StorageIndex>(node_index);
+            values[k] = shape_value;
+            ++k;
+        }
+    }
+
+    p_JT = p_J.transpose();
 }
 
 template<typename Element, typename MappedDataTypes>
@@ -153,7 +325,7 @@ void CaribouBarycentricMapping<Element, MappedDataTypes>::apply(const sofa::core
             );
 
     // Interpolate the parent positions onto the mapped nodes
-    p_barycentric_container->interpolate(positions, mapped_positions);
+    apply_mapping_matrix(positions, mapped_positions);
 }
 
 template<typename Element, typename MappedDataTypes>
@@ -183,8 +355,8 @@ void CaribouBarycentricMapping<Element, MappedDataTypes>::applyJ(const sofa::cor
                     MappedDimension
             );
 
-    // Interpolate the parent positions onto the mapped nodes
-    p_barycentric_container->interpolate(velocities, mapped_velocities);
+    // Interpolate the parent velocities onto the mapped nodes
+    apply_mapping_matrix(velocities, mapped_velocities);
 }
 
 template<typename Element, typename MappedDataTypes>
@@ -215,8 +387,7 @@ void CaribouBarycentricMapping<Element, MappedDataTypes>::applyJT(const sofa::co
             );
 
     // Inverse mapping using the transposed of the Jacobian matrix
-    forces.noalias() += p_J.transpose() * mapped_forces;
-
+    apply_transposed_mapping_matrix(mapped_forces, forces);
 }
 
 template<typename Element, typename MappedDataTypes>
@@ -224,8 +395,6 @@ void CaribouBarycentricMapping<Element, MappedDataTypes>::applyJT(const sofa::co
                                                                   CaribouBarycentricMapping::DataMapMapSparseMatrix & data_output_jacobian,
                                                                   const CaribouBarycentricMapping::MappedDataMapMapSparseMatrix & data_input_mapped_jacobian) {
     using SparseMatrix = decltype(p_J);
-    using StorageIndex = typename SparseMatrix::StorageIndex;
-    static constexpr auto J_is_row_major = SparseMatrix::IsRowMajor;
 
     // Sanity check
     if (not p_barycentric_container or not p_barycentric_container->outside_nodes().empty()) {
@@ -251,28 +420,70 @@ void CaribouBarycentricMapping<Element, MappedDataTypes>::applyJT(const sofa::co
             auto mapped_node_index  =  colIt.index();
             auto mapped_value = colIt.val();
 
-            if constexpr (J_is_row_major) {
-                for (typename SparseMatrix::InnerIterator it(p_J, mapped_node_index); it; ++it) {
-                    const auto node_index = it.col();
-                    const auto shape_value = it.value();
-                    output_row.addCol(node_index, mapped_value*shape_value);
-                }
-            } else {
-                // J is column major
-                for (int node_index=0; node_index<p_J.outerSize(); ++node_index) {
-                    const auto & start = p_J.outerIndexPtr()[node_index];
-                    const auto & end   = p_J.outerIndexPtr()[node_index+1];
-                    const auto id = p_J.data().searchLowerIndex(start, end, static_cast<StorageIndex>(mapped_node_index));
-                    if ((id<end) && (p_J.data().index(id)==static_cast<StorageIndex>(mapped_node_index))) {
-                        const auto shape_value = p_J.data().value(id);
-                        output_row.addCol(node_index, mapped_value*shape_value);
-                    }
-                }
+            // The row of J contains the shape values of the container nodes evaluated at the mapped node
+            for (typename SparseMatrix::InnerIterator it(p_J, mapped_node_index); it; ++it) {
+                const auto node_index = it.col();
+                const auto shape_value = it.value();
+                output_row.addCol(node_index, mapped_value*static_cast<Scalar>(shape_value));
             }
         }
     }
 }
 
+template<typename Element, typename MappedDataTypes>
+template <typename Derived1, typename Derived2>
+void CaribouBarycentricMapping<Element, MappedDataTypes>::apply_mapping_matrix(const Eigen::MatrixBase<Derived1> & x,
+                                                                               Eigen::MatrixBase<Derived2> & y) const {
+    using MappedValue = Eigen::Matrix<MappedScalar, 1, MappedDimension>;
+
+    if (x.rows() != p_J.cols() or y.rows() != p_J.rows()) {
+        msg_error() << "The number of container nodes (" << x.rows() << ") or mapped nodes (" << y.rows() << ") does "
+                    << "not match the size of the mapping matrix (" << p_J.rows() << "x" << p_J.cols() << ").";
+        return;
+    }
+    const auto * outer_indices = p_J.outerIndexPtr();
+    const auto * inner_indices = p_J.innerIndexPtr();
+    const auto * values = p_J.valuePtr();
+    const auto number_of_mapped_nodes = static_cast<Eigen::Index>(p_J.rows());
+
+    // Every mapped node only depends on the few nodes of its container element (one row of J)
+    #pragma omp parallel for
+    for (Eigen::Index i = 0; i < number_of_mapped_nodes; ++i) {
+        MappedValue value = MappedValue::Zero();
+        for (auto k = outer_indices[i]; k < outer_indices[i+1]; ++k) {
+            value.noalias() += values[k] * x.row(inner_indices[k]).template cast<MappedScalar>();
+        }
+        y.row(i) = value;
+    }
+}
+
+template<typename Element, typename MappedDataTypes>
+template <typename Derived1, typename Derived2>
+void CaribouBarycentricMapping<Element, MappedDataTypes>::apply_transposed_mapping_matrix(const Eigen::MatrixBase<Derived1> & y,
+                                                                                          Eigen::MatrixBase<Derived2> & x) const {
+    using Value = Eigen::Matrix<Scalar, 1, Dimension>;
+
+    if (x.rows() != p_JT.rows() or y.rows() != p_JT.cols()) {
+        msg_error() << "The number of container nodes (" << x.rows() << ") or mapped nodes (" << y.rows() << ") does "
+                    << "not match the size of the transposed mapping matrix (" << p_JT.rows() << "x" << p_JT.cols() << ").";
+        return;
+    }
+
+    const auto * outer_indices = p_JT.outerIndexPtr();
+    const auto * inner_indices = p_JT.innerIndexPtr();
+    const auto * values = p_JT.valuePtr();
+    const auto number_of_nodes = static_cast<Eigen::Index>(p_JT.rows());
+
+    #pragma omp parallel for
+    for (Eigen::Index i = 0; i < number_of_nodes; ++i) {
+        Value value = Value::Zero();
+        for (auto k = outer_indices[i]; k < outer_indices[i+1]; ++k) {
+            value.noalias() += static_cast<Scalar>(values[k]) * y.row(inner_indices[k]).template cast<Scalar>();
+        }
+        x.row(i) += value;
+    }
+}
+
 template<typename Element, typename MappedDataTypes>
 void CaribouBarycentricMapping<Element, MappedDataTypes>::draw(const sofa::core::visual::VisualParams *vparams) {
     if ( !vparams->displayFlags().getShowMappings() ) return;
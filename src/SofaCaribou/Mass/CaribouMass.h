@@ -1,6 +1,7 @@
 #pragma once
 
 #include <SofaCaribou/config.h>
+#include <SofaCaribou/Ode/CombinedMBKdxProvider.h>
 #include <SofaCaribou/Topology/CaribouTopology.h>
 
 DISABLE_ALL_WARNINGS_BEGIN
@@ -8,8 +9,11 @@ DISABLE_ALL_WARNINGS_BEGIN
 #include <sofa/core/topology/BaseMeshTopology.h>
 #include <sofa/defaulttype/VecTypes.h>
 #include <sofa/core/behavior/Mass.h>
+#include <sofa/helper/OptionsGroup.h>
 DISABLE_ALL_WARNINGS_END
 
+#include <Eigen/Sparse>
+
 #if (defined(SOFA_VERSION) && SOFA_VERSION < 201299)
 namespace sofa { using Index = unsigned int; }
 #endif
@@ -56,7 +60,7 @@ template <> struct SofaVecType<3> { using Type = sofa::defaulttype::Vec3Types; }
  * @tparam Element The element type of this mass. It must inherits from caribou::geometry::Element.
  */
 template <typename Element>
-class CaribouMass : public sofa::core::behavior::Mass<typename SofaVecType<caribou::geometry::traits<Element>::Dimension>::Type> {
+class CaribouMass : public sofa::core::behavior::Mass<typename SofaVecType<caribou::geometry::traits<Element>::Dimension>::Type>, public ode::CombinedMBKdxProvider {
 public:
     SOFA_CLASS(SOFA_TEMPLATE(CaribouMass, Element), SOFA_TEMPLATE(sofa::core::behavior::Mass, typename SofaVecType<caribou::geometry::traits<Element>::Dimension>::Type));
 
@@ -84,6 +88,17 @@ public:
     static constexpr INTEGER_TYPE NumberOfNodesPerElement = caribou::geometry::traits<Element>::NumberOfNodesAtCompileTime;
     static constexpr INTEGER_TYPE NumberOfGaussNodesPerElement = caribou::geometry::traits<Element>::NumberOfGaussNodesAtCompileTime;
 
+    /**
+     * Solvers used to compute the acceleration a = M^(-1).f when the consistent (non-lumped) mass matrix is used.
+     */
+    enum class AccelerationSolver : unsigned int {
+        /// Sparse Cholesky (LDLT) factorization of M, computed once after each assembly of the mass matrix (default)
+        CHOLESKY = 0,
+
+        /// Conjugate gradient preconditioned with the lumped mass matrix
+        CONJUGATE_GRADIENT
+    };
+
     // Data structures
     struct GaussNode {
         Real weight;                          ///< Weight of this integration point
@@ -106,6 +121,9 @@ public:
     CARIBOU_API
     void init() override;
 
+    CARIBOU_API
+    void reinit() override;
+
     template <typename Derived>
     CARIBOU_API
     static auto canCreate(Derived * o, sofa::core::objectmodel::BaseContext* context, sofa::core::objectmodel::BaseObjectDescription* arg) -> bool;
@@ -127,7 +145,8 @@ public:
      *
      *
      * @note The mass matrix must have been assembled beforehand. See the assemble_mass_matrix() methods
-     *       to force an assembly.
+     *       to force an assembly. In matrix-free mode, the consistent mass matrix is only assembled when
+     *       it is needed to solve the acceleration (a = M^(-1).f).
      *
      *
      *  @sa assemble_mass_matrix()
@@ -149,6 +168,12 @@ public:
         return p_Mdiag;
     }
 
+    /** Get the mass density of the material. */
+    [[nodiscard]] inline
+    auto density() const -> Real {
+        return d_density.getValue();
+    }
+
     [[nodiscard]] inline
     auto topology() const noexcept -> typename SofaCaribou::topology::CaribouTopology<Element>::SPtr {
         return p_topology;
@@ -174,6 +199,16 @@ public:
     CARIBOU_API
     void addMDx(const sofa::core::MechanicalParams * mparams, DataVecDeriv & d_f, const DataVecDeriv & d_dx, SReal factor) override;
 
+    /**
+     * Accumulate df += M [m1 dx1 + m2 dx2] with a single mass product.
+     *
+     * @see SofaCaribou::ode::CombinedMBKdxProvider
+     */
+    CARIBOU_API
+    void add_combined_MBKdx(const sofa::core::MechanicalParams * mparams_1,
+                            const sofa::core::MechanicalParams * mparams_2,
+                            sofa::core::MultiVecDerivId df_id) override;
+
 #if (defined(SOFA_VERSION) && SOFA_VERSION < 210600)
     /**
      * @return True if the mass matrix is lumped, false otherwise. The lumping is done by placing integration point
@@ -225,6 +260,33 @@ public:
     CARIBOU_API
     void assemble_mass_matrix(const Eigen::MatrixBase<Derived> & x0);
 
+    /** Get the current solver used to compute the acceleration from the consistent mass matrix. */
+    CARIBOU_API
+    auto acceleration_solver() const -> AccelerationSolver;
+
+    /** Set the current solver used to compute the acceleration from the consistent mass matrix. */
+    CARIBOU_API
+    void set_acceleration_solver(const AccelerationSolver & solver);
+
+    /**
+     * Get the consistent mass matrix of an element. Since every DxD block M_IK of the element mass matrix
+     * is the identity scaled by the same value, only these scalar values are returned as a NxN matrix, with
+     * N the number of nodes of the element.
+     *
+     * @param element_id The index of the element in the topology.
+     * @param element_mass The total mass of the element (integral of the density over the element).
+     */
+    CARIBOU_API
+    auto element_mass_matrix(const std::size_t & element_id, Real & element_mass) const -> Matrix<NumberOfNodesPerElement, NumberOfNodesPerElement>;
+
+    /**
+     * Get the groups (colors) of elements which do not share any node. The elements of a same group can be
+     * processed concurrently when their contributions are scattered to the nodes.
+     */
+    inline auto element_colors() const -> const std::vector<std::vector<std::size_t>> & {
+        return p_element_colors;
+    }
+
     /** Get the set of Gauss integration nodes of an element */
     CARIBOU_API
     inline auto gauss_nodes_of(std::size_t element_id) const -> const auto & {
@@ -232,6 +294,67 @@ public:
     }
 
 private:
+    /**
+     * Preconditioner of the acceleration's conjugate gradient using the inverse of the lumped mass matrix. It follows
+     * Eigen's preconditioner concept, but its diagonal is set from the lumped mass matrix instead of being extracted
+     * from the consistent mass matrix.
+     */
+    class LumpedMassPreconditioner {
+    public:
+        LumpedMassPreconditioner() = default;
+        template<typename MatType> explicit LumpedMassPreconditioner(const MatType &) {}
+        template<typename MatType> auto analyzePattern(const MatType &) -> LumpedMassPreconditioner & { return *this; }
+        template<typename MatType> auto factorize(const MatType &) -> LumpedMassPreconditioner & { return *this; }
+        template<typename MatType> auto compute(const MatType &) -> LumpedMassPreconditioner & { return *this; }
+
+        /** Set the lumped mass matrix of which the inverse will be used as the preconditioner. */
+        void set_lumped_mass(const Eigen::DiagonalMatrix<Real, Eigen::Dynamic> & M_diag) {
+            p_M_diag_inverse = M_diag.diagonal().cwiseInverse();
+        }
+
+        template<typename Rhs>
+        auto solve(const Eigen::MatrixBase<Rhs> & b) const {
+            return p_M_diag_inverse.asDiagonal() * b;
+        }
+
+        [[nodiscard]] auto info() const -> Eigen::ComputationInfo { return Eigen::Success; }
+
+    private:
+        Eigen::Matrix<Real, Eigen::Dynamic, 1> p_M_diag_inverse;
+    };
+
+    /**
+     * Prepare the solver of the acceleration a = M^(-1).f. With the Cholesky solver, the consistent mass matrix is
+     * factorized. This is called automatically after each assembly of the mass matrix when the consistent mass matrix
+     * is used, or at the first call to accFromF otherwise.
+     */
+    void factorize_mass_matrix();
+
+    /**
+     * Assemble the lumped mass matrix, and the consistent mass matrix if with_consistent_matrix is true.
+     * @param nb_nodes The number of nodes of the mechanical state.
+     */
+    void update_mass_matrices(const Eigen::Index & nb_nodes, bool with_consistent_matrix);
+
+    /**
+     * Integrate the nodal gravity force vector (F_I = \int_e rho_0 N_I g) into the gravity_force data, if the gravity
+     * or the density changed since its last computation.
+     */
+    void update_gravity_force();
+
+    /**
+     * Greedy coloring of the elements such that two elements sharing a node never have the same color.
+     */
+    void compute_element_colors();
+
+    /**
+     * Accumulate f += factor * M dx, where f and dx are flat vectors of nb_nodes*Dimension coefficients. The lumped,
+     * assembled or matrix-free product is used following the options of the component.
+     */
+    void add_mass_product(const Eigen::Ref<const Eigen::Matrix<Real, Eigen::Dynamic, 1>> & dx,
+                          Eigen::Ref<Eigen::Matrix<Real, Eigen::Dynamic, 1>> f,
+                          const Real & factor);
+
     // These private methods are implemented but can be overridden
 
     /** Get the set of Gauss integration nodes of the given element */
@@ -252,6 +375,25 @@ private:
     /// Mass density of the material.
     sofa::core::objectmodel::Data<Real> d_density;
 
+    /// Whether or not the mass products M.dx are computed element by element instead of using the assembled
+    /// consistent mass matrix.
+    sofa::core::objectmodel::Data<bool> d_matrix_free;
+
+    /// Enable the multithreading computation of the element by element mass products and of the gravity force.
+    sofa::core::objectmodel::Data<bool> d_enable_multithreading;
+
+    /// Solver used to compute the acceleration a = M^(-1).f from the consistent mass matrix.
+    sofa::core::objectmodel::Data<sofa::helper::OptionsGroup> d_acceleration_solver;
+
+    /// Relative residual tolerance of the acceleration's conjugate gradient.
+    sofa::core::objectmodel::Data<Real> d_acceleration_tolerance;
+
+    /// Consistent nodal forces of the gravity (output).
+    sofa::core::objectmodel::Data<VecDeriv> d_gravity_force;
+
+    /// Norm of the sum of the gravity nodal forces, ie the total weight (output).
+    sofa::core::objectmodel::Data<Real> d_total_weight;
+
     // Private variables
     /// Pointer to a CaribouTopology. This pointer will be null if a CaribouTopology
     /// is found within the scene graph and linked using the d_topology_container data
@@ -269,6 +411,32 @@ private:
     /// Integration points of each elements
     std::vector<GaussContainer> p_elements_quadrature_nodes;
 
+    /// Gravity and density used to compute the gravity force vector, and whether or not this vector is up to date
+    Vector<Dimension> p_cached_gravity;
+    Real p_cached_density = 0;
+    bool p_gravity_force_is_up_to_date = false;
+
+    /// Groups of elements that do not share any node
+    std::vector<std::vector<std::size_t>> p_element_colors;
+
+    /// Whether or not the consistent mass matrix p_M was assembled (it isn't in matrix-free mode until it is needed)
+    bool p_M_is_assembled = false;
+
+    /// Linear combination of the two vectors of the last call to add_combined_MBKdx (kept to avoid reallocations)
+    Eigen::Matrix<Real, Eigen::Dynamic, 1> p_combined_dx;
+
+    /// Sparse Cholesky factorization of the consistent mass matrix, reused by every call to accFromF
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<Real>, Eigen::Upper> p_M_cholesky;
+
+    /// Conjugate gradient solver of the consistent mass matrix, preconditioned by the lumped mass matrix
+    Eigen::ConjugateGradient<Eigen::SparseMatrix<Real>, Eigen::Upper, LumpedMassPreconditioner> p_M_cg;
+
+    /// Whether or not the mass matrix was assembled since the last preparation of the acceleration solver
+    bool p_M_needs_factorization = true;
+
+    /// Acceleration solver that was prepared by the last call to factorize_mass_matrix()
+    AccelerationSolver p_prepared_acceleration_solver = AccelerationSolver::CHOLESKY;
+
 };
 
 } // namespace SofaCaribou::mass
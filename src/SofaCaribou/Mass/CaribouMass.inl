@@ -12,6 +12,14 @@ DISABLE_ALL_WARNINGS_END
 
 namespace SofaCaribou::mass {
 
+namespace {
+#if (defined(SOFA_VERSION) && SOFA_VERSION < 210600)
+using Mat3x3d = sofa::defaulttype::Mat3x3d;
+#else
+using Mat3x3d = sofa::type::Mat3x3d;
+#endif
+} // namespace
+
 template<typename Element>
 CaribouMass<Element>::CaribouMass()
 : d_topology_container(initLink(
@@ -29,7 +37,52 @@ CaribouMass<Element>::CaribouMass()
         Real(1),
         "density",
         "Mass density of the material."))
-{}
+, d_matrix_free(initData(
+        &d_matrix_free,
+        false,
+        "matrix_free",
+        "Compute the mass products (M.dx) and the contribution to the system matrix element by element "
+        "from the shape values at the integration points, instead of using the assembled consistent mass "
+        "matrix. The consistent mass matrix is then only assembled if it is needed to solve the "
+        "acceleration (a = M^(-1).f) with a non-lumped mass."))
+, d_enable_multithreading(initData(
+        &d_enable_multithreading,
+        false,
+        "enable_multithreading",
+        "Enable the multithreading computation of the matrix-free mass products and of the addition of the "
+        "gravity force. For the mass products, the elements are grouped by colors such that the elements of "
+        "a same color do not share nodes, and each color is computed in parallel. When enabled, use the "
+        "environment variable OMP_NUM_THREADS=N to use N threads."))
+, d_acceleration_solver(initData(
+        &d_acceleration_solver,
+        "acceleration_solver",
+        "Solver used to compute the acceleration (a = M^(-1).f) when the mass matrix is not lumped. "
+        "CHOLESKY factorizes the consistent mass matrix once after its assembly and reuses the factorization "
+        "at every time step, while CONJUGATE_GRADIENT iteratively solves the system using the lumped mass "
+        "matrix as a preconditioner."))
+, d_acceleration_tolerance(initData(
+        &d_acceleration_tolerance,
+        Real(1e-10),
+        "acceleration_tolerance",
+        "Relative residual tolerance (|r|/|f|) of the CONJUGATE_GRADIENT acceleration solver."))
+, d_gravity_force(initData(
+        &d_gravity_force,
+        "gravity_force",
+        "Consistent nodal forces of the gravity. It is computed once and only updated when the gravity "
+        "or the density changes.", true, true))
+, d_total_weight(initData(
+        &d_total_weight,
+        Real(0),
+        "total_weight",
+        "Norm of the sum of the gravity nodal forces, ie the total weight.", true, true))
+{
+    d_acceleration_solver.setValue(sofa::helper::OptionsGroup(std::vector<std::string> {
+        "CHOLESKY", "CONJUGATE_GRADIENT"
+    }));
+
+    // Select the default value
+    set_acceleration_solver(AccelerationSolver::CHOLESKY);
+}
 
 template<typename Element>
 void CaribouMass<Element>::init() {
@@ -109,6 +162,15 @@ void CaribouMass<Element>::init() {
     assemble_mass_matrix();
 }
 
+template<typename Element>
+void CaribouMass<Element>::reinit() {
+    if (!this->mstate) {
+        return;
+    }
+
+    assemble_mass_matrix();
+}
+
 template<typename Element>
 template<typename Derived>
 auto CaribouMass<Element>::canCreate(Derived *o, sofa::core::objectmodel::BaseContext *context,
@@ -195,13 +257,48 @@ void CaribouMass<Element>::assemble_mass_matrix(const sofa::Data<VecCoord> & x0)
 template<typename Element>
 template<typename Derived>
 void CaribouMass<Element>::assemble_mass_matrix(const Eigen::MatrixBase<Derived> & x0) {
+    // In matrix-free mode, the consistent mass matrix is only assembled once it is needed to solve the acceleration
+    update_mass_matrices(x0.rows(), not d_matrix_free.getValue());
+}
+
+template<typename Element>
+auto CaribouMass<Element>::element_mass_matrix(const std::size_t & element_id, Real & element_mass) const -> Matrix<NumberOfNodesPerElement, NumberOfNodesPerElement> {
+    const auto density = d_density.getValue();
+
+    Matrix<NumberOfNodesPerElement, NumberOfNodesPerElement> Me = Matrix<NumberOfNodesPerElement, NumberOfNodesPerElement>::Zero();
+    element_mass = 0;
+
+    for (const auto & gauss_node : gauss_nodes_of(element_id)) {
+        // Jacobian of the gauss node's transformation mapping from the elementary space to the world space
+        const auto & detJ = gauss_node.jacobian_determinant;
+
+        // Gauss quadrature node weight
+        const auto & w = gauss_node.weight;
+
+        // Shape functions at gauss node
+        const auto & N = gauss_node.N;
+
+        // Element total mass (used for the lumping algorithm)
+        element_mass += density*w*detJ;
+
+        // Computation of the consistent mass sub-matrices M_ij (the DxD sub-matrix Mij being diagonal)
+        Me.noalias() += (density*w*detJ) * N * N.transpose();
+    }
+
+    return Me;
+}
+
+template<typename Element>
+void CaribouMass<Element>::update_mass_matrices(const Eigen::Index & nb_nodes, bool with_consistent_matrix) {
+    p_M_needs_factorization = true;
+    p_M_is_assembled = false;
+
     const auto density = d_density.getValue();
     if (density < std::numeric_limits<Real>::epsilon()) {
         return;
     }
 
     const auto nb_elements = this->number_of_elements();
-    const auto nb_nodes = x0.rows();
     const auto nDofs = nb_nodes*Dimension;
     p_M.resize(nDofs, nDofs);
     p_Mdiag.setZero(nDofs);
@@ -209,81 +306,135 @@ void CaribouMass<Element>::assemble_mass_matrix(const Eigen::MatrixBase<Derived>
     /// Triplets are used to store matrix entries before the call to 'compress'.
     /// Duplicates entries are summed up.
     std::vector<Eigen::Triplet<Real>> triplets;
-    triplets.reserve(nDofs*3);
+    if (with_consistent_matrix) {
+        triplets.reserve(nDofs*3);
+    }
 
     sofa::helper::AdvancedTimer::stepBegin("CaribouMass::update_mass_matrix");
-    for (int element_id = 0; element_id < static_cast<int>(nb_elements); ++element_id) {
+    for (std::size_t element_id = 0; element_id < nb_elements; ++element_id) {
         // Fetch the node indices of the element
         auto node_indices = this->topology()->domain()->element_indices(element_id);
 
         // Assemble the element's mass matrix
-        using Mass = Eigen::Matrix<FLOATING_POINT_TYPE, NumberOfNodesPerElement*Dimension, NumberOfNodesPerElement*Dimension, Eigen::RowMajor>;
-        Mass Me = Mass::Zero();
         Real element_mass = 0; ///< Used for the lumping algorithm
-
-        for (const auto & gauss_node : gauss_nodes_of(element_id)) {
-            // Jacobian of the gauss node's transformation mapping from the elementary space to the world space
-            const auto & detJ = gauss_node.jacobian_determinant;
-
-            // Gauss quadrature node weight
-            const auto & w = gauss_node.weight;
-
-            // Shape functions at gauss node
-            const auto & N = gauss_node.N;
-
-            // Element total mass (used for the lumping algorithm)
-            element_mass += density*w*detJ;
-
-            // Computation of the consistent mass sub-matrix M_ij
-            for (std::size_t i = 0; i < NumberOfNodesPerElement; ++i) {
-                const auto & Ni = N[i];
-
-                // We now loop only on the upper triangular part of the
-                // element stiffness matrix Ke since it is symmetric
-                for (std::size_t j = i; j < NumberOfNodesPerElement; ++j) {
-                    const auto & Nj = N[j];
-
-                    // The 3x3 sub-matrix Mij is diagonal
-                    Me.template block<3, 3>(i*Dimension, j*Dimension)
-                      .template diagonal<0>()
-                      += Vector<3>::Constant(density*Ni*Nj*w*detJ);
-                }
-            }
-        }
+        const auto Me = element_mass_matrix(element_id, element_mass);
 
         // Assembling the diagonal lumped mass matrix
-        Real sum_of_nodal_masses = 0;
-        for (std::size_t i = 0; i < NumberOfNodesPerElement; ++i) {
-            sum_of_nodal_masses += Me(i*Dimension, i*Dimension);
-        }
+        const Real sum_of_nodal_masses = Me.diagonal().sum();
         for (std::size_t i = 0; i < NumberOfNodesPerElement; ++i) {
             // Node index of the ith node in the global stiffness matrix
             auto x = static_cast<int>(node_indices[i]*Dimension);
             // Factor that scales down the diagonal terms in such a way that the mass
             // is constant within the element (see Hinton et al. 1976 and Wriggers 2008)
             const auto scaling_factor = element_mass / sum_of_nodal_masses;
-            const auto diagonal_mass = Me(i*Dimension, i*Dimension) * scaling_factor;
+            const auto diagonal_mass = Me(i, i) * scaling_factor;
             for (int m = 0; m < Dimension; ++m) {
                 p_Mdiag.diagonal()[x+m] += diagonal_mass;
             }
         }
 
+        if (not with_consistent_matrix) {
+            continue;
+        }
+
         // Assembling the full consistent mass matrix
         for (std::size_t i = 0; i < NumberOfNodesPerElement; ++i) {
-            // Node index of the ith node in the global stiffness matrix
-            auto x = static_cast<int>(node_indices[i]*Dimension);
             for (std::size_t j = i; j < NumberOfNodesPerElement; ++j) {
-                // Node index of the jth node in the global stiffness matrix
+                // Node indices of the ith and jth nodes in the global stiffness matrix
+                auto x = static_cast<int>(node_indices[i]*Dimension);
                 auto y = static_cast<int>(node_indices[j]*Dimension);
                 if (x > y) std::swap(x, y); // Fill-in the upper diagonal only
                 for (int m = 0; m < Dimension; ++m) {
-                    triplets.emplace_back(x+m, y+m, Me(i*Dimension+m,j*Dimension+m));
+                    triplets.emplace_back(x+m, y+m, Me(i, j));
                 }
             }
         }
     }
-    p_M.setFromTriplets(triplets.begin(), triplets.end());
+
+    if (with_consistent_matrix) {
+        p_M.setFromTriplets(triplets.begin(), triplets.end());
+        p_M_is_assembled = true;
+    }
     sofa::helper::AdvancedTimer::stepEnd("CaribouMass::update_mass_matrix");
+
+    // The factorization is only needed when the consistent mass matrix is used to compute the acceleration
+    if (with_consistent_matrix and not d_lumped.getValue()) {
+        factorize_mass_matrix();
+    }
+}
+
+template<typename Element>
+void CaribouMass<Element>::compute_element_colors() {
+    p_element_colors.clear();
+    if (not this->mstate) {
+        return;
+    }
+
+    const auto nb_elements = this->number_of_elements();
+    const auto nb_nodes = this->mstate->getSize();
+
+    // Colors already used by the elements around each node
+    std::vector<std::vector<std::size_t>> node_colors (nb_nodes);
+    std::vector<bool> color_is_used;
+    for (std::size_t element_id = 0; element_id < nb_elements; ++element_id) {
+        const auto node_indices = this->topology()->domain()->element_indices(element_id);
+
+        color_is_used.assign(p_element_colors.size()+1, false);
+        for (std::size_t i = 0; i < NumberOfNodesPerElement; ++i) {
+            for (const auto & color : node_colors[node_indices[i]]) {
+                color_is_used[color] = true;
+            }
+        }
+
+        const auto color = static_cast<std::size_t>(
+            std::distance(color_is_used.begin(), std::find(color_is_used.begin(), color_is_used.end(), false))
+        );
+        if (color == p_element_colors.size()) {
+            p_element_colors.emplace_back();
+        }
+        p_element_colors[color].emplace_back(element_id);
+
+        for (std::size_t i = 0; i < NumberOfNodesPerElement; ++i) {
+            node_colors[node_indices[i]].emplace_back(color);
+        }
+    }
+}
+
+template<typename Element>
+void CaribouMass<Element>::factorize_mass_matrix() {
+    sofa::helper::ScopedAdvancedTimer _t_ ("CaribouMass::factorize_mass_matrix");
+
+    p_prepared_acceleration_solver = acceleration_solver();
+    p_M_needs_factorization = false;
+
+    if (p_prepared_acceleration_solver == AccelerationSolver::CONJUGATE_GRADIENT) {
+        p_M_cg.compute(p_M);
+        p_M_cg.preconditioner().set_lumped_mass(p_Mdiag);
+    } else {
+        p_M_cholesky.compute(p_M);
+        if (p_M_cholesky.info() != Eigen::Success) {
+            msg_error() << "Failed to factorize the consistent mass matrix.";
+        }
+    }
+}
+
+template<typename Element>
+auto CaribouMass<Element>::acceleration_solver() const -> AccelerationSolver {
+    const auto v = static_cast<AccelerationSolver>(d_acceleration_solver.getValue().getSelectedId());
+    switch (v) {
+        case AccelerationSolver::CHOLESKY:
+        case AccelerationSolver::CONJUGATE_GRADIENT:
+            return v;
+    }
+
+    // Default value
+    return AccelerationSolver::CHOLESKY;
+}
+
+template<typename Element>
+void CaribouMass<Element>::set_acceleration_solver(const AccelerationSolver & solver) {
+    auto acceleration_solver = sofa::helper::WriteOnlyAccessor<sofa::core::objectmodel::Data<sofa::helper::OptionsGroup>>(d_acceleration_solver);
+    acceleration_solver->setSelectedItem(static_cast<unsigned int> (solver));
 }
 
 template <typename Element>
@@ -359,33 +510,37 @@ void CaribouMass<Element>::initialize_elements()
 
     msg_info() << "Total mass of the geometry is " << v*d_density.getValue();
 
+    // Group the elements by colors for the parallel matrix-free products
+    compute_element_colors();
+
+    // The integration points changed, the gravity force vector will have to be recomputed
+    p_gravity_force_is_up_to_date = false;
+
     sofa::helper::AdvancedTimer::stepEnd("CaribouMass::initialize_elements");
 }
 
 template<typename Element>
-void CaribouMass<Element>::addForce(const sofa::core::MechanicalParams * /*mparams*/, CaribouMass::DataVecDeriv & d_f,
-                                    const CaribouMass::DataVecCoord & d_x, const CaribouMass::DataVecDeriv & /*d_v*/) {
+void CaribouMass<Element>::update_gravity_force() {
     const auto density = d_density.getValue();
-    if (density < std::numeric_limits<Real>::epsilon()) {
+    const auto g_sofa = this->getContext()->getGravity();
+    const Vector<Dimension> g = Eigen::Map<const Eigen::Matrix<SReal, Dimension, 1>>(g_sofa.data()).template cast<Real>();
+    const auto nb_nodes = this->mstate->getSize();
+
+    if (p_gravity_force_is_up_to_date and p_cached_density == density and p_cached_gravity == g and
+        d_gravity_force.getValue().size() == nb_nodes) {
         return;
     }
 
-    const auto g_sofa = this->getContext()->getGravity();
-    Eigen::Map<const Eigen::Matrix<Real, 3, 1>> g (g_sofa.data());
-
-    // Map SOFA vectors to Eigen matrices
-    const sofa::helper::ReadAccessor<DataVecCoord> sofa_x = d_x;
-    sofa::helper::WriteAccessor<DataVecDeriv> sofa_f = d_f;
-    const auto nb_nodes = sofa_x.size();
-    Eigen::Map<const Eigen::Matrix<Real, Eigen::Dynamic, Dimension, Eigen::RowMajor>> x (sofa_x.ref().data()->data(),  nb_nodes, Dimension);
-    Eigen::Map<Eigen::Matrix<Real, Eigen::Dynamic, Dimension, Eigen::RowMajor>> f (&(sofa_f[0][0]),  nb_nodes, Dimension);
+    sofa::helper::ScopedAdvancedTimer _t_ ("CaribouMass::update_gravity_force");
 
-    // Start the timer
-    sofa::helper::ScopedAdvancedTimer _t_ ("CaribouMass::addForce");
+    sofa::helper::WriteOnlyAccessor<DataVecDeriv> sofa_gravity_force = d_gravity_force;
+    sofa_gravity_force.resize(nb_nodes);
+    Eigen::Map<Eigen::Matrix<Real, Eigen::Dynamic, Dimension, Eigen::RowMajor>> G (&(sofa_gravity_force[0][0]),  nb_nodes, Dimension);
+    G.setZero();
 
     // Assemble the force vector
     const auto nb_elements = this->number_of_elements();
-    for (int element_id = 0; element_id < static_cast<int>(nb_elements); ++element_id) {
+    for (std::size_t element_id = 0; element_id < nb_elements; ++element_id) {
         // Fetch the node indices of the element
         auto node_indices = this->topology()->domain()->element_indices(element_id);
 
@@ -400,15 +555,54 @@ void CaribouMass<Element>::addForce(const sofa::core::MechanicalParams * /*mpara
             const auto & N = gauss_node.N;
 
             // Force at Gauss point
-            const Eigen::Matrix<Real, 3, 1> force = g*density*w*detJ;
+            const Vector<Dimension> force = g*density*w*detJ;
 
             // Force at the ith node
             for (std::size_t i = 0; i < NumberOfNodesPerElement; ++i) {
                 const auto & Ni = N[i];
-                f.row(node_indices[i]) += force*Ni;
+                G.row(node_indices[i]) += force.transpose()*Ni;
             }
         }
     }
+
+    d_total_weight.setValue(G.colwise().sum().norm());
+
+    p_cached_density = density;
+    p_cached_gravity = g;
+    p_gravity_force_is_up_to_date = true;
+}
+
+template<typename Element>
+void CaribouMass<Element>::addForce(const sofa::core::MechanicalParams * /*mparams*/, CaribouMass::DataVecDeriv & d_f,
+                                    const CaribouMass::DataVecCoord & /*d_x*/, const CaribouMass::DataVecDeriv & /*d_v*/) {
+    const auto density = d_density.getValue();
+    if (density < std::numeric_limits<Real>::epsilon()) {
+        return;
+    }
+
+    // The gravity force vector is only integrated when the gravity or the density changed
+    update_gravity_force();
+
+    // Start the timer
+    sofa::helper::ScopedAdvancedTimer _t_ ("CaribouMass::addForce");
+
+    // Map SOFA vectors to Eigen vectors
+    const sofa::helper::ReadAccessor<DataVecDeriv> sofa_gravity_force = d_gravity_force;
+    sofa::helper::WriteAccessor<DataVecDeriv> sofa_f = d_f;
+    const auto n = static_cast<Eigen::Index>(std::min(sofa_f.size(), sofa_gravity_force.size())*Dimension);
+    Eigen::Map<const Eigen::Matrix<Real, Eigen::Dynamic, 1>> G (sofa_gravity_force.ref().data()->data(),  n);
+    Eigen::Map<Eigen::Matrix<Real, Eigen::Dynamic, 1>> f (&(sofa_f[0][0]),  n);
+
+    if (d_enable_multithreading.getValue()) {
+        Real * f_data = f.data();
+        const Real * G_data = G.data();
+#pragma omp parallel for simd
+        for (Eigen::Index i = 0; i < n; ++i) {
+            f_data[i] += G_data[i];
+        }
+    } else {
+        f.noalias() += G;
+    }
 }
 
 template<typename Element>
@@ -418,23 +612,55 @@ void CaribouMass<Element>::addMToMatrix(sofa::defaulttype::BaseMatrix * matrix,
 
     const bool lumped = d_lumped.getValue();
 
+    // Add the DxD diagonal block m*I at the position of the pair of nodes (I, K). In 3D, the block is added at once.
+    const auto add_block = [matrix, &offset](const Eigen::Index & I, const Eigen::Index & K, const Real & m) {
+        const auto i = static_cast<sofa::Index>(offset + I*Dimension);
+        const auto k = static_cast<sofa::Index>(offset + K*Dimension);
+        if constexpr (Dimension == 3) {
+            Mat3x3d block;
+            block[0][0] = block[1][1] = block[2][2] = m;
+            matrix->add(i, k, block);
+        } else {
+            for (sofa::Index d = 0; d < Dimension; ++d) {
+                matrix->add(i+d, k+d, m);
+            }
+        }
+    };
+
     if (lumped) {
         // Lumped diagonal mass matrix
         const auto n = p_Mdiag.rows();
         for (int i = 0; i < n; ++i) {
-            const auto & v = p_Mdiag.diagonal()[i];
+            const auto v = p_Mdiag.diagonal()[i] * mFact;
             matrix->add(offset + i, offset + i, v);
         }
+    } else if (not p_M_is_assembled) {
+        // Matrix-free : the element mass matrices are added directly
+        const auto nb_elements = this->number_of_elements();
+        for (std::size_t element_id = 0; element_id < nb_elements; ++element_id) {
+            const auto node_indices = this->topology()->domain()->element_indices(element_id);
+            Real element_mass;
+            const auto Me = element_mass_matrix(element_id, element_mass);
+            for (std::size_t i = 0; i < NumberOfNodesPerElement; ++i) {
+                for (std::size_t j = 0; j < NumberOfNodesPerElement; ++j) {
+                    add_block(node_indices[i], node_indices[j], Me(i, j) * mFact);
+                }
+            }
+        }
     } else {
-        // Sparse mass matrix
-        for (int k = 0; k < p_M.outerSize(); ++k) {
+        // Sparse mass matrix. Only the upper triangular part is stored, and each DxD sub-matrix of a pair
+        // of nodes is a diagonal block having the same value, hence we only have to visit the first
+        // entry of each block.
+        for (int k = 0; k < p_M.outerSize(); k += Dimension) {
             for (typename Eigen::SparseMatrix<Real>::InnerIterator it(p_M, k); it; ++it) {
                 const auto i = it.row();
-                const auto j = it.col();
+                if (i % Dimension != 0) {
+                    continue;
+                }
                 const auto v = it.value() * mFact;
-                matrix->add(offset + i, offset + j, v);
-                if (i != j)
-                    matrix->add(offset + j, offset + i, v);
+                add_block(i / Dimension, k / Dimension, v);
+                if (i != k)
+                    add_block(k / Dimension, i / Dimension, v);
             }
         }
     }
@@ -463,23 +689,40 @@ void CaribouMass<Element>::addGravityToV(const sofa::core::MechanicalParams * mp
 template<typename Element>
 void CaribouMass<Element>::accFromF(const sofa::core::MechanicalParams * /*mparams*/, CaribouMass::DataVecDeriv & d_a,
                                     const CaribouMass::DataVecDeriv & d_f) {
-    // Map SOFA vectors to Eigen matrices
-    const sofa::helper::ReadAccessor<DataVecCoord> sofa_f = d_f;
+    // Map SOFA vectors to Eigen vectors
+    const sofa::helper::ReadAccessor<DataVecDeriv> sofa_f = d_f;
     sofa::helper::WriteAccessor<DataVecDeriv> sofa_a = d_a;
     const auto nb_nodes = sofa_f.size();
-    Eigen::Map<const Eigen::Matrix<Real, Eigen::Dynamic, Dimension, Eigen::RowMajor>> f (sofa_f.ref().data()->data(),  nb_nodes, Dimension);
-    Eigen::Map<Eigen::Matrix<Real, Eigen::Dynamic, Dimension, Eigen::RowMajor>> a (&(sofa_a[0][0]),  nb_nodes, Dimension);
+    Eigen::Map<const Eigen::Matrix<Real, Eigen::Dynamic, 1>> f (sofa_f.ref().data()->data(),  nb_nodes*Dimension);
+    Eigen::Map<Eigen::Matrix<Real, Eigen::Dynamic, 1>> a (&(sofa_a[0][0]),  nb_nodes*Dimension);
 
     // a = M-1 f
     const bool lumped = d_lumped.getValue();
     if (lumped) {
-        for (unsigned int i = 0; i < nb_nodes; ++i) {
-            a.row(i) = f.row(i) / p_Mdiag.diagonal()[i*Dimension];
+        a = (f.array() / p_Mdiag.diagonal().array()).matrix();
+        return;
+    }
+
+    // In matrix-free mode, the consistent mass matrix is only assembled the first time it is needed
+    if (not p_M_is_assembled) {
+        update_mass_matrices(static_cast<Eigen::Index>(nb_nodes), true);
+    }
+
+    // The factorization of the consistent mass matrix is computed once and reused until the next assembly
+    if (p_M_needs_factorization or p_prepared_acceleration_solver != acceleration_solver()) {
+        factorize_mass_matrix();
+    }
+
+    sofa::helper::ScopedAdvancedTimer _t_ ("CaribouMass::accFromF");
+    if (p_prepared_acceleration_solver == AccelerationSolver::CONJUGATE_GRADIENT) {
+        p_M_cg.setTolerance(d_acceleration_tolerance.getValue());
+        a = p_M_cg.solve(f);
+        if (p_M_cg.info() != Eigen::Success) {
+            msg_warning() << "The acceleration's conjugate gradient did not converge after " << p_M_cg.iterations()
+                          << " iterations (relative residual of " << p_M_cg.error() << ").";
         }
     } else {
-        Eigen::SimplicialCholesky<decltype(p_M), Eigen::Upper> solver;
-        const Eigen::Matrix<Real, Eigen::Dynamic, Dimension, Eigen::RowMajor> r = solver.compute(p_M).solve(f);
-        a = r;
+        a = p_M_cholesky.solve(f);
     }
 }
 
@@ -488,18 +731,92 @@ void CaribouMass<Element>::addMDx(const sofa::core::MechanicalParams * /*mparams
                                   const CaribouMass::DataVecDeriv &d_dx, SReal factor) {
 
     // Map SOFA vectors to Eigen matrices
-    const sofa::helper::ReadAccessor<DataVecCoord> sofa_dx = d_dx;
+    const sofa::helper::ReadAccessor<DataVecDeriv> sofa_dx = d_dx;
     sofa::helper::WriteAccessor<DataVecDeriv> sofa_f = d_f;
     const auto nb_nodes = sofa_f.size();
     Eigen::Map<const Eigen::Matrix<Real, Eigen::Dynamic, 1>> dx (sofa_dx.ref().data()->data(),  nb_nodes*Dimension);
     Eigen::Map<Eigen::Matrix<Real, Eigen::Dynamic, 1>> f (&(sofa_f[0][0]),  nb_nodes*Dimension);
 
+    sofa::helper::ScopedAdvancedTimer _t_ ("CaribouMass::addMDx");
+
+    add_mass_product(dx, f, static_cast<Real>(factor));
+}
+
+template<typename Element>
+void CaribouMass<Element>::add_combined_MBKdx(const sofa::core::MechanicalParams * mparams_1,
+                                              const sofa::core::MechanicalParams * mparams_2,
+                                              sofa::core::MultiVecDerivId df_id) {
+    if (!this->mstate)
+        return;
+
+    // Only the mass terms are computed by this component (no damping or stiffness matrices)
+    const auto m1 = static_cast<Real> (mparams_1->mFactorIncludingRayleighDamping(this->rayleighMass.getValue()));
+    const auto m2 = static_cast<Real> (mparams_2->mFactorIncludingRayleighDamping(this->rayleighMass.getValue()));
+    if (m1 == 0 and m2 == 0) {
+        return;
+    }
+
+    const sofa::helper::ReadAccessor<DataVecDeriv> sofa_dx1 = *mparams_1->readDx(this->mstate.get());
+    const sofa::helper::ReadAccessor<DataVecDeriv> sofa_dx2 = *mparams_2->readDx(this->mstate.get());
+    sofa::helper::WriteAccessor<DataVecDeriv> sofa_df = *df_id[this->mstate.get()].write();
+    const auto nb_nodes = sofa_df.size();
+    Eigen::Map<const Eigen::Matrix<Real, Eigen::Dynamic, 1>> dx1 (sofa_dx1.ref().data()->data(),  nb_nodes*Dimension);
+    Eigen::Map<const Eigen::Matrix<Real, Eigen::Dynamic, 1>> dx2 (sofa_dx2.ref().data()->data(),  nb_nodes*Dimension);
+    Eigen::Map<Eigen::Matrix<Real, Eigen::Dynamic, 1>> f (&(sofa_df[0][0]),  nb_nodes*Dimension);
+
+    sofa::helper::ScopedAdvancedTimer _t_ ("CaribouMass::add_combined_MBKdx");
+
+    p_combined_dx.noalias() = m1*dx1 + m2*dx2;
+    add_mass_product(p_combined_dx, f, 1);
+}
+
+template<typename Element>
+void CaribouMass<Element>::add_mass_product(const Eigen::Ref<const Eigen::Matrix<Real, Eigen::Dynamic, 1>> & dx,
+                                            Eigen::Ref<Eigen::Matrix<Real, Eigen::Dynamic, 1>> f,
+                                            const Real & factor) {
     const bool lumped = d_lumped.getValue();
 
     if (lumped) {
-        f = (p_Mdiag.diagonal().array() * dx.array()).matrix() * factor;
+        f.noalias() += (p_Mdiag.diagonal().array() * dx.array()).matrix() * factor;
+    } else if (p_M_is_assembled) {
+        f.noalias() += p_M.template selfadjointView<Eigen::Upper>() * dx * factor;
     } else {
-        f = p_M * dx * factor;
+        // Matrix-free product. For each integration point, the increment is interpolated, scaled by the mass of the
+        // integration point and redistributed to the nodes.
+        const auto nb_nodes = f.size() / Dimension;
+        Eigen::Map<const Eigen::Matrix<Real, Eigen::Dynamic, Dimension, Eigen::RowMajor>> DX (dx.data(),  nb_nodes, Dimension);
+        Eigen::Map<Eigen::Matrix<Real, Eigen::Dynamic, Dimension, Eigen::RowMajor>> F (f.data(),  nb_nodes, Dimension);
+        const auto density = d_density.getValue();
+
+        [[maybe_unused]]
+        const auto enable_multithreading = d_enable_multithreading.getValue();
+
+        // The elements of a same color do not share any node, hence their contributions can be scattered concurrently
+        for (const auto & elements : p_element_colors) {
+#pragma omp parallel for if (enable_multithreading)
+            for (int e = 0; e < static_cast<int>(elements.size()); ++e) {
+                const auto & element_id = elements[static_cast<std::size_t>(e)];
+                const auto node_indices = this->topology()->domain()->element_indices(element_id);
+
+                // Increment of the element's nodes
+                Matrix<NumberOfNodesPerElement, Dimension> element_dx;
+                for (std::size_t i = 0; i < NumberOfNodesPerElement; ++i) {
+                    element_dx.row(i).noalias() = DX.row(node_indices[i]);
+                }
+
+                Matrix<NumberOfNodesPerElement, Dimension> element_f = Matrix<NumberOfNodesPerElement, Dimension>::Zero();
+                for (const auto & gauss_node : gauss_nodes_of(element_id)) {
+                    const auto & N = gauss_node.N;
+                    const Real m = density * gauss_node.weight * gauss_node.jacobian_determinant * factor;
+                    const Matrix<1, Dimension> u = N.transpose() * element_dx;
+                    element_f.noalias() += m * N * u;
+                }
+
+                for (std::size_t i = 0; i < NumberOfNodesPerElement; ++i) {
+                    F.row(node_indices[i]).noalias() += element_f.row(i);
+                }
+            }
+        }
     }
 }
 
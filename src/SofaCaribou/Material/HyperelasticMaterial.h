@@ -57,6 +57,18 @@ public:
     PK2_stress_jacobian(const Real & J, const Eigen::Matrix<Real, Dimension, Dimension>  & C) const = 0;
 
 
+    /**
+     * Get the P-wave modulus (lambda + 2mu for an isotropic material) at the undeformed state, computed directly from
+     * the parameters of the material. Contrary to the other methods, it doesn't require a previous call to
+     * before_update(). The speed of the dilatational wave inside the material is sqrt(P / rho).
+     *
+     * Return zero when the modulus is unknown for this material.
+     */
+    virtual Real
+    P_wave_modulus() const {
+        return Real(0);
+    }
+
     // Sofa's scene methods
 
     /** Return the data type (ex. Vec3D) as the template name  */
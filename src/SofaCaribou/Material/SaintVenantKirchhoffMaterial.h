@@ -75,6 +75,14 @@ public:
         return C;
     }
 
+    /** Get the P-wave modulus lambda + 2mu at the undeformed state from the Young's modulus and Poisson's ratio. */
+    Real
+    P_wave_modulus() const override {
+        const Real young_modulus = d_young_modulus.getValue();
+        const Real poisson_ratio = d_poisson_ratio.getValue();
+        return young_modulus * (1.0 - poisson_ratio) / ((1.0 + poisson_ratio) * (1.0 - 2.0 * poisson_ratio));
+    }
+
 private:
     // Private members
     Real mu; // Lame's mu parameter
@@ -1,6 +1,7 @@
 #include <SofaCaribou/Ode/BackwardEulerODESolver.h>
 
 #include <SofaCaribou/Visitor/AssembleGlobalMatrix.h>
+#include <SofaCaribou/Visitor/ComputeResidualForce.h>
 #include <SofaCaribou/Visitor/ConstrainGlobalMatrix.h>
 
 DISABLE_ALL_WARNINGS_BEGIN
@@ -8,6 +9,7 @@ DISABLE_ALL_WARNINGS_BEGIN
 #include <sofa/core/ObjectFactory.h>
 #include <sofa/core/behavior/ConstraintSolver.h>
 #include <sofa/helper/AdvancedTimer.h>
+#include <sofa/simulation/Node.h>
 #include <sofa/simulation/MechanicalVisitor.h>
 #include <sofa/simulation/VectorOperations.h>
 #if (defined(SOFA_VERSION) && SOFA_VERSION < 201299)
@@ -25,6 +27,9 @@ using namespace sofa::simulation::mechanicalvisitor;
 #endif
 DISABLE_ALL_WARNINGS_BEGIN
 
+#include <algorithm>
+#include <limits>
+
 namespace SofaCaribou::ode {
 
 int BackwardEulerClass = sofa::core::RegisterObject("Backward Euler ODE Solver").add< BackwardEulerODESolver >();
@@ -39,6 +44,16 @@ using sofa::defaulttype::BaseMatrix;
 using sofa::defaulttype::BaseVector;
 using Timer = sofa::helper::AdvancedTimer;
 
+namespace {
+// Set the time of a node and of all its descendants
+void set_time(Node * node, SReal time) {
+    node->setTime(time);
+    for (auto & child : node->child) {
+        set_time(child.get(), time);
+    }
+}
+}
+
 // Constructor
 BackwardEulerODESolver::BackwardEulerODESolver()
 : d_rayleigh_stiffness(initData(&d_rayleigh_stiffness,
@@ -49,11 +64,161 @@ BackwardEulerODESolver::BackwardEulerODESolver()
     (double) 0.0,
     "rayleigh_mass",
     "The mass factor 'r_m' used in the Rayleigh's damping matrix `D = r_m M + r_k K`."))
+, d_fused_residual(initData(&d_fused_residual,
+    true,
+    "fused_residual",
+    "Compute the forces and the damping and inertial terms of the residual in a single traversal of the scene graph. "
+    "The Caribou components (for example, the HyperelasticForcefield and the CaribouMass) then compute their "
+    "products with the velocity and the acceleration vectors in a single pass."))
+, d_adaptive_time_stepping(initData(&d_adaptive_time_stepping,
+    false,
+    "adaptive_time_stepping",
+    "Integrate the time step of the simulation with adaptive sub-steps. The sub-step is increased when the Newton "
+    "iterations converge rapidly, and reduced (and the sub-step tried again) when they do not converge."))
+, d_minimum_time_step(initData(&d_minimum_time_step,
+    (double) 1e-6,
+    "minimum_time_step",
+    "Adaptive time stepping: smallest sub-step allowed. A sub-step that does not converge with this size is accepted "
+    "anyway."))
+, d_maximum_time_step(initData(&d_maximum_time_step,
+    (double) 0,
+    "maximum_time_step",
+    "Adaptive time stepping: largest sub-step allowed. It cannot exceed the time step of the simulation, which is used "
+    "when this value is zero."))
+, d_growth_newton_iterations(initData(&d_growth_newton_iterations,
+    (unsigned int) 3,
+    "growth_newton_iterations",
+    "Adaptive time stepping: the sub-step is increased when the Newton iterations converge in this number of "
+    "iterations or less."))
+, d_growth_factor(initData(&d_growth_factor,
+    (double) 1.5,
+    "growth_factor",
+    "Adaptive time stepping: factor (larger than one) applied on the sub-step when it is increased."))
+, d_reduction_factor(initData(&d_reduction_factor,
+    (double) 0.5,
+    "reduction_factor",
+    "Adaptive time stepping: factor (smaller than one) applied on the sub-step when it is reduced."))
+, d_time_step(initData(&d_time_step,
+    (double) 0,
+    "time_step",
+    "Size of the last accepted (sub-)step.",
+    true /*is_displayed_in_gui*/,
+    true /*is_read_only*/))
+, d_number_of_accepted_steps(initData(&d_number_of_accepted_steps,
+    (unsigned int) 0,
+    "number_of_accepted_steps",
+    "Number of (sub-)steps accepted since the beginning of the simulation.",
+    true /*is_displayed_in_gui*/,
+    true /*is_read_only*/))
+, d_number_of_rejected_steps(initData(&d_number_of_rejected_steps,
+    (unsigned int) 0,
+    "number_of_rejected_steps",
+    "Number of (sub-)steps rejected because the Newton iterations did not converge, and tried again with a smaller "
+    "time step, since the beginning of the simulation.",
+    true /*is_displayed_in_gui*/,
+    true /*is_read_only*/))
 {}
 
+void BackwardEulerODESolver::init() {
+    NewtonRaphsonSolver::init();
+
+    if (d_adaptive_time_stepping.getValue()) {
+        if (maximum_number_of_newton_iterations() < 2) {
+            msg_warning() << "The adaptive time stepping relies on the convergence of the Newton iterations, which is "
+                          << "never reached with a single Newton iteration. Increase the number of Newton iterations.";
+        }
+        if (d_growth_factor.getValue() <= 1 or d_reduction_factor.getValue() <= 0 or d_reduction_factor.getValue() >= 1) {
+            msg_warning() << "The growth factor must be larger than one, and the reduction factor must be between zero "
+                          << "and one.";
+        }
+    }
+
+    reset();
+}
+
+void BackwardEulerODESolver::reset() {
+    NewtonRaphsonSolver::reset();
+    p_h = 0;
+    d_time_step.setValue(0);
+    d_number_of_accepted_steps.setValue(0);
+    d_number_of_rejected_steps.setValue(0);
+}
 
 void BackwardEulerODESolver::solve(const sofa::core::ExecParams *params, SReal dt, sofa::core::MultiVecCoordId x_id,
                                    sofa::core::MultiVecDerivId v_id) {
+    if (not d_adaptive_time_stepping.getValue()) {
+        integrate_step(params, dt, x_id, v_id);
+        d_time_step.setValue(dt);
+        d_number_of_accepted_steps.setValue(d_number_of_accepted_steps.getValue() + 1);
+        return;
+    }
+
+    Timer::stepBegin("BackwardEulerODESolver::AdaptiveTimeStepping");
+
+    // Bounds of the sub-step. The minimum is kept strictly positive to guarantee that the reductions terminate.
+    const SReal maximum_time_step = (d_maximum_time_step.getValue() > 0) ? std::min(static_cast<SReal>(d_maximum_time_step.getValue()), dt) : dt;
+    const SReal minimum_time_step = std::min(
+        std::max(static_cast<SReal>(d_minimum_time_step.getValue()), dt * std::numeric_limits<SReal>::epsilon()),
+        maximum_time_step
+    );
+    const auto growth_newton_iterations = d_growth_newton_iterations.getValue();
+    const auto growth_factor = std::max(d_growth_factor.getValue(), 1.);
+    const auto reduction_factor = std::clamp(d_reduction_factor.getValue(), 0.01, 0.99);
+
+    // The sub-step of the previous time step is reused
+    p_h = (p_h > 0) ? std::clamp(p_h, minimum_time_step, maximum_time_step) : maximum_time_step;
+
+    // The time of the context is moved to the beginning of every sub-step, hence the time-dependent loads and
+    // constraints are evaluated at the time of their sub-step, as they would be with a fixed time step of size h.
+    auto * node = dynamic_cast<Node *>(this->getContext());
+    const SReal start_time = this->getContext()->getTime();
+
+    auto number_of_accepted_steps = d_number_of_accepted_steps.getValue();
+    auto number_of_rejected_steps = d_number_of_rejected_steps.getValue();
+    SReal t = 0;
+    while (dt - t > dt * std::numeric_limits<SReal>::epsilon() * 10) {
+        // The last sub-step is shortened to end exactly at the end of the time step
+        const SReal h = std::min(p_h, dt - t);
+        if (node) {
+            set_time(node, start_time + t);
+        }
+        integrate_step(params, h, x_id, v_id);
+
+        if (not converged()) {
+            if (h > minimum_time_step) {
+                // Reject the step, restore the state at its beginning and try again with a smaller one
+                restore_step(params, x_id, v_id);
+                p_h = std::max(h * reduction_factor, minimum_time_step);
+                ++number_of_rejected_steps;
+                msg_info() << "Step of size " << h << " rejected, trying again with a step of size " << p_h << ".";
+                continue;
+            }
+
+            msg_warning() << "The Newton iterations did not converge with the minimum time step (" << h << "), the "
+                          << "step is accepted anyway.";
+        } else if (squared_residuals().size() <= growth_newton_iterations and h >= p_h) {
+            // Rapid convergence with a full sub-step, increase the next one
+            p_h = std::min(p_h * growth_factor, maximum_time_step);
+        }
+
+        d_time_step.setValue(h);
+        ++number_of_accepted_steps;
+        t += h;
+    }
+
+    // The animation loop advances the time of the context at the end of the time step
+    if (node) {
+        set_time(node, start_time);
+    }
+
+    d_number_of_accepted_steps.setValue(number_of_accepted_steps);
+    d_number_of_rejected_steps.setValue(number_of_rejected_steps);
+
+    Timer::stepEnd("BackwardEulerODESolver::AdaptiveTimeStepping");
+}
+
+void BackwardEulerODESolver::integrate_step(const sofa::core::ExecParams *params, SReal h,
+                                            sofa::core::MultiVecCoordId x_id, sofa::core::MultiVecDerivId v_id) {
     // Save up the current position and velocity multi vectors in order to reuse it during the time stepping part
     sofa::core::MechanicalParams mechanical_parameters (*params);
     sofa::simulation::common::VectorOperations vop( &mechanical_parameters, this->getContext() );
@@ -68,7 +233,20 @@ void BackwardEulerODESolver::solve(const sofa::core::ExecParams *params, SReal d
     vop.v_clear(p_a_id);
 
     // Let the NR do its job
-    NewtonRaphsonSolver::solve(params, dt, x_id, v_id);
+    NewtonRaphsonSolver::solve(params, h, x_id, v_id);
+}
+
+void BackwardEulerODESolver::restore_step(const sofa::core::ExecParams *params, sofa::core::MultiVecCoordId x_id,
+                                          sofa::core::MultiVecDerivId v_id) {
+    sofa::core::MechanicalParams mechanical_parameters (*params);
+    mechanical_parameters.setX(x_id);
+    mechanical_parameters.setV(v_id);
+    sofa::simulation::common::VectorOperations vop( &mechanical_parameters, this->getContext() );
+    vop.v_eq(x_id, p_previous_x_id); // x = x_0
+    vop.v_eq(v_id, p_previous_v_id); // v = v_0
+
+    // Propagate the restored positions and velocities to the mapped mechanical objects
+    MechanicalPropagateOnlyPositionAndVelocityVisitor(&mechanical_parameters).execute(this->getContext());
 }
 
 
@@ -85,6 +263,46 @@ void BackwardEulerODESolver::assemble_rhs_vector(const MechanicalParams &    mec
 
     const auto h = mechanical_parameters.dt();
 
+    if (d_fused_residual.getValue()) {
+        // 1. Set the factors of the damping terms  f_1 = [- r_m M  - C  +  r_k K] v
+        //    where K is in fact -K by SOFA's convention, hence the positive (+) sign.
+        auto v_params = mechanical_parameters;
+        v_params.setDx(p_previous_v_id);
+        v_params.setMFactor(-d_rayleigh_mass.getValue());
+        v_params.setKFactor(d_rayleigh_stiffness.getValue());
+        v_params.setBFactor(-1);
+
+        // 2. Set the factors of the inertial terms  f_2 = [-(1 + h r_m) M  - h C  +  h r_k K ] a
+        auto a_params = mechanical_parameters;
+        a_params.setDx(p_a_id);
+        a_params.setMFactor(-(1 + h*d_rayleigh_mass.getValue()));
+        a_params.setKFactor(h * d_rayleigh_stiffness.getValue());
+        a_params.setBFactor(-h);
+
+        // 3. Compute F := f_0 + f_1 + f_2 in a single traversal of the graph
+        visitor::ComputeResidualForce(&mechanical_parameters, f_id, &v_params, &a_params)
+        .execute(this->getContext());
+    } else {
+        assemble_rhs_vector_without_fusion(mechanical_parameters, f_id);
+    }
+
+    // 4. Calls the "projectResponse" method of every `BaseProjectiveConstraintSet` objects found in the current
+    //    context tree. For example, the `FixedConstraints` component will set entries of fixed nodes to zero.
+    MechanicalApplyConstraintsVisitor(&mechanical_parameters, f_id,
+                                      nullptr /* W (also project the given compliance matrix) */)
+    .execute(this->getContext());
+
+    // 5. Copy force vectors from every top level (unmapped) mechanical objects into the given system vector f
+    MechanicalMultiVectorToBaseVectorVisitor(&mechanical_parameters, f_id /* source */, f /* destination */, &matrix_accessor)
+    .execute(this->getContext());
+}
+
+// Same as assemble_rhs_vector, but with one graph traversal per term
+void BackwardEulerODESolver::assemble_rhs_vector_without_fusion(const MechanicalParams & mechanical_parameters,
+                                                                MultiVecDerivId & f_id)
+{
+    const auto h = mechanical_parameters.dt();
+
     // 1. Clear the force and dforce vectors (F := 0, dF := 0)
     MechanicalResetForceVisitor(&mechanical_parameters, f_id,
                                 false /* onlyMapped */)
@@ -142,17 +360,6 @@ void BackwardEulerODESolver::assemble_rhs_vector(const MechanicalParams &    mec
     MechanicalAddMBKdxVisitor(&m_params, f_id,
                               true /* Accumulate the contribution of mapped mo */ )
             .execute(this->getContext());
-
-
-    // 4. Calls the "projectResponse" method of every `BaseProjectiveConstraintSet` objects found in the current
-    //    context tree. For example, the `FixedConstraints` component will set entries of fixed nodes to zero.
-    MechanicalApplyConstraintsVisitor(&mechanical_parameters, f_id,
-                                      nullptr /* W (also project the given compliance matrix) */)
-    .execute(this->getContext());
-
-    // 5. Copy force vectors from every top level (unmapped) mechanical objects into the given system vector f
-    MechanicalMultiVectorToBaseVectorVisitor(&mechanical_parameters, f_id /* source */, f /* destination */, &matrix_accessor)
-    .execute(this->getContext());
 }
 
 // Assemble A in A [da] = F
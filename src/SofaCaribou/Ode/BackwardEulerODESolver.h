@@ -91,8 +91,12 @@ namespace SofaCaribou::ode {
  *     \mat{J} = \frac{\partial \vect{F}}{\partial \vect{a}_{n+1}} \bigg\rvert_{\vect{a}_{n+1}^i} &= (1 + hr_m)\mat{M} + h \mat{C} + h(h+r_k) \mat{K}(\vect{a}_{n+1}^i)
  * \f}
  *
- *
- *
+ * When the adaptive time stepping is enabled, the time step of the simulation is integrated with one or more sub-steps
+ * \f$h\f$ bounded by a minimum and a maximum value. The sub-step is increased when the Newton iterations converge in
+ * a few iterations, and reduced when they do not converge, in which case the positions and velocities at the beginning
+ * of the sub-step are restored and the sub-step is tried again with the reduced \f$h\f$. The current sub-step is kept
+ * from one time step to the other. The time of the context is moved to the beginning of every sub-step, hence
+ * time-dependent loads and constraints see the time of the sub-step being integrated.
  */
 class BackwardEulerODESolver : public NewtonRaphsonSolver {
 public:
@@ -104,10 +108,42 @@ public:
     CARIBOU_API
     BackwardEulerODESolver();
 
+    CARIBOU_API
+    void init() override;
+
+    CARIBOU_API
+    void reset() override;
+
     CARIBOU_API
     void solve (const sofa::core::ExecParams* params, SReal dt, sofa::core::MultiVecCoordId x_id, sofa::core::MultiVecDerivId v_id) override;
+
+    /** Get the sub-step used for the last accepted step (equal to the time step when the adaptive time stepping is disabled). */
+    auto time_step() const -> SReal { return d_time_step.getValue(); }
+
+    /** Get the number of steps accepted since the beginning of the simulation. */
+    auto number_of_accepted_steps() const -> unsigned int { return d_number_of_accepted_steps.getValue(); }
+
+    /** Get the number of steps rejected (and tried again with a smaller time step) since the beginning of the simulation. */
+    auto number_of_rejected_steps() const -> unsigned int { return d_number_of_rejected_steps.getValue(); }
 private:
 
+    /**
+     * Integrate a single step of size h from the current positions and velocities, which are saved at the beginning
+     * of the step in order to be restored if needed.
+     */
+    void integrate_step(const sofa::core::ExecParams* params, SReal h, sofa::core::MultiVecCoordId x_id, sofa::core::MultiVecDerivId v_id);
+
+    /** Restore the positions and velocities saved at the beginning of the last step, and propagate them to the mapped states. */
+    void restore_step(const sofa::core::ExecParams* params, sofa::core::MultiVecCoordId x_id, sofa::core::MultiVecDerivId v_id);
+
+    /**
+     * The unknown of the Newton iterations is the acceleration at the end of the step, which is a state value and not
+     * an increment over the step.
+     *
+     * @see NewtonRaphsonSolver::unknown_is_increment
+     */
+    auto unknown_is_increment() const -> bool final { return false; }
+
     /** @see NewtonRaphsonSolver::assemble_rhs_vector */
     CARIBOU_API
     void assemble_rhs_vector(const sofa::core::MechanicalParams & mechanical_parameters,
@@ -115,6 +151,13 @@ private:
                              sofa::core::MultiVecDerivId & f_id,
                              sofa::defaulttype::BaseVector * f) final;
 
+    /**
+     * Compute the forces, damping and inertial terms of the right-hand side with one traversal of the scene graph per
+     * term. This is the path used when the fused residual is disabled.
+     */
+    void assemble_rhs_vector_without_fusion(const sofa::core::MechanicalParams & mechanical_parameters,
+                                            sofa::core::MultiVecDerivId & f_id);
+
     /** @see NewtonRaphsonSolver::assemble_system_matrix */
     CARIBOU_API
     void assemble_system_matrix(const sofa::core::MechanicalParams & mechanical_parameters,
@@ -133,6 +176,18 @@ private:
     /// INPUTS
     Data<double> d_rayleigh_stiffness;
     Data<double> d_rayleigh_mass;
+    Data<bool> d_fused_residual;
+    Data<bool> d_adaptive_time_stepping;
+    Data<double> d_minimum_time_step;
+    Data<double> d_maximum_time_step;
+    Data<unsigned int> d_growth_newton_iterations;
+    Data<double> d_growth_factor;
+    Data<double> d_reduction_factor;
+
+    /// OUTPUTS
+    Data<double> d_time_step;
+    Data<unsigned int> d_number_of_accepted_steps;
+    Data<unsigned int> d_number_of_rejected_steps;
 
     /// Private members
 
@@ -144,6 +199,9 @@ private:
 
     /// Multi-vector identifier of the acceleration at the current newton iteration
     sofa::core::MultiVecDerivId p_a_id;
+
+    /// Current sub-step of the adaptive time stepping (zero until the first time step)
+    SReal p_h = 0;
 };
 
 } // namespace SofaCaribou::ode
@@ -0,0 +1,228 @@
+#include <SofaCaribou/Ode/CentralDifferenceODESolver.h>
+#include <SofaCaribou/Ode/CriticalTimeStepProvider.h>
+#include <SofaCaribou/Ode/StableTimeStepEstimator.h>
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/core/ObjectFactory.h>
+#include <sofa/core/behavior/BaseMass.h>
+#include <sofa/core/behavior/BaseMechanicalState.h>
+#include <sofa/core/behavior/ConstraintSolver.h>
+#include <sofa/core/behavior/MultiVec.h>
+#include <sofa/helper/AdvancedTimer.h>
+#include <sofa/simulation/MechanicalOperations.h>
+#include <sofa/simulation/VectorOperations.h>
+DISABLE_ALL_WARNINGS_END
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace SofaCaribou::ode {
+
+int CentralDifferenceClass = sofa::core::RegisterObject("Explicit central difference ODE Solver").add< CentralDifferenceODESolver >();
+
+using sofa::core::MultiVecCoordId;
+using sofa::core::MultiVecDerivId;
+using sofa::core::objectmodel::BaseContext;
+using sofa::core::objectmodel::BaseObject;
+
+CentralDifferenceODESolver::CentralDifferenceODESolver()
+: d_automatic_critical_time_step(initData(&d_automatic_critical_time_step,
+    true,
+    "automatic_critical_time_step",
+    "Estimate the critical time step of the mechanical system from the size and the material of the elements of the "
+    "components found in the current context (for example, the HyperelasticForcefield)."))
+, d_safety_factor(initData(&d_safety_factor,
+    (double) 0.9,
+    "safety_factor",
+    "Factor (usually smaller than one) applied on the estimated critical time step."))
+, d_sub_cycling(initData(&d_sub_cycling,
+    false,
+    "sub_cycling",
+    "When the time step of the simulation is larger than the critical time step, divide it into the smallest number "
+    "of equal sub-steps that are smaller than the critical time step. If disabled, a warning is printed instead."))
+, d_critical_time_step_update_interval(initData(&d_critical_time_step_update_interval,
+    (unsigned int) 0,
+    "critical_time_step_update_interval",
+    "Number of time steps between two estimations of the critical time step. The element sizes decrease with "
+    "compression, which decreases the critical time step. Use 0 to estimate it only at the first time step."))
+, d_critical_time_step(initData(&d_critical_time_step,
+    (double) 0,
+    "critical_time_step",
+    "Critical time step (scaled by the safety factor) used during the last time step. Zero if it could not be "
+    "estimated.",
+    true /*is_displayed_in_gui*/,
+    true /*is_read_only*/))
+, d_number_of_sub_steps(initData(&d_number_of_sub_steps,
+    (unsigned int) 1,
+    "number_of_sub_steps",
+    "Number of sub-steps done during the last time step.",
+    true /*is_displayed_in_gui*/,
+    true /*is_read_only*/))
+{}
+
+void CentralDifferenceODESolver::init() {
+    // The acceleration is computed from the masses without any linear solver, it is only efficient for diagonal masses
+    const auto masses = this->getContext()->getObjects<sofa::core::behavior::BaseMass>(BaseContext::SearchDown);
+    for (auto * mass : masses) {
+        if (not mass->isDiagonal()) {
+            msg_warning() << "The mass '" << mass->getPathName() << "' is not diagonal (lumped). The computation of the "
+                          << "acceleration will require the resolution of a linear system at every time step.";
+        }
+    }
+
+    reset();
+}
+
+void CentralDifferenceODESolver::reset() {
+    p_dt = 0;
+    p_number_of_steps_since_estimation = 0;
+    p_critical_time_step_is_estimated = false;
+    p_unstable_time_step_was_reported = false;
+    p_unknown_critical_time_step_was_reported = false;
+}
+
+auto CentralDifferenceODESolver::estimate_critical_time_step() const -> SReal {
+    auto critical_time_step = std::numeric_limits<SReal>::max();
+    bool found = false;
+    const auto objects = this->getContext()->getObjects<BaseObject>(BaseContext::SearchDown);
+    for (const auto * object : objects) {
+        const auto * provider = dynamic_cast<const CriticalTimeStepProvider *>(object);
+        if (not provider) {
+            continue;
+        }
+
+        const auto elements_critical_time_step = provider->elements_critical_time_step();
+        if (elements_critical_time_step.empty()) {
+            msg_warning() << "Unable to estimate the critical time step of the component '" << object->getPathName()
+                          << "'.";
+            continue;
+        }
+
+        const auto minimum = *std::min_element(elements_critical_time_step.begin(), elements_critical_time_step.end());
+        critical_time_step = std::min(critical_time_step, static_cast<SReal>(minimum));
+        found = true;
+    }
+
+    return found ? critical_time_step : 0;
+}
+
+void CentralDifferenceODESolver::solve(const sofa::core::ExecParams *params, SReal dt, MultiVecCoordId x_id,
+                                       MultiVecDerivId v_id) {
+    using namespace sofa::core::behavior;
+    sofa::helper::ScopedAdvancedTimer _t_ ("CentralDifferenceODESolver::solve");
+
+    sofa::simulation::common::VectorOperations vop(params, this->getContext());
+    sofa::simulation::common::MechanicalOperations mop(params, this->getContext());
+    mop->setImplicit(false); // this solver is explicit only
+
+    MultiVecCoord x(&vop, x_id);
+    MultiVecDeriv v(&vop, v_id);
+    MultiVecDeriv a(&vop);
+
+    // 1. Estimate the critical time step
+    auto * estimator = this->getContext()->get<StableTimeStepEstimator>(BaseContext::SearchDown);
+    if (d_automatic_critical_time_step.getValue() and estimator) {
+        // The eigenvalue estimator updates its critical time step at the beginning of the time steps
+        d_critical_time_step.setValue(d_safety_factor.getValue() * estimator->critical_time_step());
+    } else if (d_automatic_critical_time_step.getValue()) {
+        const auto update_interval = d_critical_time_step_update_interval.getValue();
+        if (not p_critical_time_step_is_estimated or
+            (update_interval > 0 and p_number_of_steps_since_estimation >= update_interval)) {
+            sofa::helper::ScopedAdvancedTimer _t_estimation_ ("CentralDifferenceODESolver::estimate_critical_time_step");
+            d_critical_time_step.setValue(d_safety_factor.getValue() * estimate_critical_time_step());
+            p_critical_time_step_is_estimated = true;
+            p_number_of_steps_since_estimation = 0;
+            msg_info() << "Critical time step estimated to " << d_critical_time_step.getValue();
+        }
+        ++p_number_of_steps_since_estimation;
+    }
+
+    // 2. Divide the time step into stable sub-steps
+    const auto critical_time_step = static_cast<SReal>(d_critical_time_step.getValue());
+    if (d_automatic_critical_time_step.getValue() and critical_time_step <= 0) {
+        if (not p_unknown_critical_time_step_was_reported) {
+            msg_warning() << "The critical time step could not be estimated (is there any force field?). The time "
+                          << "step is neither sub-cycled nor checked against the stability limit.";
+            p_unknown_critical_time_step_was_reported = true;
+        }
+    } else {
+        p_unknown_critical_time_step_was_reported = false;
+    }
+    unsigned int number_of_sub_steps = 1;
+    if (critical_time_step > 0 and dt > critical_time_step) {
+        if (d_sub_cycling.getValue()) {
+            number_of_sub_steps = static_cast<unsigned int>(std::ceil(dt / critical_time_step));
+        } else if (not p_unstable_time_step_was_reported) {
+            msg_warning() << "The time step (" << dt << ") is larger than the critical time step ("
+                          << critical_time_step << "), the simulation will likely be unstable. Reduce the time "
+                          << "step or enable the sub-cycling.";
+            p_unstable_time_step_was_reported = true;
+        }
+    }
+    d_number_of_sub_steps.setValue(number_of_sub_steps);
+
+    const SReal h = dt / number_of_sub_steps;
+    p_dt = h;
+
+    auto constraint_parameters = sofa::core::ConstraintParams(*params);
+    auto constraint_solvers = this->getContext()->getObjects<ConstraintSolver>(BaseContext::Local);
+
+    for (unsigned int step = 0; step < number_of_sub_steps; ++step) {
+        const SReal t = this->getContext()->getTime() + step*h;
+
+        // 3. a_n = M^-1 [P_n - R(x_n)]
+        //    This propagates x and v to the mapped states, computes the forces (addForce), the acceleration
+        //    (accFromF) and projects it onto the projective constraints.
+        mop.computeAcc(t, a, x, v);
+
+        // 4. v_{n+1/2} = v_{n-1/2} + h a_n  and  x_{n+1} = x_n + h v_{n+1/2} in a single pass over the vectors
+        BaseMechanicalState::VMultiOp ops;
+        ops.resize(2);
+        ops[0].first = v;
+        ops[0].second.emplace_back(v.id(), 1.0);
+        ops[0].second.emplace_back(a.id(), h);
+        ops[1].first = x;
+        ops[1].second.emplace_back(x.id(), 1.0);
+        ops[1].second.emplace_back(v.id(), h);
+        vop.v_multiop(ops);
+
+        // 5. Solve velocity and position constraints
+        constraint_parameters.setOrder(sofa::core::ConstraintParams::VEL);
+        for (auto * solver : constraint_solvers) {
+            solver->solveConstraint(&constraint_parameters, v_id);
+        }
+        constraint_parameters.setOrder(sofa::core::ConstraintParams::POS);
+        for (auto * solver : constraint_solvers) {
+            solver->solveConstraint(&constraint_parameters, x_id);
+        }
+    }
+}
+
+SReal CentralDifferenceODESolver::getIntegrationFactor(int inputDerivative, int outputDerivative) const {
+    const SReal dt = (p_dt > 0) ? p_dt : this->getContext()->getDt();
+    const SReal matrix[3][3] = {
+        { 1, dt, 0},
+        { 0,  1, 0},
+        { 0,  0, 0}
+    };
+
+    if (inputDerivative >= 3 || outputDerivative >= 3) {
+        return 0;
+    }
+
+    return matrix[outputDerivative][inputDerivative];
+}
+
+SReal CentralDifferenceODESolver::getSolutionIntegrationFactor(int outputDerivative) const {
+    const SReal dt = (p_dt > 0) ? p_dt : this->getContext()->getDt();
+    const SReal vect[3] = { dt*dt, dt, 1};
+
+    if (outputDerivative >= 3) {
+        return 0;
+    }
+
+    return vect[outputDerivative];
+}
+
+} // namespace SofaCaribou::ode
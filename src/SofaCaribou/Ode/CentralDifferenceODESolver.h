@@ -0,0 +1,117 @@
+#pragma once
+
+#include <SofaCaribou/config.h>
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/core/behavior/OdeSolver.h>
+#include <sofa/core/objectmodel/Data.h>
+DISABLE_ALL_WARNINGS_END
+
+namespace SofaCaribou::ode {
+
+/**
+ * Implementation of an explicit central difference (leapfrog) ODE solver.
+ *
+ * We are trying to solve to following
+ * \f{eqnarray*}{
+ *     \mat{M} \ddot{\vect{x}} + \vect{R}(\vect{x}) = \vect{P}
+ * \f}
+ *
+ * Where \f$\mat{M}\f$ is the mass matrix, \f$\vect{R}\f$ is the (possibly non-linear) internal elastic force residual
+ * and \f$\vect{P}\f$ is the external force vector (for example, gravitation force or surface traction).
+ *
+ * Using the <a href="https://en.wikipedia.org/wiki/Leapfrog_integration">central difference scheme</a>, where the
+ * velocities are evaluated at the middle of the time steps, we have
+ *
+ * \f{align*}{
+ *     \vect{a}_{n} &= \mat{M}^{-1} \left[ \vect{P}_n - \vect{R}(\vect{x}_{n}) \right] \\
+ *     \vect{v}_{n+\frac{1}{2}} &= \vect{v}_{n-\frac{1}{2}} + h \vect{a}_{n} \\
+ *     \vect{x}_{n+1} &= \vect{x}_{n} + h \vect{v}_{n+\frac{1}{2}}
+ * \f}
+ *
+ * where \f$h\f$ is the delta time between the steps \f$n\f$ and \f$n+1\f$. No system matrix is assembled: the
+ * acceleration is directly computed by the masses (accFromF), which is an inversion of a diagonal matrix when
+ * lumped masses (for example, a CaribouMass with lumped="true") are used.
+ *
+ * The scheme is only conditionally stable. The critical time step is estimated from every components of the context
+ * implementing the CriticalTimeStepProvider interface (for example, the HyperelasticForcefield) as the smallest critical
+ * time step of their elements. When a StableTimeStepEstimator is found in the context, the critical time step it
+ * computed from the largest eigenvalue of M^-1 K is used instead. When the time step of the simulation is larger than
+ * the critical time step, it can be sub-cycled, ie divided into a number of smaller stable steps.
+ */
+class CentralDifferenceODESolver : public sofa::core::behavior::OdeSolver {
+public:
+    SOFA_CLASS(CentralDifferenceODESolver, sofa::core::behavior::OdeSolver);
+
+    template <typename T>
+    using Data = sofa::core::objectmodel::Data<T>;
+
+    CARIBOU_API
+    CentralDifferenceODESolver();
+
+    CARIBOU_API
+    void init() override;
+
+    CARIBOU_API
+    void reset() override;
+
+    CARIBOU_API
+    void solve (const sofa::core::ExecParams* params, SReal dt, sofa::core::MultiVecCoordId x_id, sofa::core::MultiVecDerivId v_id) override;
+
+    /**
+     * Estimate the critical time step of the mechanical system as the smallest critical time step of the elements of
+     * every CriticalTimeStepProvider components found in the current context and its children. The safety factor is
+     * not applied.
+     *
+     * @return The critical time step, or zero if no component was able to estimate it.
+     */
+    CARIBOU_API
+    auto estimate_critical_time_step() const -> SReal;
+
+    /** Get the critical time step (scaled by the safety factor) used during the last time step. */
+    auto critical_time_step() const -> SReal { return d_critical_time_step.getValue(); }
+
+    /** Get the number of sub-steps done during the last time step. */
+    auto number_of_sub_steps() const -> unsigned int { return d_number_of_sub_steps.getValue(); }
+
+    // The following two methods are used by SOFA to compute the integration of the mechanical states and must return
+    // the coefficients of the central difference scheme
+
+    /** Coefficient of the x (order 0) or v (order 1) terms in the new position (order 0) or velocity (order 1). */
+    CARIBOU_API
+    SReal getIntegrationFactor(int inputDerivative, int outputDerivative) const override;
+
+    /** Coefficient of the acceleration term in the new position (order 0) or velocity (order 1). */
+    CARIBOU_API
+    SReal getSolutionIntegrationFactor(int outputDerivative) const override;
+
+private:
+    /// INPUTS
+    Data<bool> d_automatic_critical_time_step;
+    Data<double> d_safety_factor;
+    Data<bool> d_sub_cycling;
+    Data<unsigned int> d_critical_time_step_update_interval;
+
+    /// OUTPUTS
+    Data<double> d_critical_time_step;
+    Data<unsigned int> d_number_of_sub_steps;
+
+    /// Private members
+
+    /// Time step used during the last call to solve (used by getIntegrationFactor)
+    SReal p_dt = 0;
+
+    /// Number of time steps since the last estimation of the critical time step
+    unsigned int p_number_of_steps_since_estimation = 0;
+
+    /// Whether or not the critical time step was estimated at least once
+    bool p_critical_time_step_is_estimated = false;
+
+    /// Whether or not the user was already warned that the time step exceeds the critical time step
+    bool p_unstable_time_step_was_reported = false;
+
+    /// Whether or not the user was already warned that the critical time step could not be estimated
+    bool p_unknown_critical_time_step_was_reported = false;
+};
+
+} // namespace SofaCaribou::ode
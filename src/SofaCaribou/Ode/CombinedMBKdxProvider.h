@@ -0,0 +1,45 @@
+#pragma once
+
+#include <SofaCaribou/config.h>
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/core/MechanicalParams.h>
+#include <sofa/core/MultiVecId.h>
+DISABLE_ALL_WARNINGS_END
+
+namespace SofaCaribou::ode {
+
+/**
+ * Interface of the components able to accumulate, in a single pass over their elements, the product of their mass,
+ * damping and stiffness matrices with two different vectors
+ *
+ * \f{eqnarray*}{
+ *     \vect{df} \mathrel{+}= \left[ m_1 \mat{M} + b_1 \mat{B} + k_1 \mat{K} \right] \vect{dx}_1
+ *                          + \left[ m_2 \mat{M} + b_2 \mat{B} + k_2 \mat{K} \right] \vect{dx}_2
+ * \f}
+ *
+ * where the factors and the vectors \f$\vect{dx}_1\f$ and \f$\vect{dx}_2\f$ are taken from two sets of mechanical
+ * parameters (mFactor, bFactor, kFactor and dx). Since the matrices are linear operators, this amounts to a single
+ * product of each matrix with a linear combination of the two vectors, for example
+ * \f$\mat{K} \left[ k_1 \vect{dx}_1 + k_2 \vect{dx}_2 \right]\f$.
+ *
+ * Implicit ODE solvers (see BackwardEulerODESolver) use it to compute their residual in a single traversal of the
+ * scene graph. Components that do not implement this interface get two calls to their addMBKdx method instead.
+ */
+class CombinedMBKdxProvider {
+public:
+    virtual ~CombinedMBKdxProvider() = default;
+
+    /**
+     * Accumulate df += (m1 M + b1 B + k1 K) dx1 + (m2 M + b2 B + k2 K) dx2 into the vector df_id.
+     *
+     * @param mparams_1 Mechanical parameters holding the factors m1, b1, k1 and the identifier of the vector dx1.
+     * @param mparams_2 Mechanical parameters holding the factors m2, b2, k2 and the identifier of the vector dx2.
+     * @param df_id The identifier of the vector into which the result is accumulated.
+     */
+    virtual void add_combined_MBKdx(const sofa::core::MechanicalParams * mparams_1,
+                                    const sofa::core::MechanicalParams * mparams_2,
+                                    sofa::core::MultiVecDerivId df_id) = 0;
+};
+
+} // namespace SofaCaribou::ode
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <SofaCaribou/config.h>
+
+#include <vector>
+
+namespace SofaCaribou::ode {
+
+/**
+ * Interface of the components able to estimate the critical (largest stable) time step of an explicit time integration
+ * scheme on their elements.
+ *
+ * For a central difference scheme, the critical time step of an element e is bounded by
+ *
+ * \f{eqnarray*}{
+ *     \Delta t_e = \frac{L_e}{c_e} ~\text{, }~ c_e = \sqrt{\frac{\lambda + 2\mu}{\rho_0}}
+ * \f}
+ *
+ * where \f$L_e\f$ is the characteristic length of the element and \f$c_e\f$ is the speed of the dilatational wave
+ * inside the material of the element.
+ *
+ * Explicit ODE solvers (see CentralDifferenceODESolver) will look for every components of their context implementing
+ * this interface in order to estimate the critical time step of the complete mechanical system.
+ */
+class CriticalTimeStepProvider {
+public:
+    virtual ~CriticalTimeStepProvider() = default;
+
+    /**
+     * Get the critical time step of each element. An empty vector is returned if the critical time steps cannot be
+     * computed (for example, when the material or the density of the elements is unknown).
+     */
+    virtual auto elements_critical_time_step() const -> std::vector<FLOATING_POINT_TYPE> = 0;
+};
+
+} // namespace SofaCaribou::ode
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <SofaCaribou/config.h>
+
+#include <Eigen/Core>
+
+#include <string>
+
+namespace SofaCaribou::ode {
+
+/**
+ * Interface of the components able to integrate their forces over a sparse weighted subset of their elements, selected
+ * offline by an energy-conserving sampling and weighting (ECSW) training.
+ *
+ * Given a reduced basis \f$\mat{\Phi}\f$ and a set of training displacements \f$\vect{u}_s\f$, the weights
+ * \f$\xi_e \geq 0\f$ of the elements are the sparse solution of the non-negative least squares problem
+ *
+ * \f{eqnarray*}{
+ *     \sum_{e} \xi_e \mat{\Phi}^T \vect{f}_e(\vect{u}_s) \approx \sum_{e} \mat{\Phi}^T \vect{f}_e(\vect{u}_s) \quad \forall s
+ * \f}
+ *
+ * where \f$\vect{f}_e\f$ is the internal force vector of the element \f$e\f$. Once trained, the forces and their
+ * derivatives only need to be evaluated on the elements having a non-zero weight. Note that the ReducedStaticODESolver
+ * still assembles the full order system matrix and residual vector before projecting them onto the basis, hence only
+ * the cost of the element integration is reduced, and the cost of a reduced step still grows with the size of the mesh.
+ *
+ * The hyper reduced forces are only valid in the reduced space. Reduced solvers (see ReducedStaticODESolver) hence
+ * deactivate the hyper reduction when they need to evaluate or solve the full order equations.
+ */
+class HyperReducible {
+public:
+    virtual ~HyperReducible() = default;
+
+    /** Whether or not the forces are currently integrated over the weighted subset of elements only. */
+    virtual bool hyper_reduction_is_active() const = 0;
+
+    /** Activate or deactivate the hyper reduction. It cannot be activated if no weights were trained or loaded. */
+    virtual void set_hyper_reduction_active(bool active) = 0;
+
+    /**
+     * Select the weighted subset of elements from training snapshots, and activate the hyper reduction.
+     *
+     * @param snapshots The n x m displacements (one snapshot per column) in the layout of the mechanical state.
+     * @param basis The n x r reduced basis (one vector per column) in the layout of the mechanical state.
+     * @param tolerance Relative error allowed on the reduced forces of the training snapshots.
+     * @return False if the training could not be done (for example, if the sizes do not match).
+     */
+    virtual bool train_hyper_reduction(const Eigen::MatrixXd & snapshots, const Eigen::MatrixXd & basis, double tolerance) = 0;
+
+    /**
+     * Write the trained elements and their weights into a text file (one "element_index weight" pair per line).
+     * @return False if the file could not be written.
+     */
+    virtual bool write_hyper_reduction_weights(const std::string & filename) const = 0;
+};
+
+} // namespace SofaCaribou::ode
@@ -1,5 +1,6 @@
 #include <SofaCaribou/Ode/NewtonRaphsonSolver.h>
 
+#include <algorithm>
 #include <iomanip>
 #include <chrono>
 
@@ -52,6 +53,16 @@ NewtonRaphsonSolver::NewtonRaphsonSolver()
     "be avoided altogether, or computed only one time at the beginning of the simulation. Else, it can be done at the "
     "beginning of the time step, or even at each reformation of the system matrix if necessary. The default is to "
     "analyze the pattern at each time step."))
+, d_predictor(initData(&d_predictor,
+    "predictor",
+    "Prediction of the solution increment used as the starting point of the Newton iterations of each step, "
+    "extrapolated from the increments of the previous (converged) steps. NONE starts from the solution of the previous "
+    "step. LINEAR and QUADRATIC extrapolate the rates (increment over time step) of the last two and three steps, "
+    "respectively, and multiply them by the new time step. SECANT "
+    "reuses the increment of the last step scaled by the ratio of the time steps. When the unknown of the solver is a "
+    "state value instead of an increment (for example, the acceleration of an implicit dynamic solver), the values of "
+    "the previous steps are extrapolated directly. For smooth loading histories, this reduces the number of Newton "
+    "iterations."))
 , l_linear_solver(initLink(
     "linear_solver",
     "Linear solver used for the resolution of the system."))
@@ -61,13 +72,25 @@ NewtonRaphsonSolver::NewtonRaphsonSolver()
     "Whether or not the last call to solve converged",
     true /*is_displayed_in_gui*/,
     true /*is_read_only*/))
+, d_newton_iterations_saved(initData(&d_newton_iterations_saved,
+    (double) 0,
+    "newton_iterations_saved",
+    "Estimated number of Newton iterations saved by the predictor since the beginning of the simulation. It is "
+    "computed from the average number of iterations of the steps that were started without prediction.",
+    true /*is_displayed_in_gui*/,
+    true /*is_read_only*/))
 {
     d_pattern_analysis_strategy.setValue(sofa::helper::OptionsGroup(std::vector < std::string > {
         "NEVER", "BEGINNING_OF_THE_SIMULATION", "BEGINNING_OF_THE_TIME_STEP", "ALWAYS"
     }));
 
-    // Select the default value
+    d_predictor.setValue(sofa::helper::OptionsGroup(std::vector < std::string > {
+        "NONE", "LINEAR", "QUADRATIC", "SECANT"
+    }));
+
+    // Select the default values
     set_pattern_analysis_strategy(PatternAnalysisStrategy::BEGINNING_OF_THE_TIME_STEP);
+    set_predictor(Predictor::NONE);
 }
 
 void NewtonRaphsonSolver::solve(const ExecParams *params, SReal dt, MultiVecCoordId x_id, MultiVecDerivId v_id) {
@@ -137,10 +160,6 @@ void NewtonRaphsonSolver::solve(const ExecParams *params, SReal dt, MultiVecCoor
     vop.v_realloc(dx_id, false /* interactionForceField */, false /* propagate [to mapped MO] */);
     vop.v_clear(dx_id);
 
-    // Total displacement increment since the beginning
-    vop.v_realloc(p_U_id, false /* interactionForceField */, false /* propagate [to mapped MO] */);
-    vop.v_clear(p_U_id);
-
     // Set implicit param to true to trigger nonlinear stiffness matrix recomputation
     mop->setImplicit(true);
 
@@ -187,32 +206,60 @@ void NewtonRaphsonSolver::solve(const ExecParams *params, SReal dt, MultiVecCoor
     // accumulate the mechanical objects and mappings. This one will not really
     // compute the mechanical graph (not explicitly at least). Hence the following
     // @todo (jnbrunet2000@gmail.com) Create a CaribouMultiMatrixAccessor for that.
-    sofa::component::linearsolver::DefaultMultiMatrixAccessor accessor;
-
-    // Step 1   Get dimension of each top level mechanical states using
-    //          BaseMechanicalState::getMatrixSize(), and accumulate mechanical
-    //          objects and mapping matrices
-    mop.getMatrixDimension(nullptr, nullptr, &accessor);
-    const auto n = static_cast<sofa::Size>(accessor.getGlobalDimension());
-
-    // Step 2   Does nothing more than to accumulate from the previous step a list of
-    //          "MatrixRef = <MechanicalState*, MatrixIndex>" where MatrixIndex is the
-    //          (i,i) position of the given top level MechanicalState* inside the global
-    //          system matrix. This global matrix hence contains one sub-matrix per top
-    //          level mechanical state.
-    accessor.setupMatrices();
+    //
+    // The accessor is rebuilt at the beginning of the step, and before every assembly of the system matrix. The system
+    // matrix and vectors are kept from one time step to the other. They are only rebuilt when the size of a mechanical
+    // state or the revision of a topology changed (for example, following a topological change), or when another
+    // linear solver is used.
+    build_matrix_accessor(mechanical_parameters, p_accessor);
+    bool accessor_is_up_to_date = true;
+    if (not p_mechanical_graph_signature.is_up_to_date() or p_system_owner != linear_solver) {
+        sofa::helper::ScopedAdvancedTimer _t_("SetupSystem");
+        const auto n = static_cast<sofa::Size>(p_accessor.getGlobalDimension());
+
+        // Let the linear solver create the system matrix and vector buffers using the system size n
+        p_A.reset(linear_solver->create_new_matrix(n, n));
+        p_DX.reset(linear_solver->create_new_vector(n));
+        p_F.reset(linear_solver->create_new_vector(n));
+        p_U.reset(linear_solver->create_new_vector(n));
+
+        p_mechanical_graph_signature.capture(context);
+        p_system_owner = linear_solver;
+
+        // The newly created system matrix has never been analyzed
+        p_has_already_analyzed_the_pattern = false;
+
+        // The increments of the previous steps do not match the new system
+        p_previous_increments.clear();
+        p_previous_dt.clear();
+    }
+    auto & accessor = p_accessor;
 
-    // Step 3   Let the linear solver create the system matrix and vector buffers
-    //          using the previously computed system size n
-    p_A.reset(linear_solver->create_new_matrix(n, n));
     p_A->clear();
-
-    p_DX.reset(linear_solver->create_new_vector(n));
     p_DX->clear();
-
-    p_F.reset(linear_solver->create_new_vector(n));
     p_F->clear();
 
+    // Total displacement increment since the beginning
+    p_U->clear();
+
+    // ###########################################################################
+    // #                          Solution predictor                             #
+    // ###########################################################################
+    // # Start the Newton iterations from the solution increment extrapolated    #
+    // # from the increments of the previous steps.                              #
+    // ###########################################################################
+    const bool predicted = predict_solution_increment(dt, p_DX.get());
+    if (predicted) {
+        sofa::helper::ScopedAdvancedTimer _t_("Predictor");
+        this->propagate_solution_increment(mechanical_parameters, accessor, p_DX.get(), x_id, v_id, dx_id);
+        SofaCaribou::Algebra::axpy(1., p_DX.get(), p_U.get()); // U = predicted increment
+        p_DX->clear();
+        vop.v_clear(dx_id);
+
+        if (print_log) {
+            info << "Solution increment predicted from the " << p_previous_increments.size() << " previous steps.\n";
+        }
+    }
 
     // ###########################################################################
     // #                             First residual                              #
@@ -252,6 +299,11 @@ void NewtonRaphsonSolver::solve(const ExecParams *params, SReal dt, MultiVecCoor
         // Part 1. Assemble the system matrix.
         {
             sofa::helper::ScopedAdvancedTimer _t_("MBKBuild");
+            if (not accessor_is_up_to_date) {
+                build_matrix_accessor(mechanical_parameters, accessor);
+            }
+            accessor_is_up_to_date = false;
+
             p_A->clear();
             this->assemble_system_matrix(mechanical_parameters, accessor, p_A.get());
             linear_solver->set_system_matrix(p_A.get());
@@ -324,12 +376,9 @@ void NewtonRaphsonSolver::solve(const ExecParams *params, SReal dt, MultiVecCoor
 
         // Part 8. Compute the updated displacement residual.
         sofa::helper::AdvancedTimer::stepBegin("UpdateU");
-        vop.v_peq(p_U_id, dx_id); // U += dx
-        vop.v_dot(dx_id, dx_id);  // dx.dot(dx)
-        dx_squared_norm = vop.finish();
-
-        vop.v_dot(p_U_id, p_U_id); // U.dot(U)
-        du_squared_norm = vop.finish();
+        SofaCaribou::Algebra::axpy(1., p_DX.get(), p_U.get()); // U += dx
+        dx_squared_norm = SofaCaribou::Algebra::dot(p_DX.get(), p_DX.get()); // dx.dot(dx)
+        du_squared_norm = SofaCaribou::Algebra::dot(p_U.get(), p_U.get()); // U.dot(U)
         sofa::helper::AdvancedTimer::stepEnd("UpdateU");
 
         // Part 9. Stop timers and print step information.
@@ -412,12 +461,35 @@ void NewtonRaphsonSolver::solve(const ExecParams *params, SReal dt, MultiVecCoor
 
     d_converged.setValue(converged);
 
+    // Keep the increment for the next predictions, and estimate the number of iterations saved by the prediction
+    const auto number_of_iterations = static_cast<UNSIGNED_INTEGER_TYPE>(p_squared_residuals.size());
+    if (converged) {
+        if (not predicted) {
+            ++p_number_of_unpredicted_steps;
+            p_number_of_unpredicted_iterations += number_of_iterations;
+        } else if (p_number_of_unpredicted_steps > 0) {
+            const auto average = static_cast<double>(p_number_of_unpredicted_iterations) / p_number_of_unpredicted_steps;
+            d_newton_iterations_saved.setValue(d_newton_iterations_saved.getValue() + (average - number_of_iterations));
+        }
+
+        if (predictor() != Predictor::NONE) {
+            store_solution_increment(dt);
+        }
+    } else {
+        // Do not extrapolate from a step that did not converge
+        p_previous_increments.clear();
+        p_previous_dt.clear();
+    }
+
     sofa::helper::AdvancedTimer::valSet("has_converged", converged ? 1 : 0);
     sofa::helper::AdvancedTimer::valSet("nb_iterations", n_it+1);
 }
 
 void NewtonRaphsonSolver::init() {
     p_has_already_analyzed_the_pattern = false;
+    p_mechanical_graph_signature.clear();
+    p_previous_increments.clear();
+    p_previous_dt.clear();
 
     if (not has_valid_linear_solver()) {
         // No linear solver specified, let's try to find one in the current node
@@ -471,6 +543,30 @@ void NewtonRaphsonSolver::init() {
 
 void NewtonRaphsonSolver::reset() {
     p_has_already_analyzed_the_pattern = false;
+    p_mechanical_graph_signature.clear();
+    p_previous_increments.clear();
+    p_previous_dt.clear();
+    p_number_of_unpredicted_steps = 0;
+    p_number_of_unpredicted_iterations = 0;
+    d_newton_iterations_saved.setValue(0);
+}
+
+void NewtonRaphsonSolver::build_matrix_accessor(const sofa::core::MechanicalParams & mechanical_parameters,
+                                                sofa::component::linearsolver::DefaultMultiMatrixAccessor & accessor) {
+    sofa::simulation::common::MechanicalOperations mop (&mechanical_parameters, this->getContext());
+
+    // Step 1   Get dimension of each top level mechanical states using
+    //          BaseMechanicalState::getMatrixSize(), and accumulate mechanical
+    //          objects and mapping matrices
+    accessor.clear();
+    mop.getMatrixDimension(nullptr, nullptr, &accessor);
+
+    // Step 2   Does nothing more than to accumulate from the previous step a list of
+    //          "MatrixRef = <MechanicalState*, MatrixIndex>" where MatrixIndex is the
+    //          (i,i) position of the given top level MechanicalState* inside the global
+    //          system matrix. This global matrix hence contains one sub-matrix per top
+    //          level mechanical state.
+    accessor.setupMatrices();
 }
 
 bool NewtonRaphsonSolver::has_valid_linear_solver() const {
@@ -500,4 +596,112 @@ void NewtonRaphsonSolver::set_pattern_analysis_strategy(const NewtonRaphsonSolve
     pattern_analysis_strategy->setSelectedItem(static_cast<unsigned int> (strategy));
 }
 
+auto NewtonRaphsonSolver::predictor() const -> NewtonRaphsonSolver::Predictor {
+    const auto v = static_cast<Predictor>(d_predictor.getValue().getSelectedId());
+    switch (v) {
+        case Predictor::NONE:
+        case Predictor::LINEAR:
+        case Predictor::QUADRATIC:
+        case Predictor::SECANT:
+            return v;
+    }
+
+    // Default value
+    return NewtonRaphsonSolver::Predictor::NONE;
+}
+
+void NewtonRaphsonSolver::set_predictor(const NewtonRaphsonSolver::Predictor & predictor) {
+    using namespace sofa::helper;
+    auto predictor_option = WriteOnlyAccessor<Data<OptionsGroup>>(d_predictor);
+    predictor_option->setSelectedItem(static_cast<unsigned int> (predictor));
+}
+
+auto NewtonRaphsonSolver::predictor_weights(const Predictor & predictor, const SReal & dt, const std::deque<SReal> & previous_dt,
+                                            bool unknown_is_increment) -> std::vector<SReal> {
+    if (predictor == Predictor::NONE or previous_dt.empty()) {
+        return {};
+    }
+
+    // Only the steps of positive size have a rate (or distinct end times)
+    const std::size_t order = (predictor == Predictor::QUADRATIC) ? 2 : ((predictor == Predictor::LINEAR) ? 1 : 0);
+    std::size_t number_of_points = 0;
+    while (number_of_points < std::min(order + 1, previous_dt.size()) and previous_dt[number_of_points] > 0) {
+        ++number_of_points;
+    }
+
+    if (number_of_points == 0) {
+        // Reuse the solution of the last step as is
+        return {1.};
+    }
+
+    // Lagrange extrapolation where the step n ends at t = 0.
+    // Increments: the rate U_i / h_i of each step is placed at its middle. The extrapolated rate at the middle of the
+    //             new step is multiplied by its time step, hence U = sum_i dt/h_i L_i(dt/2) U_i. With a single point,
+    //             this is the secant prediction U = (dt / h_n) U_n.
+    // Values:     the value U_i of each step is placed at its end, and extrapolated to the end of the new step, hence
+    //             U = sum_i L_i(dt) U_i. With a single point, the value of the last step is reused.
+    std::vector<SReal> t (number_of_points);
+    SReal end_of_step = 0;
+    for (std::size_t i = 0; i < number_of_points; ++i) {
+        t[i] = unknown_is_increment ? end_of_step - previous_dt[i] / 2. : end_of_step;
+        end_of_step -= previous_dt[i];
+    }
+    const SReal t_new = unknown_is_increment ? dt / 2. : dt;
+
+    std::vector<SReal> weights (number_of_points);
+    for (std::size_t i = 0; i < number_of_points; ++i) {
+        SReal w = unknown_is_increment ? dt / previous_dt[i] : 1.;
+        for (std::size_t j = 0; j < number_of_points; ++j) {
+            if (j != i) {
+                w *= (t_new - t[j]) / (t[i] - t[j]);
+            }
+        }
+        weights[i] = w;
+    }
+
+    return weights;
+}
+
+bool NewtonRaphsonSolver::predict_solution_increment(const SReal & dt, sofa::defaulttype::BaseVector * U) const {
+    const auto weights = predictor_weights(predictor(), dt, p_previous_dt, unknown_is_increment());
+    if (weights.empty()) {
+        return false;
+    }
+
+    U->clear();
+    for (std::size_t i = 0; i < weights.size(); ++i) {
+        SofaCaribou::Algebra::axpy(weights[i], p_previous_increments[i].get(), U);
+    }
+
+    return true;
+}
+
+void NewtonRaphsonSolver::store_solution_increment(const SReal & dt) {
+    // Reuse the buffer of the oldest increment once the three last increments are stored
+    std::unique_ptr<sofa::defaulttype::BaseVector> increment;
+    if (p_previous_increments.size() >= 3) {
+        increment = std::move(p_previous_increments.back());
+        p_previous_increments.pop_back();
+        p_previous_dt.pop_back();
+    } else {
+        increment.reset(p_system_owner->create_new_vector(p_U->size()));
+    }
+
+    increment->clear();
+    SofaCaribou::Algebra::axpy(1., p_U.get(), increment.get());
+    p_previous_increments.emplace_front(std::move(increment));
+    p_previous_dt.emplace_front(dt);
+}
+
+void NewtonRaphsonSolver::set_newton_iterations(const FLOATING_POINT_TYPE & squared_initial_residual,
+                                                std::vector<FLOATING_POINT_TYPE> squared_residuals,
+                                                std::vector<UNSIGNED_INTEGER_TYPE> times) {
+    p_squared_initial_residual = squared_initial_residual;
+    p_squared_residuals = std::move(squared_residuals);
+    p_times = std::move(times);
+
+    p_previous_increments.clear();
+    p_previous_dt.clear();
+}
+
 } // namespace SofaCaribou::ode
\ No newline at end of file
@@ -13,7 +13,12 @@ DISABLE_ALL_WARNINGS_BEGIN
 #include <SofaBaseLinearSolver/DefaultMultiMatrixAccessor.h>
 DISABLE_ALL_WARNINGS_END
 
+#include <SofaCaribou/Solver/LinearSolver.h>
+#include <SofaCaribou/Solver/MechanicalGraphSignature.h>
+
+#include <deque>
 #include <memory>
+#include <vector>
 
 namespace SofaCaribou::ode {
 
@@ -63,6 +68,28 @@ public:
         ALWAYS
     };
 
+    /**
+     * Different strategies to predict the solution increment of a new step from the increments of the previous
+     * (converged) steps. The predicted increment is used as the starting point of the Newton iterations.
+     *
+     * When the unknown of the ODE solver is the value of a state at the end of the step instead of an increment over
+     * the step (see unknown_is_increment()), the values of the previous steps are extrapolated to the end of the new
+     * step without any scaling by the time steps, and SECANT reuses the value of the last step.
+     */
+    enum class Predictor : unsigned int {
+        /** The Newton iterations start from the solution of the previous step. */
+        NONE = 0,
+
+        /** Linear extrapolation of the rates (increment over time step) of the last two steps, times the new time step. */
+        LINEAR,
+
+        /** Quadratic extrapolation of the rates of the last three steps, times the new time step. */
+        QUADRATIC,
+
+        /** Increment of the last step, scaled by the ratio of the time steps. */
+        SECANT
+    };
+
     CARIBOU_API
     NewtonRaphsonSolver();
 
@@ -84,6 +111,21 @@ public:
     /** The initial squared residual (||r0||^2) of the last solve call. */
     auto squared_initial_residual() const -> const FLOATING_POINT_TYPE & { return p_squared_initial_residual; }
 
+    /** Whether or not the last call to solve converged. */
+    auto converged() const -> bool { return d_converged.getValue(); }
+
+    /** Maximum number of Newton iterations of a solve call. */
+    auto maximum_number_of_newton_iterations() const -> unsigned int { return d_newton_iterations.getValue(); }
+
+    /** Relative convergence criterion on the correction |du|/|U| (disabled if negative). */
+    auto correction_tolerance_threshold() const -> double { return d_correction_tolerance_threshold.getValue(); }
+
+    /** Relative convergence criterion on the residual |R|/|R0| (disabled if negative). */
+    auto residual_tolerance_threshold() const -> double { return d_residual_tolerance_threshold.getValue(); }
+
+    /** Absolute convergence criterion on the residual |R| (disabled if negative). */
+    auto absolute_residual_tolerance_threshold() const -> double { return d_absolute_residual_tolerance_threshold.getValue(); }
+
     /** Get the current strategy that determine when the pattern of the system matrix should be analyzed. */
     CARIBOU_API
     auto pattern_analysis_strategy() const -> PatternAnalysisStrategy;
@@ -92,6 +134,60 @@ public:
     CARIBOU_API
     void set_pattern_analysis_strategy(const PatternAnalysisStrategy & strategy);
 
+    /** Get the current strategy used to predict the solution increment at the beginning of the steps. */
+    CARIBOU_API
+    auto predictor() const -> Predictor;
+
+    /** Set the current strategy used to predict the solution increment at the beginning of the steps. */
+    CARIBOU_API
+    void set_predictor(const Predictor & predictor);
+
+    /**
+     * Estimated number of Newton iterations saved by the predictor since the beginning of the simulation. It is
+     * computed from the average number of iterations of the steps that were started without prediction.
+     */
+    auto newton_iterations_saved() const -> double { return d_newton_iterations_saved.getValue(); }
+
+    /**
+     * Weights w_i of the predicted solution U = sum_i w_i U_i of a new step, where U_i is the solution of the i-th
+     * previous step (the most recent first). When the solutions are increments, the rates U_i / h_i are placed at the
+     * middle of their step, extrapolated to the middle of the new step and multiplied by its time step dt, such that
+     * the prediction remains consistent when the time steps vary. When the solutions are state values, they are placed
+     * at the end of their step and extrapolated to the end of the new step. The order of the extrapolation is reduced
+     * while the history is filled.
+     *
+     * @param predictor The strategy used to predict the solution.
+     * @param dt The time step of the new step.
+     * @param previous_dt The time steps h_i of the previous steps (the most recent first).
+     * @param unknown_is_increment True if the solutions are increments over their step, false if they are state values.
+     * @return The weight of every previous solution used by the prediction (empty if no prediction can be made).
+     */
+    CARIBOU_API
+    static auto predictor_weights(const Predictor & predictor, const SReal & dt, const std::deque<SReal> & previous_dt,
+                                  bool unknown_is_increment = true) -> std::vector<SReal>;
+
+protected:
+    /** Set whether or not the last call to solve converged (used by solvers that do not always call this solve). */
+    void set_converged(bool converged) { d_converged.setValue(converged); }
+
+    /**
+     * Set the squared residuals and the iteration times of the last call to solve (used by solvers that do not always
+     * call this solve). Since the solution increment of such a step is unknown to this solver, the history of
+     * increments used by the predictor is cleared.
+     */
+    CARIBOU_API
+    void set_newton_iterations(const FLOATING_POINT_TYPE & squared_initial_residual,
+                               std::vector<FLOATING_POINT_TYPE> squared_residuals,
+                               std::vector<UNSIGNED_INTEGER_TYPE> times);
+
+    /**
+     * Rebuild the multi-matrix accessor from the mechanical graph of the current context. It must be rebuilt before
+     * every assembly of the system matrix, since the mapped matrices it owns are not zeroed between two assemblies.
+     */
+    CARIBOU_API
+    void build_matrix_accessor(const sofa::core::MechanicalParams & mechanical_parameters,
+                               sofa::component::linearsolver::DefaultMultiMatrixAccessor & accessor);
+
 private:
 
     /**
@@ -164,16 +260,38 @@ private:
                                               sofa::core::MultiVecDerivId & v_id,
                                               sofa::core::MultiVecDerivId & dx_id) = 0;
 
+    /**
+     * States if the unknown U solved by the Newton iterations is an increment over the step (for example, the
+     * displacement of a static load increment), or the value of a state at the end of the step (for example, the
+     * acceleration of an implicit dynamic step). It selects how the previous solutions are extrapolated by the
+     * predictor.
+     */
+    virtual auto unknown_is_increment() const -> bool { return true; }
+
     /** Check that the linked linear solver is not null and that it implements the SofaCaribou::solver::LinearSolver interface */
     CARIBOU_API
     bool has_valid_linear_solver () const;
 
+    /**
+     * Extrapolate the solution increment of the new step from the increments of the previous steps, following the
+     * selected predictor. The order of the extrapolation is reduced while the history of increments is filled.
+     *
+     * @param dt The time step of the new step.
+     * @param U The vector into which the predicted increment is written.
+     * @return False if no prediction was made (no predictor selected, or no history of increments).
+     */
+    bool predict_solution_increment(const SReal & dt, sofa::defaulttype::BaseVector * U) const;
+
+    /** Keep the solution increment of the last converged step (p_U) for the predictions of the next steps. */
+    void store_solution_increment(const SReal & dt);
+
     /// INPUTS
     Data<unsigned> d_newton_iterations;
     Data<double> d_correction_tolerance_threshold;
     Data<double> d_residual_tolerance_threshold;
     Data<double> d_absolute_residual_tolerance_threshold;
     Data<sofa::helper::OptionsGroup> d_pattern_analysis_strategy;
+    Data<sofa::helper::OptionsGroup> d_predictor;
 
     Link<sofa::core::behavior::LinearSolver> l_linear_solver;
 
@@ -181,8 +299,21 @@ private:
     /// Whether or not the last call to solve converged
     Data<bool> d_converged;
 
+    /// Estimated number of Newton iterations saved by the predictor
+    Data<double> d_newton_iterations_saved;
+
     /// Private members
 
+    /// Multi-matrix accessor containing the mechanical graph, and the offset of every top level mechanical state
+    /// inside the global system. It is rebuilt before every assembly of the system matrix.
+    sofa::component::linearsolver::DefaultMultiMatrixAccessor p_accessor;
+
+    /// Signature of the mechanical graph at the time the global system was created
+    SofaCaribou::solver::MechanicalGraphSignature p_mechanical_graph_signature;
+
+    /// Linear solver that created the global system matrix and vectors
+    const SofaCaribou::solver::LinearSolver * p_system_owner = nullptr;
+
     /// Global system matrix A = mM + bB + kK
     std::unique_ptr<sofa::defaulttype::BaseMatrix> p_A;
 
@@ -193,7 +324,7 @@ private:
     std::unique_ptr<sofa::defaulttype::BaseVector> p_F;
 
     /// Total displacement since the beginning of the step
-    sofa::core::MultiVecDerivId p_U_id;
+    std::unique_ptr<sofa::defaulttype::BaseVector> p_U;
 
     /// List of times (in nanoseconds) took to compute each Newton-Raphson iteration
     std::vector<UNSIGNED_INTEGER_TYPE> p_times;
@@ -206,5 +337,13 @@ private:
 
     /// Either or not the pattern of the system matrix was analyzed at the beginning of the simulation
     bool p_has_already_analyzed_the_pattern = false;
+
+    /// Solution increments of the last converged steps (the most recent first), and their time steps
+    std::deque<std::unique_ptr<sofa::defaulttype::BaseVector>> p_previous_increments;
+    std::deque<SReal> p_previous_dt;
+
+    /// Number of steps started without prediction, and their total number of Newton iterations
+    UNSIGNED_INTEGER_TYPE p_number_of_unpredicted_steps = 0;
+    UNSIGNED_INTEGER_TYPE p_number_of_unpredicted_iterations = 0;
 };
 }
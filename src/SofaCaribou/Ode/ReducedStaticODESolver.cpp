@@ -0,0 +1,337 @@
+#include <SofaCaribou/Ode/ReducedStaticODESolver.h>
+#include <SofaCaribou/Algebra/ReducedBasis.h>
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/version.h>
+#include <sofa/core/ObjectFactory.h>
+#include <sofa/helper/AdvancedTimer.h>
+#include <sofa/simulation/MechanicalOperations.h>
+#include <sofa/simulation/VectorOperations.h>
+#if (defined(SOFA_VERSION) && SOFA_VERSION < 201299)
+#include <sofa/simulation/MechanicalVisitor.h>
+#else
+#include <sofa/simulation/mechanicalvisitor/MechanicalPropagateOnlyPositionAndVelocityVisitor.h>
+using namespace sofa::simulation::mechanicalvisitor;
+#endif
+DISABLE_ALL_WARNINGS_END
+
+#include <Eigen/Dense>
+
+#include <chrono>
+#include <cmath>
+
+namespace SofaCaribou::ode {
+
+int ReducedStaticODESolverClass = sofa::core::RegisterObject("Projection-based (POD-Galerkin) reduced order static ODE solver")
+    .add< ReducedStaticODESolver >();
+
+using namespace sofa::simulation;
+using sofa::core::MultiVecCoordId;
+using sofa::core::MultiVecDerivId;
+using sofa::core::objectmodel::BaseContext;
+using sofa::core::objectmodel::BaseObject;
+
+ReducedStaticODESolver::ReducedStaticODESolver()
+: d_basis_filename(initData(&d_basis_filename,
+    "basis_filename",
+    "File containing the reduced basis (one vector of the basis per line), for example, the one written by a "
+    "SnapshotRecorder. When no basis is loaded, every increments are solved at full order."))
+, d_fallback_residual_threshold(initData(&d_fallback_residual_threshold,
+    (double) 1e-3,
+    "fallback_residual_threshold",
+    "An increment solved in the reduced space is accepted when the ratio |R|/|R0| between the full order residual at "
+    "the reduced solution and the full order residual at the beginning of the increment is lower than this threshold. "
+    "Otherwise, the increment is solved again at full order. Use a negative value to always accept the reduced "
+    "solution."))
+, d_basis_size(initData(&d_basis_size,
+    (unsigned int) 0,
+    "basis_size",
+    "Number of vectors in the reduced basis.",
+    true /*is_displayed_in_gui*/,
+    true /*is_read_only*/))
+, d_full_order_residual_ratio(initData(&d_full_order_residual_ratio,
+    (double) 0,
+    "full_order_residual_ratio",
+    "Ratio |R|/|R0| of the full order residuals at the reduced solution of the last increment. When some components "
+    "are hyper reduced, it is only computed if the fallback threshold is positive.",
+    true /*is_displayed_in_gui*/,
+    true /*is_read_only*/))
+, d_number_of_reduced_steps(initData(&d_number_of_reduced_steps,
+    (unsigned int) 0,
+    "number_of_reduced_steps",
+    "Number of increments solved in the reduced space since the beginning of the simulation.",
+    true /*is_displayed_in_gui*/,
+    true /*is_read_only*/))
+, d_number_of_full_order_steps(initData(&d_number_of_full_order_steps,
+    (unsigned int) 0,
+    "number_of_full_order_steps",
+    "Number of increments solved at full order since the beginning of the simulation.",
+    true /*is_displayed_in_gui*/,
+    true /*is_read_only*/))
+{}
+
+void ReducedStaticODESolver::init() {
+    StaticODESolver::init();
+
+    const auto & basis_filename = d_basis_filename.getFullPath();
+    if (not basis_filename.empty()) {
+        Eigen::MatrixXd basis;
+        if (SofaCaribou::Algebra::read_column_vectors(basis_filename, basis)) {
+            set_basis(basis);
+            msg_info() << "Reduced basis of " << basis.cols() << " vectors loaded from '" << basis_filename << "'.";
+        } else {
+            msg_error() << "Unable to read the reduced basis from '" << basis_filename << "'. Every increments will be "
+                        << "solved at full order.";
+        }
+    }
+
+    reset();
+}
+
+void ReducedStaticODESolver::reset() {
+    StaticODESolver::reset();
+    p_accessor.clear();
+    p_mechanical_graph_signature.clear();
+    p_size_mismatch_was_reported = false;
+    d_number_of_reduced_steps.setValue(0);
+    d_number_of_full_order_steps.setValue(0);
+}
+
+void ReducedStaticODESolver::cleanup() {
+    // The positions of the beginning of the increment are only allocated once a reduced increment was solved
+    if (p_x_start_id.isNull()) {
+        return;
+    }
+
+    sofa::core::MechanicalParams mechanical_parameters;
+    sofa::simulation::common::VectorOperations vop(&mechanical_parameters, this->getContext());
+    vop.v_free(p_x_start_id, false /* interactionForceField */, true /* propagate [to mapped MO] */);
+    p_x_start_id = sofa::core::MultiVecCoordId();
+}
+
+void ReducedStaticODESolver::set_basis(const Eigen::MatrixXd & basis) {
+    p_basis = basis;
+    p_size_mismatch_was_reported = false;
+    d_basis_size.setValue(static_cast<unsigned int>(p_basis.cols()));
+}
+
+void ReducedStaticODESolver::solve(const sofa::core::ExecParams *params, SReal dt, MultiVecCoordId x_id, MultiVecDerivId v_id) {
+    p_hyper_reduced_components.clear();
+    for (auto * object : this->getContext()->getObjects<BaseObject>(BaseContext::SearchDown)) {
+        auto * component = dynamic_cast<HyperReducible *>(object);
+        if (component and component->hyper_reduction_is_active()) {
+            p_hyper_reduced_components.emplace_back(component);
+        }
+    }
+
+    if (p_basis.cols() > 0 and solve_reduced(params, dt, x_id, v_id)) {
+        d_number_of_reduced_steps.setValue(d_number_of_reduced_steps.getValue() + 1);
+        return;
+    }
+
+    // The hyper reduced forces are only valid in the reduced space
+    set_hyper_reduction_active(false);
+    StaticODESolver::solve(params, dt, x_id, v_id);
+    set_hyper_reduction_active(true);
+
+    d_number_of_full_order_steps.setValue(d_number_of_full_order_steps.getValue() + 1);
+}
+
+void ReducedStaticODESolver::set_hyper_reduction_active(bool active) {
+    for (auto * component : p_hyper_reduced_components) {
+        component->set_hyper_reduction_active(active);
+    }
+}
+
+auto ReducedStaticODESolver::full_order_residual_norm(const sofa::core::MechanicalParams & mechanical_parameters, MultiVecDerivId f_id) -> double {
+    sofa::helper::ScopedAdvancedTimer _t_ ("FullOrderResidual");
+    set_hyper_reduction_active(false);
+    p_F.clear();
+    this->assemble_rhs_vector(mechanical_parameters, p_accessor, f_id, &p_F);
+    set_hyper_reduction_active(true);
+
+    return p_F.vector().norm();
+}
+
+bool ReducedStaticODESolver::solve_reduced(const sofa::core::ExecParams *params, SReal dt, MultiVecCoordId x_id, MultiVecDerivId v_id) {
+    sofa::helper::ScopedAdvancedTimer _t_ ("ReducedStaticODESolver::solve_reduced");
+    const auto context = this->getContext();
+
+    // Set the multi-vector identifier inside the mechanical parameters.
+    sofa::core::MechanicalParams mechanical_parameters (*params);
+    mechanical_parameters.setX(x_id);
+    mechanical_parameters.setV(v_id);
+    mechanical_parameters.setF(sofa::core::ConstVecDerivId::force());
+    mechanical_parameters.setDf(sofa::core::ConstVecDerivId::dforce());
+    mechanical_parameters.setDx(sofa::core::ConstVecDerivId::dx());
+    mechanical_parameters.setDt(dt);
+
+    common::VectorOperations vop( &mechanical_parameters, context );
+    common::MechanicalOperations mop( &mechanical_parameters, context );
+    mop->setImplicit(true);
+
+    auto f_id = MultiVecDerivId(sofa::core::VecDerivId::force());
+    vop.v_clear(f_id);
+
+    auto dx_id = MultiVecDerivId(sofa::core::VecDerivId::dx());
+    vop.v_realloc(dx_id, false /* interactionForceField */, false /* propagate [to mapped MO] */);
+    vop.v_clear(dx_id);
+
+    // Multi-matrix accessor of the full order system, rebuilt before every assembly of the system matrix. The system
+    // buffers are only resized following a change of the mechanical graph.
+    this->build_matrix_accessor(mechanical_parameters, p_accessor);
+    bool accessor_is_up_to_date = true;
+    if (not p_mechanical_graph_signature.is_up_to_date()) {
+        sofa::helper::ScopedAdvancedTimer _t_setup_ ("SetupSystem");
+        const auto n = static_cast<Eigen::Index>(p_accessor.getGlobalDimension());
+        p_A.resize(n, n);
+        p_A.set_pattern_locked(true);
+        p_F.resize(n);
+        p_DX.resize(n);
+
+        p_mechanical_graph_signature.capture(context);
+    }
+
+    const auto n = static_cast<Eigen::Index>(p_accessor.getGlobalDimension());
+    if (p_basis.rows() != n) {
+        if (not p_size_mismatch_was_reported) {
+            msg_error() << "The size of the reduced basis (" << p_basis.rows() << ") does not match the size of the "
+                        << "mechanical system (" << n << "). Every increments will be solved at full order.";
+            p_size_mismatch_was_reported = true;
+        }
+        return false;
+    }
+
+    // Keep the positions of the beginning of the increment in case it has to be solved again at full order
+    vop.v_realloc(p_x_start_id, false /* interactionForceField */, true /* propagate [to mapped MO] */);
+    vop.v_eq(p_x_start_id, x_id);
+
+    const auto newton_iterations = maximum_number_of_newton_iterations();
+    const auto correction_threshold = correction_tolerance_threshold();
+    const auto residual_threshold = residual_tolerance_threshold();
+    const auto absolute_residual_threshold = absolute_residual_tolerance_threshold();
+    const auto & print_log = f_printLog.getValue();
+    const auto & fallback_threshold = d_fallback_residual_threshold.getValue();
+    const auto & Phi = p_basis;
+
+    // When hyper reduced, the full order residuals are only evaluated for the fallback test
+    const bool is_hyper_reduced = not p_hyper_reduced_components.empty();
+    const bool full_order_residual_is_needed = (fallback_threshold >= 0);
+
+    // Initial residual
+    double R0 = 0;
+    if (is_hyper_reduced and full_order_residual_is_needed) {
+        R0 = full_order_residual_norm(mechanical_parameters, f_id);
+    }
+
+    p_F.clear();
+    this->assemble_rhs_vector(mechanical_parameters, p_accessor, f_id, &p_F);
+    if (not is_hyper_reduced) {
+        R0 = p_F.vector().norm();
+    }
+    Eigen::VectorXd r = Phi.transpose() * p_F.vector();
+    const double r0 = r.norm();
+
+    bool converged = (absolute_residual_threshold > 0 and p_F.vector().norm() <= absolute_residual_threshold);
+    bool diverged = false;
+    unsigned int n_it = 0;
+    Eigen::VectorXd q = Eigen::VectorXd::Zero(Phi.cols());
+    Eigen::MatrixXd A_Phi (n, Phi.cols());
+    Eigen::LDLT<Eigen::MatrixXd> reduced_solver;
+
+    // Squared norms of the reduced residuals and times (in nanoseconds) of the reduced iterations
+    std::vector<FLOATING_POINT_TYPE> squared_residuals;
+    std::vector<UNSIGNED_INTEGER_TYPE> times;
+    squared_residuals.reserve(newton_iterations);
+    times.reserve(newton_iterations);
+
+    while (not converged and n_it < newton_iterations) {
+        sofa::helper::ScopedAdvancedTimer step_timer ("ReducedNewtonStep");
+        const auto t = std::chrono::steady_clock::now();
+
+        // Reduced system matrix Phi^T A Phi (r x r)
+        {
+            sofa::helper::ScopedAdvancedTimer _t_build_ ("MBKBuild");
+            if (not accessor_is_up_to_date) {
+                this->build_matrix_accessor(mechanical_parameters, p_accessor);
+            }
+            accessor_is_up_to_date = false;
+            p_A.clear();
+            this->assemble_system_matrix(mechanical_parameters, p_accessor, &p_A);
+            A_Phi.noalias() = p_A.matrix() * Phi;
+            reduced_solver.compute(Phi.transpose() * A_Phi);
+        }
+
+        if (reduced_solver.info() != Eigen::Success) {
+            diverged = true;
+            break;
+        }
+
+        // Reduced increment, mapped back to the full order space
+        const Eigen::VectorXd dq = reduced_solver.solve(r);
+        q += dq;
+        p_DX.vector().noalias() = Phi * dq;
+        this->propagate_solution_increment(mechanical_parameters, p_accessor, &p_DX, x_id, v_id, dx_id);
+        vop.v_clear(dx_id);
+
+        // Updated full order and reduced residuals
+        p_F.clear();
+        this->assemble_rhs_vector(mechanical_parameters, p_accessor, f_id, &p_F);
+        r.noalias() = Phi.transpose() * p_F.vector();
+        ++n_it;
+
+        times.emplace_back(static_cast<UNSIGNED_INTEGER_TYPE>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t).count()
+        ));
+        squared_residuals.emplace_back(r.squaredNorm());
+
+        const auto r_norm = r.norm();
+        const auto dq_norm = dq.norm();
+        if (print_log) {
+            msg_info() << "Reduced Newton iteration #" << n_it << "  |r| = " << r_norm
+                       << "  |r|/|r0| = " << r_norm / r0 << "  |dq|/|q| = " << dq_norm / q.norm();
+        }
+
+        if (std::isnan(r_norm) or std::isnan(dq_norm)) {
+            diverged = true;
+            break;
+        }
+
+        converged = (correction_threshold > 0 and dq_norm < correction_threshold*q.norm()) or
+                    (residual_threshold > 0 and r_norm < residual_threshold*r0) or
+                    (absolute_residual_threshold > 0 and r_norm < absolute_residual_threshold);
+    }
+
+    // Accept the reduced solution if it also (nearly) satisfies the full order equations
+    double R = p_F.vector().norm();
+    if (is_hyper_reduced and full_order_residual_is_needed and n_it > 0 and converged and not diverged) {
+        R = full_order_residual_norm(mechanical_parameters, f_id);
+    }
+
+    const double residual_ratio = (n_it > 0 and R0 > 0) ? R / R0 : 0;
+    d_full_order_residual_ratio.setValue(residual_ratio);
+
+    const bool accepted = converged and not diverged and (fallback_threshold < 0 or residual_ratio <= fallback_threshold);
+    if (accepted) {
+        this->set_newton_iterations(r0*r0, std::move(squared_residuals), std::move(times));
+        set_converged(true);
+        return true;
+    }
+
+    if (print_log) {
+        if (converged) {
+            msg_info() << "The reduced solution is rejected (|R|/|R0| = " << residual_ratio << "), the increment is "
+                       << "solved at full order.";
+        } else {
+            msg_info() << "The reduced iterations did not converge, the increment is solved at full order.";
+        }
+    }
+
+    // Restart the increment from its initial positions
+    vop.v_eq(x_id, p_x_start_id);
+    MechanicalPropagateOnlyPositionAndVelocityVisitor(&mechanical_parameters).execute(context);
+
+    return false;
+}
+
+} // namespace SofaCaribou::ode
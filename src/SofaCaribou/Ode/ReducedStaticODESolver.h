@@ -0,0 +1,141 @@
+#pragma once
+
+#include <SofaCaribou/config.h>
+#include <SofaCaribou/Ode/StaticODESolver.h>
+#include <SofaCaribou/Ode/HyperReducible.h>
+#include <SofaCaribou/Algebra/EigenMatrix.h>
+#include <SofaCaribou/Algebra/EigenVector.h>
+#include <SofaCaribou/Solver/MechanicalGraphSignature.h>
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/core/objectmodel/Data.h>
+#include <sofa/core/objectmodel/DataFileName.h>
+#include <sofa/core/MultiVecId.h>
+#include <SofaBaseLinearSolver/DefaultMultiMatrixAccessor.h>
+DISABLE_ALL_WARNINGS_END
+
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+
+#include <vector>
+
+namespace SofaCaribou::ode {
+
+/**
+ * Implementation of a projection-based (POD-Galerkin) reduced order static ODE solver.
+ *
+ * The increments of the Newton-Raphson iterations of the StaticODESolver are restricted to the span of a reduced
+ * basis \f$\mat{\Phi}\f$ (a dense \f$n \times r\f$ matrix, with \f$r \ll n\f$), usually extracted offline from the
+ * snapshots of full order simulations with a SnapshotRecorder. The system matrix and the residual vector are still
+ * assembled at full order, and then projected onto the basis:
+ *
+ * \f{align*}{
+ *     \mat{\Phi}^T \mat{K}(\vect{x}_{n+1}^i) \mat{\Phi} \left [ \Delta \vect{q}_{n+1}^{i+1} \right ] &= - \mat{\Phi}^T \vect{F}(\vect{x}_{n+1}^i) \\
+ *     \vect{x}_{n+1}^{i+1} &= \vect{x}_{n+1}^{i} + \mat{\Phi} \Delta \vect{q}_{n+1}^{i+1}
+ * \f}
+ *
+ * where the dense \f$r \times r\f$ reduced system is solved with a Cholesky (LDLT) decomposition. Hence, no linear
+ * solver is needed for the reduced steps.
+ *
+ * Since the basis might not span the solution of a load increment that was not seen during the training, the residual
+ * of the full order equations is evaluated at the reduced solution. If its ratio with the residual at the beginning
+ * of the increment is larger than the fallback threshold (or if the reduced iterations do not converge), the increment
+ * is restarted and solved at full order by the StaticODESolver, which then requires a linear solver.
+ *
+ * When some components of the context are hyper reduced (see HyperReducible), their forces are only integrated over
+ * their weighted subset of elements during the reduced iterations. The full order residuals of the fallback test are
+ * then evaluated with the hyper reduction deactivated, which costs two full order force evaluations per increment
+ * (use a negative fallback threshold to avoid them). The hyper reduction is also deactivated when an increment is
+ * solved at full order.
+ *
+ * For an increment solved in the reduced space, squared_residuals() and iteration_times() give the squared norms of
+ * the reduced residuals and the times of the reduced iterations. The history of increments of the predictor is cleared
+ * by such an increment, hence the prediction of the full order increments only restarts after the following full
+ * order increments.
+ */
+class ReducedStaticODESolver : public StaticODESolver {
+public:
+    SOFA_CLASS(ReducedStaticODESolver, StaticODESolver);
+
+    template <typename T>
+    using Data = sofa::core::objectmodel::Data<T>;
+
+    CARIBOU_API
+    ReducedStaticODESolver();
+
+    CARIBOU_API
+    void init() override;
+
+    CARIBOU_API
+    void reset() override;
+
+    CARIBOU_API
+    void cleanup() override;
+
+    CARIBOU_API
+    void solve (const sofa::core::ExecParams* params, SReal dt, sofa::core::MultiVecCoordId x_id, sofa::core::MultiVecDerivId v_id) override;
+
+    /** The reduced basis (one vector per column). */
+    auto basis() const -> const Eigen::MatrixXd & { return p_basis; }
+
+    /** Set the reduced basis (one vector per column), for example, a basis computed by a SnapshotRecorder. */
+    CARIBOU_API
+    void set_basis(const Eigen::MatrixXd & basis);
+
+    /** Number of increments solved in the reduced space since the beginning of the simulation. */
+    auto number_of_reduced_steps() const -> unsigned int { return d_number_of_reduced_steps.getValue(); }
+
+    /** Number of increments solved at full order since the beginning of the simulation. */
+    auto number_of_full_order_steps() const -> unsigned int { return d_number_of_full_order_steps.getValue(); }
+
+private:
+    /**
+     * Solve the increment in the reduced space.
+     * @return True if the reduced solution is accepted, false if the increment must be solved at full order.
+     */
+    bool solve_reduced(const sofa::core::ExecParams* params, SReal dt, sofa::core::MultiVecCoordId x_id, sofa::core::MultiVecDerivId v_id);
+
+    /** Activate or deactivate the hyper reduction of the hyper reduced components found at the beginning of the increment. */
+    void set_hyper_reduction_active(bool active);
+
+    /** Norm of the full order residual vector, evaluated with the hyper reduction deactivated. */
+    auto full_order_residual_norm(const sofa::core::MechanicalParams & mechanical_parameters, sofa::core::MultiVecDerivId f_id) -> double;
+
+    /// INPUTS
+    sofa::core::objectmodel::DataFileName d_basis_filename;
+    Data<double> d_fallback_residual_threshold;
+
+    /// OUTPUTS
+    Data<unsigned int> d_basis_size;
+    Data<double> d_full_order_residual_ratio;
+    Data<unsigned int> d_number_of_reduced_steps;
+    Data<unsigned int> d_number_of_full_order_steps;
+
+    /// Private members
+
+    /// Reduced basis (one vector per column)
+    Eigen::MatrixXd p_basis;
+
+    /// Multi-matrix accessor containing the offset of every top level mechanical state inside the system vectors. It is
+    /// rebuilt before every assembly of the system matrix.
+    sofa::component::linearsolver::DefaultMultiMatrixAccessor p_accessor;
+
+    /// Signature of the mechanical graph at the time the system was built
+    SofaCaribou::solver::MechanicalGraphSignature p_mechanical_graph_signature;
+
+    /// Full order system matrix, residual and increment vectors
+    SofaCaribou::Algebra::EigenMatrix<Eigen::SparseMatrix<double>> p_A;
+    SofaCaribou::Algebra::EigenVector<Eigen::VectorXd> p_F;
+    SofaCaribou::Algebra::EigenVector<Eigen::VectorXd> p_DX;
+
+    /// Components of the context for which the hyper reduction was active at the beginning of the increment
+    std::vector<HyperReducible *> p_hyper_reduced_components;
+
+    /// Positions at the beginning of the increment, used to restart it at full order
+    sofa::core::MultiVecCoordId p_x_start_id;
+
+    /// Whether or not the user was already told that the basis does not match the mechanical system
+    bool p_size_mismatch_was_reported = false;
+};
+
+} // namespace SofaCaribou::ode
@@ -0,0 +1,270 @@
+#include <SofaCaribou/Ode/SnapshotRecorder.h>
+#include <SofaCaribou/Ode/NewtonRaphsonSolver.h>
+#include <SofaCaribou/Ode/HyperReducible.h>
+#include <SofaCaribou/Algebra/EigenVector.h>
+#include <SofaCaribou/Algebra/ReducedBasis.h>
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/version.h>
+#include <sofa/core/ObjectFactory.h>
+#include <sofa/core/MechanicalParams.h>
+#include <sofa/helper/AdvancedTimer.h>
+#include <sofa/simulation/AnimateEndEvent.h>
+#include <sofa/simulation/MechanicalOperations.h>
+#if (defined(SOFA_VERSION) && SOFA_VERSION < 201299)
+#include <sofa/simulation/MechanicalVisitor.h>
+#else
+#include <sofa/simulation/mechanicalvisitor/MechanicalMultiVectorToBaseVectorVisitor.h>
+using namespace sofa::simulation::mechanicalvisitor;
+#endif
+DISABLE_ALL_WARNINGS_END
+
+#include <algorithm>
+
+namespace SofaCaribou::ode {
+
+int SnapshotRecorderClass = sofa::core::RegisterObject("Recorder of displacement snapshots and extraction of a POD reduced basis")
+    .add< SnapshotRecorder >();
+
+using namespace sofa::simulation;
+using sofa::core::objectmodel::BaseContext;
+
+SnapshotRecorder::SnapshotRecorder()
+: d_snapshots_filename(initData(&d_snapshots_filename,
+    "snapshots_filename",
+    "File into which the snapshots are written at the end of the training (one snapshot per line). Leave empty "
+    "to keep the snapshots in memory only."))
+, d_basis_filename(initData(&d_basis_filename,
+    "basis_filename",
+    "File into which the reduced basis extracted from the snapshots is written at the end of the training (one vector "
+    "of the basis per line). Leave empty to skip the extraction of the basis."))
+, d_append(initData(&d_append,
+    false,
+    "append",
+    "Load the snapshots already stored in the snapshots file at initialization, and append the new snapshots to them. "
+    "This allows to gather the snapshots of multiple training simulations."))
+, d_recording_interval(initData(&d_recording_interval,
+    (unsigned int) 1,
+    "recording_interval",
+    "Number of time steps between two recorded snapshots."))
+, d_number_of_steps(initData(&d_number_of_steps,
+    (unsigned int) 0,
+    "number_of_steps",
+    "Number of time steps of the training simulation. At the end of the last one, the snapshots are written, and the "
+    "reduced basis and the hyper reduction are extracted from them and written. Use 0 to only do it when save() is "
+    "called."))
+, d_basis_tolerance(initData(&d_basis_tolerance,
+    (double) 1e-4,
+    "basis_tolerance",
+    "Maximum relative projection error of the snapshots onto the reduced basis. The basis is made of the smallest "
+    "number of POD modes for which sqrt(sum_{i>r} s_i^2 / sum_i s_i^2) is lower than this tolerance, where s_i are "
+    "the singular values of the snapshot matrix."))
+, d_maximum_basis_size(initData(&d_maximum_basis_size,
+    (unsigned int) 0,
+    "maximum_basis_size",
+    "Maximum number of vectors in the reduced basis (0 for no limit)."))
+, d_hyper_reduction_filename(initData(&d_hyper_reduction_filename,
+    "hyper_reduction_filename",
+    "File into which the elements and weights of the hyper reduction trained on the snapshots are written at the end "
+    "of the training (one 'element_index weight' pair per line). Leave empty to skip the training of the hyper "
+    "reduction."))
+, d_hyper_reduction_tolerance(initData(&d_hyper_reduction_tolerance,
+    (double) 1e-2,
+    "hyper_reduction_tolerance",
+    "Maximum relative error of the hyper reduced internal forces projected onto the reduced basis, for the recorded "
+    "snapshots. A smaller tolerance selects more elements."))
+, d_number_of_snapshots(initData(&d_number_of_snapshots,
+    (unsigned int) 0,
+    "number_of_snapshots",
+    "Number of snapshots recorded so far.",
+    true /*is_displayed_in_gui*/,
+    true /*is_read_only*/))
+, d_basis_size(initData(&d_basis_size,
+    (unsigned int) 0,
+    "basis_size",
+    "Number of vectors in the last extracted reduced basis.",
+    true /*is_displayed_in_gui*/,
+    true /*is_read_only*/))
+{
+    this->f_listening.setValue(true);
+}
+
+void SnapshotRecorder::init() {
+    p_accessor.clear();
+    p_mechanical_graph_signature.clear();
+    p_number_of_steps_since_recording = 0;
+    p_number_of_steps = 0;
+    p_snapshots.clear();
+
+    const auto & snapshots_filename = d_snapshots_filename.getFullPath();
+    if (d_append.getValue() and not snapshots_filename.empty()) {
+        Eigen::MatrixXd snapshots;
+        if (SofaCaribou::Algebra::read_column_vectors(snapshots_filename, snapshots)) {
+            for (Eigen::Index j = 0; j < snapshots.cols(); ++j) {
+                p_snapshots.emplace_back(snapshots.col(j));
+            }
+            msg_info() << p_snapshots.size() << " snapshots loaded from '" << snapshots_filename << "'.";
+        } else {
+            msg_info() << "No snapshots could be loaded from '" << snapshots_filename << "'.";
+        }
+    }
+
+    d_number_of_snapshots.setValue(static_cast<unsigned int>(p_snapshots.size()));
+}
+
+void SnapshotRecorder::handleEvent(sofa::core::objectmodel::Event * event) {
+    if (not sofa::simulation::AnimateEndEvent::checkEventType(event)) {
+        return;
+    }
+
+    ++p_number_of_steps;
+    ++p_number_of_steps_since_recording;
+    if (p_number_of_steps_since_recording >= std::max(1u, d_recording_interval.getValue())) {
+        // Only record the equilibrium states
+        const auto * solver = this->getContext()->get<NewtonRaphsonSolver>(BaseContext::Local);
+        if (not solver or solver->converged()) {
+            record();
+            p_number_of_steps_since_recording = 0;
+        }
+    }
+
+    // End of the training simulation
+    if (p_number_of_steps == d_number_of_steps.getValue()) {
+        if (p_snapshots.empty()) {
+            msg_warning() << "No snapshot was recorded during the " << p_number_of_steps << " time steps of the training.";
+        } else {
+            save();
+        }
+    }
+}
+
+void SnapshotRecorder::record() {
+    sofa::helper::ScopedAdvancedTimer _t_ ("SnapshotRecorder::record");
+    auto * context = this->getContext();
+
+    sofa::core::MechanicalParams mechanical_parameters;
+    common::MechanicalOperations mop (&mechanical_parameters, context);
+
+    // The snapshots follow the layout of the global system of the Newton-Raphson solvers
+    if (not p_mechanical_graph_signature.is_up_to_date()) {
+        p_accessor.clear();
+        mop.getMatrixDimension(nullptr, nullptr, &p_accessor);
+        p_accessor.setupMatrices();
+        p_mechanical_graph_signature.capture(context);
+    }
+
+    const auto n = static_cast<Eigen::Index>(p_accessor.getGlobalDimension());
+    if (not p_snapshots.empty() and p_snapshots.front().size() != n) {
+        msg_warning() << "The size of the mechanical system (" << n << ") does not match the size of the snapshots "
+                      << "already recorded (" << p_snapshots.front().size() << "). The snapshot is skipped.";
+        return;
+    }
+
+    // u = x - x0
+    SofaCaribou::Algebra::EigenVector<Eigen::VectorXd> x (n), x0 (n);
+    MechanicalMultiVectorToBaseVectorVisitor(&mechanical_parameters, sofa::core::ConstMultiVecCoordId(sofa::core::ConstVecCoordId::position()), &x, &p_accessor)
+    .execute(context);
+    MechanicalMultiVectorToBaseVectorVisitor(&mechanical_parameters, sofa::core::ConstMultiVecCoordId(sofa::core::ConstVecCoordId::restPosition()), &x0, &p_accessor)
+    .execute(context);
+
+    p_snapshots.emplace_back(x.vector() - x0.vector());
+    d_number_of_snapshots.setValue(static_cast<unsigned int>(p_snapshots.size()));
+}
+
+auto SnapshotRecorder::snapshots() const -> Eigen::MatrixXd {
+    const auto n = p_snapshots.empty() ? 0 : p_snapshots.front().size();
+    Eigen::MatrixXd snapshots (n, static_cast<Eigen::Index>(p_snapshots.size()));
+    for (std::size_t j = 0; j < p_snapshots.size(); ++j) {
+        snapshots.col(static_cast<Eigen::Index>(j)) = p_snapshots[j];
+    }
+
+    return snapshots;
+}
+
+auto SnapshotRecorder::compute_basis() -> Eigen::MatrixXd {
+    sofa::helper::ScopedAdvancedTimer _t_ ("SnapshotRecorder::compute_basis");
+    const auto basis = SofaCaribou::Algebra::proper_orthogonal_decomposition(
+        snapshots(), d_basis_tolerance.getValue(), static_cast<Eigen::Index>(d_maximum_basis_size.getValue())
+    );
+    d_basis_size.setValue(static_cast<unsigned int>(basis.cols()));
+
+    msg_info() << "Reduced basis of " << basis.cols() << " vectors extracted from " << p_snapshots.size()
+               << " snapshots.";
+
+    return basis;
+}
+
+bool SnapshotRecorder::train_hyper_reduction(const Eigen::MatrixXd & basis) {
+    sofa::helper::ScopedAdvancedTimer _t_ ("SnapshotRecorder::train_hyper_reduction");
+
+    const auto snapshots = this->snapshots();
+    bool trained = false;
+    const auto objects = this->getContext()->getObjects<BaseObject>(BaseContext::SearchDown);
+    for (auto * object : objects) {
+        auto * component = dynamic_cast<HyperReducible *>(object);
+        if (not component) {
+            continue;
+        }
+
+        if (trained) {
+            msg_warning() << "Only the first hyper reducible component is trained, '" << object->getPathName()
+                          << "' is ignored.";
+            continue;
+        }
+
+        if (component->train_hyper_reduction(snapshots, basis, d_hyper_reduction_tolerance.getValue())) {
+            trained = true;
+
+            // The recorded simulation is a full order one, hence it must not use the hyper reduced forces
+            component->set_hyper_reduction_active(false);
+
+            const auto & hyper_reduction_filename = d_hyper_reduction_filename.getFullPath();
+            if (hyper_reduction_filename.empty()) {
+                continue;
+            }
+
+            if (component->write_hyper_reduction_weights(hyper_reduction_filename)) {
+                msg_info() << "Hyper reduction of '" << object->getPathName() << "' written into '"
+                           << hyper_reduction_filename << "'.";
+            } else {
+                msg_error() << "Unable to write the hyper reduction into '" << hyper_reduction_filename << "'.";
+            }
+        } else {
+            msg_error() << "Unable to train the hyper reduction of '" << object->getPathName() << "'.";
+        }
+    }
+
+    return trained;
+}
+
+void SnapshotRecorder::save() {
+    const auto & snapshots_filename = d_snapshots_filename.getFullPath();
+    if (not snapshots_filename.empty()) {
+        if (SofaCaribou::Algebra::write_column_vectors(snapshots_filename, snapshots())) {
+            msg_info() << p_snapshots.size() << " snapshots written into '" << snapshots_filename << "'.";
+        } else {
+            msg_error() << "Unable to write the snapshots into '" << snapshots_filename << "'.";
+        }
+    }
+
+    const auto & basis_filename = d_basis_filename.getFullPath();
+    const auto & hyper_reduction_filename = d_hyper_reduction_filename.getFullPath();
+    if (basis_filename.empty() and hyper_reduction_filename.empty()) {
+        return;
+    }
+
+    const auto basis = compute_basis();
+    if (not basis_filename.empty()) {
+        if (SofaCaribou::Algebra::write_column_vectors(basis_filename, basis)) {
+            msg_info() << "Reduced basis written into '" << basis_filename << "'.";
+        } else {
+            msg_error() << "Unable to write the reduced basis into '" << basis_filename << "'.";
+        }
+    }
+
+    if (not hyper_reduction_filename.empty() and not train_hyper_reduction(basis)) {
+        msg_error() << "No hyper reducible component could be trained.";
+    }
+}
+
+} // namespace SofaCaribou::ode
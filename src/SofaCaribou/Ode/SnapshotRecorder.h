@@ -0,0 +1,117 @@
+#pragma once
+
+#include <SofaCaribou/config.h>
+#include <SofaCaribou/Solver/MechanicalGraphSignature.h>
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/core/objectmodel/BaseObject.h>
+#include <sofa/core/objectmodel/Data.h>
+#include <sofa/core/objectmodel/DataFileName.h>
+#include <SofaBaseLinearSolver/DefaultMultiMatrixAccessor.h>
+DISABLE_ALL_WARNINGS_END
+
+#include <Eigen/Core>
+
+#include <vector>
+
+namespace SofaCaribou::ode {
+
+/**
+ * Recorder of the displacement snapshots used to build a projection-based reduced order model offline.
+ *
+ * At the end of every time steps (every N time steps), the displacement \f$\vect{u} = \vect{x} - \vect{x}_0\f$ of the
+ * top level mechanical states found in the current context is appended to the snapshots, using the same ordering as
+ * the global system vectors of the Newton-Raphson solvers (see StaticODESolver). When a Newton-Raphson solver is
+ * found in the current context, only the time steps for which it converged are recorded.
+ *
+ * At the end of the last time step of the training simulation (or when save() is called), the snapshots are written
+ * into a file, and an orthonormal reduced basis is extracted from them by a proper orthogonal decomposition (POD) and
+ * written into another file. This basis can then be used by the ReducedStaticODESolver.
+ *
+ * When a hyper reduction file is set, the components implementing the HyperReducible interface (for example, the
+ * HyperelasticForcefield) are also trained on the snapshots and the reduced basis, and their elements and weights are
+ * written into this file.
+ */
+class SnapshotRecorder : public sofa::core::objectmodel::BaseObject {
+public:
+    SOFA_CLASS(SnapshotRecorder, sofa::core::objectmodel::BaseObject);
+
+    template <typename T>
+    using Data = sofa::core::objectmodel::Data<T>;
+
+    CARIBOU_API
+    SnapshotRecorder();
+
+    CARIBOU_API
+    void init() override;
+
+    CARIBOU_API
+    void handleEvent(sofa::core::objectmodel::Event * event) override;
+
+    /** Append the current displacement of the top level mechanical states to the snapshots. */
+    CARIBOU_API
+    void record();
+
+    /** Extract the reduced basis (one vector per column) from the snapshots recorded so far. */
+    CARIBOU_API
+    auto compute_basis() -> Eigen::MatrixXd;
+
+    /**
+     * Train the hyper reduction of the HyperReducible components found in the current context and its children.
+     * @return False if no component could be trained.
+     */
+    CARIBOU_API
+    bool train_hyper_reduction(const Eigen::MatrixXd & basis);
+
+    /**
+     * Write the snapshots, the reduced basis and the hyper reduction weights into their files (when set). This is
+     * done automatically at the end of the last time step of the training simulation (see number_of_steps).
+     */
+    CARIBOU_API
+    void save();
+
+    /** Snapshots recorded so far (one snapshot per column). */
+    CARIBOU_API
+    auto snapshots() const -> Eigen::MatrixXd;
+
+    /** Number of snapshots recorded so far. */
+    auto number_of_snapshots() const -> unsigned int { return d_number_of_snapshots.getValue(); }
+
+    /** Number of vectors in the last extracted reduced basis. */
+    auto basis_size() const -> unsigned int { return d_basis_size.getValue(); }
+
+private:
+    /// INPUTS
+    sofa::core::objectmodel::DataFileName d_snapshots_filename;
+    sofa::core::objectmodel::DataFileName d_basis_filename;
+    Data<bool> d_append;
+    Data<unsigned int> d_recording_interval;
+    Data<unsigned int> d_number_of_steps;
+    Data<double> d_basis_tolerance;
+    Data<unsigned int> d_maximum_basis_size;
+    sofa::core::objectmodel::DataFileName d_hyper_reduction_filename;
+    Data<double> d_hyper_reduction_tolerance;
+
+    /// OUTPUTS
+    Data<unsigned int> d_number_of_snapshots;
+    Data<unsigned int> d_basis_size;
+
+    /// Private members
+
+    /// Multi-matrix accessor containing the offset of every top level mechanical state inside the snapshot vectors
+    sofa::component::linearsolver::DefaultMultiMatrixAccessor p_accessor;
+
+    /// Signature of the mechanical graph at the time the accessor was built
+    SofaCaribou::solver::MechanicalGraphSignature p_mechanical_graph_signature;
+
+    /// Recorded snapshots
+    std::vector<Eigen::VectorXd> p_snapshots;
+
+    /// Number of time steps since the last recording
+    unsigned int p_number_of_steps_since_recording = 0;
+
+    /// Number of time steps since the beginning of the training simulation
+    unsigned int p_number_of_steps = 0;
+};
+
+} // namespace SofaCaribou::ode
@@ -0,0 +1,195 @@
+#include <SofaCaribou/Ode/StableTimeStepEstimator.h>
+#include <SofaCaribou/Algebra/EigenVector.h>
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/core/ObjectFactory.h>
+#include <sofa/core/MechanicalParams.h>
+#include <sofa/core/behavior/BaseMechanicalState.h>
+#include <sofa/helper/AdvancedTimer.h>
+#include <sofa/simulation/AnimateBeginEvent.h>
+#include <sofa/simulation/MechanicalOperations.h>
+#include <sofa/simulation/VectorOperations.h>
+DISABLE_ALL_WARNINGS_END
+
+#include <cmath>
+#include <random>
+
+namespace SofaCaribou::ode {
+
+int StableTimeStepEstimatorClass = sofa::core::RegisterObject("Estimation of the stable time step of explicit schemes by power iterations on M^-1 K")
+    .add< StableTimeStepEstimator >();
+
+using sofa::core::objectmodel::BaseContext;
+
+StableTimeStepEstimator::StableTimeStepEstimator()
+: d_update_interval(initData(&d_update_interval,
+    (unsigned int) 1,
+    "update_interval",
+    "Number of time steps between two estimations. Use 1 to estimate it at the beginning of every time steps, and 0 "
+    "to estimate it only at the first time step."))
+, d_maximum_number_of_iterations(initData(&d_maximum_number_of_iterations,
+    (unsigned int) 20,
+    "maximum_number_of_iterations",
+    "Maximum number of power iterations (force derivative evaluations) per estimation."))
+, d_tolerance(initData(&d_tolerance,
+    (double) 1e-3,
+    "tolerance",
+    "The power iterations stop when the relative change of the largest eigenvalue between two iterations is "
+    "smaller than this threshold."))
+, d_largest_eigenvalue(initData(&d_largest_eigenvalue,
+    (double) 0,
+    "largest_eigenvalue",
+    "Largest eigenvalue of M^-1 K (the square of the highest angular frequency) found during the last estimation.",
+    true /*is_displayed_in_gui*/,
+    true /*is_read_only*/))
+, d_critical_time_step(initData(&d_critical_time_step,
+    (double) 0,
+    "critical_time_step",
+    "Critical time step 2/sqrt(lambda_max) of the central difference scheme found during the last estimation. Zero "
+    "if it could not be estimated.",
+    true /*is_displayed_in_gui*/,
+    true /*is_read_only*/))
+, d_number_of_iterations(initData(&d_number_of_iterations,
+    (unsigned int) 0,
+    "number_of_iterations",
+    "Number of power iterations done during the last estimation.",
+    true /*is_displayed_in_gui*/,
+    true /*is_read_only*/))
+{
+    this->f_listening.setValue(true);
+}
+
+void StableTimeStepEstimator::init() {
+    reset();
+}
+
+void StableTimeStepEstimator::reset() {
+    p_has_starting_vector = false;
+    p_is_estimated = false;
+    p_number_of_steps_since_estimation = 0;
+}
+
+void StableTimeStepEstimator::cleanup() {
+    // The work vectors are only allocated once an estimation was done
+    if (p_q_id.isNull()) {
+        return;
+    }
+
+    sofa::core::MechanicalParams mechanical_parameters;
+    sofa::simulation::common::VectorOperations vop(&mechanical_parameters, this->getContext());
+    vop.v_free(p_q_id, false /* interactionForceField */, true /* propagate [to mapped MO] */);
+    vop.v_free(p_Kq_id, false /* interactionForceField */, true /* propagate [to mapped MO] */);
+    vop.v_free(p_z_id, false /* interactionForceField */, true /* propagate [to mapped MO] */);
+    p_q_id = p_Kq_id = p_z_id = sofa::core::MultiVecDerivId();
+    p_has_starting_vector = false;
+}
+
+void StableTimeStepEstimator::handleEvent(sofa::core::objectmodel::Event * event) {
+    if (not sofa::simulation::AnimateBeginEvent::checkEventType(event)) {
+        return;
+    }
+
+    const auto update_interval = d_update_interval.getValue();
+    if (not p_is_estimated or (update_interval > 0 and p_number_of_steps_since_estimation >= update_interval)) {
+        estimate();
+        p_number_of_steps_since_estimation = 0;
+    }
+    ++p_number_of_steps_since_estimation;
+}
+
+auto StableTimeStepEstimator::estimate() -> SReal {
+    using namespace sofa::core::behavior;
+    sofa::helper::ScopedAdvancedTimer _t_ ("StableTimeStepEstimator::estimate");
+    p_is_estimated = true;
+
+    // The stiffness products are computed on the vector q
+    sofa::core::MechanicalParams mechanical_parameters;
+    mechanical_parameters.setDx(p_q_id);
+    sofa::simulation::common::VectorOperations vop(&mechanical_parameters, this->getContext());
+    sofa::simulation::common::MechanicalOperations mop(&mechanical_parameters, this->getContext());
+
+    // The eigenvector is kept between the estimations, the two other vectors are temporaries
+    vop.v_realloc(p_q_id, false /* interactionForceField */, true /* propagate [to mapped MO] */);
+    vop.v_realloc(p_Kq_id, false /* interactionForceField */, true /* propagate [to mapped MO] */);
+    vop.v_realloc(p_z_id, false /* interactionForceField */, true /* propagate [to mapped MO] */);
+
+    // 1. Starting vector: the eigenvector of the last estimation, or a (reproducible) random vector
+    if (not p_has_starting_vector) {
+        std::mt19937 generator (0);
+        std::uniform_real_distribution<SReal> distribution (-1, 1);
+        const auto states = this->getContext()->getObjects<BaseMechanicalState>(BaseContext::SearchDown);
+        for (auto * state : states) {
+            const auto n = static_cast<Eigen::Index>(state->getMatrixSize());
+            Algebra::EigenVector<Eigen::Matrix<SReal, Eigen::Dynamic, 1>> values (n);
+            for (Eigen::Index i = 0; i < n; ++i) {
+                values.set(i, distribution(generator));
+            }
+            unsigned int offset = 0;
+            state->copyFromBaseVector(p_q_id.getId(state), &values, offset);
+        }
+    }
+
+    // Remove the constrained directions (for example, fixed nodes) from the search space
+    mop.projectResponse(p_q_id);
+    auto norm = vop.v_norm(p_q_id);
+    if (norm <= 0) {
+        msg_warning() << "The starting vector of the power iterations is null (are all the nodes constrained?).";
+        d_critical_time_step.setValue(0);
+        d_number_of_iterations.setValue(0);
+        p_has_starting_vector = false;
+        return 0;
+    }
+    vop.v_teq(p_q_id, 1. / norm);
+
+    // 2. Power iterations
+    const auto maximum_number_of_iterations = d_maximum_number_of_iterations.getValue();
+    const auto tolerance = d_tolerance.getValue();
+    SReal lambda = 0;
+    unsigned int iteration = 0;
+    bool converged = false;
+    while (not converged and iteration < maximum_number_of_iterations) {
+        // Kq = K q  (K is in fact -K by SOFA's convention, hence the negative k factor)
+        mop.propagateDx(p_q_id);
+        mop.addMBKdx(p_Kq_id, 0 /* m */, 0 /* b */, -1 /* k */, true /* clear */, true /* accumulate */);
+        mop.projectResponse(p_Kq_id);
+
+        // z = M^-1 K q
+        mop.accFromF(p_z_id, p_Kq_id);
+        mop.projectResponse(p_z_id);
+
+        // Since |q| = 1, |z| converges to the largest eigenvalue
+        norm = vop.v_norm(p_z_id);
+        ++iteration;
+        if (norm <= 0) {
+            break;
+        }
+
+        converged = (std::abs(norm - lambda) <= tolerance * norm);
+        lambda = norm;
+
+        // q = z / |z|
+        vop.v_eq(p_q_id, p_z_id);
+        vop.v_teq(p_q_id, 1. / norm);
+    }
+
+    p_has_starting_vector = (lambda > 0);
+
+    // 3. Critical time step of the central difference scheme: 2 / w_max
+    const SReal critical_time_step = (lambda > 0) ? 2. / std::sqrt(lambda) : 0;
+    d_largest_eigenvalue.setValue(lambda);
+    d_critical_time_step.setValue(critical_time_step);
+    d_number_of_iterations.setValue(iteration);
+
+    if (lambda <= 0) {
+        msg_warning() << "Unable to estimate the largest eigenvalue of M^-1 K (is there any force field?).";
+    } else if (not converged) {
+        msg_info() << "The power iterations did not converge after " << iteration << " iterations.";
+    }
+
+    msg_info() << "Largest eigenvalue estimated to " << lambda << " in " << iteration << " iterations (critical time "
+               << "step of " << critical_time_step << ").";
+
+    return critical_time_step;
+}
+
+} // namespace SofaCaribou::ode
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <SofaCaribou/config.h>
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/core/objectmodel/BaseObject.h>
+#include <sofa/core/objectmodel/Data.h>
+#include <sofa/core/MultiVecId.h>
+DISABLE_ALL_WARNINGS_END
+
+namespace SofaCaribou::ode {
+
+/**
+ * Estimation of the stable time step of explicit time integration schemes from the largest eigenvalue of
+ * \f$\mat{M}^{-1}\mat{K}\f$.
+ *
+ * The largest eigenvalue \f$\lambda_{max} = \omega_{max}^2\f$ is found by power iterations
+ *
+ * \f{align*}{
+ *     \vect{z}_{k} &= \mat{M}^{-1} \mat{K} \vect{q}_{k} \\
+ *     \lambda_{k} &= |\vect{z}_{k}| \\
+ *     \vect{q}_{k+1} &= \frac{\vect{z}_{k}}{|\vect{z}_{k}|}
+ * \f}
+ *
+ * where the product with the stiffness matrix is computed without any assembly through the addMBKdx methods of the
+ * force fields, and the product with the inverse of the mass matrix through the accFromF method of the masses (a
+ * diagonal inversion for lumped masses). Each iteration hence costs a single force derivative evaluation. The
+ * eigenvector of the last estimation is kept and used as the starting vector of the next one, which usually
+ * converges in a handful of iterations.
+ *
+ * The critical time step of the central difference scheme is then \f$\Delta t_{crit} = \frac{2}{\omega_{max}}\f$.
+ *
+ * The estimation is done at the beginning of the time steps (every N time steps), or on demand with the estimate()
+ * method. No safety factor is applied here, the explicit ODE solver applies its own.
+ */
+class StableTimeStepEstimator : public sofa::core::objectmodel::BaseObject {
+public:
+    SOFA_CLASS(StableTimeStepEstimator, sofa::core::objectmodel::BaseObject);
+
+    template <typename T>
+    using Data = sofa::core::objectmodel::Data<T>;
+
+    CARIBOU_API
+    StableTimeStepEstimator();
+
+    CARIBOU_API
+    void init() override;
+
+    CARIBOU_API
+    void reset() override;
+
+    CARIBOU_API
+    void cleanup() override;
+
+    CARIBOU_API
+    void handleEvent(sofa::core::objectmodel::Event * event) override;
+
+    /**
+     * Estimate the largest eigenvalue of M^-1 K at the current state and update the critical time step.
+     * @return The critical time step, or zero if it could not be estimated.
+     */
+    CARIBOU_API
+    auto estimate() -> SReal;
+
+    /** Largest eigenvalue of M^-1 K found during the last estimation. */
+    auto largest_eigenvalue() const -> SReal { return d_largest_eigenvalue.getValue(); }
+
+    /** Critical time step 2 / sqrt(lambda_max) found during the last estimation (zero if it failed). */
+    auto critical_time_step() const -> SReal { return d_critical_time_step.getValue(); }
+
+    /** Number of power iterations done during the last estimation. */
+    auto number_of_iterations() const -> unsigned int { return d_number_of_iterations.getValue(); }
+
+private:
+    /// INPUTS
+    Data<unsigned int> d_update_interval;
+    Data<unsigned int> d_maximum_number_of_iterations;
+    Data<double> d_tolerance;
+
+    /// OUTPUTS
+    Data<double> d_largest_eigenvalue;
+    Data<double> d_critical_time_step;
+    Data<unsigned int> d_number_of_iterations;
+
+    /// Private members
+
+    /// Multi-vector identifier of the eigenvector found during the last estimation (starting vector of the next one)
+    sofa::core::MultiVecDerivId p_q_id;
+
+    /// Multi-vector identifiers of the temporary vectors K.q and M^-1.K.q
+    sofa::core::MultiVecDerivId p_Kq_id;
+    sofa::core::MultiVecDerivId p_z_id;
+
+    /// Whether or not the eigenvector of a previous estimation can be used as the starting vector
+    bool p_has_starting_vector = false;
+
+    /// Whether or not an estimation was done at least once
+    bool p_is_estimated = false;
+
+    /// Number of time steps since the last estimation
+    unsigned int p_number_of_steps_since_estimation = 0;
+};
+
+} // namespace SofaCaribou::ode
@@ -175,7 +175,7 @@ protected:
      * @return True if the CG converged, false otherwise.
      */
     template <typename Preconditioner>
-    bool solve(const Preconditioner & precond, const Matrix & A, const Vector & b, Vector & x);
+    bool solve(const Preconditioner & precond, const Matrix & A, const Eigen::Ref<const Vector> & b, Eigen::Ref<Vector> x);
 
     /// INPUTS
     Data<bool> d_verbose;
@@ -297,7 +297,7 @@ void ConjugateGradientSolver<EigenMatrix_t>::solve(sofa::core::behavior::MultiVe
 
 template <class EigenMatrix_t>
 template <typename Preconditioner>
-bool ConjugateGradientSolver<EigenMatrix_t>::solve(const Preconditioner & precond, const Matrix & A, const Vector & b, Vector & x) {
+bool ConjugateGradientSolver<EigenMatrix_t>::solve(const Preconditioner & precond, const Matrix & A, const Eigen::Ref<const Vector> & b, Eigen::Ref<Vector> x) {
     // Get the method parameters
     const auto & maximum_number_of_iterations = d_maximum_number_of_iterations.getValue();
     const auto & residual_tolerance_threshold = d_residual_tolerance_threshold.getValue();
@@ -461,8 +461,8 @@ bool ConjugateGradientSolver<EigenMatrix_t>::factorize() {
 
 template <class EigenMatrix_t>
 bool ConjugateGradientSolver<EigenMatrix_t>::solve(const sofa::defaulttype::BaseVector * F_, sofa::defaulttype::BaseVector *X_) {
-    const auto & F = dynamic_cast<const SofaCaribou::Algebra::EigenVector<Vector> *>(F_)->vector();
-    auto & X = dynamic_cast<SofaCaribou::Algebra::EigenVector<Vector> *>(X_)->vector();
+    const auto F = Base::eigen_vector(F_);
+    auto X = Base::eigen_vector(X_);
     const PreconditioningMethod preconditioning_method = get_preconditioning_method_from_string(d_preconditioning_method.getValue().getSelectedItem());
 
     bool converged = true;
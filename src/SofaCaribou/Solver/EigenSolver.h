@@ -4,14 +4,18 @@
 #include <SofaCaribou/Algebra/EigenMatrix.h>
 #include <SofaCaribou/Algebra/EigenVector.h>
 #include <SofaCaribou/Solver/LinearSolver.h>
+#include <SofaCaribou/Solver/MechanicalGraphSignature.h>
 
 DISABLE_ALL_WARNINGS_BEGIN
 #include <sofa/version.h>
 #include <sofa/core/MechanicalParams.h>
+#include <sofa/core/behavior/BaseMechanicalState.h>
 #include <sofa/core/behavior/LinearSolver.h>
 #include <SofaBaseLinearSolver/DefaultMultiMatrixAccessor.h>
 DISABLE_ALL_WARNINGS_END
 
+#include <optional>
+
 #if (defined(SOFA_VERSION) && SOFA_VERSION < 201200)
 namespace sofa {
 using Size = unsigned int;
@@ -38,16 +42,20 @@ public:
     using Matrix = EigenMatrix_t;
     using Vector = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
 
-    EigenSolver() = default;
+    EigenSolver();
 
     /**
      * Assemble the system matrix A = (mM + bB + kK).
      *
+     * The matrix accessor is rebuilt at every assembly, since its mapped matrices are not zeroed between two
+     * assemblies. Only the layout of the system (whether its vectors can be mapped) is kept, and updated when the size
+     * of a mechanical state or the revision of a topology changed since the last assembly.
+     *
      * @param mparams Mechanical parameters containing the m, b and k factors.
      * @return The matrix accessor containing the lists of top level mechanical objects, a pointer for
      * their matrix and a vector of mappings for mapped mechanical objects.
      */
-    auto assemble (const sofa::core::MechanicalParams* mparams) -> sofa::component::linearsolver::DefaultMultiMatrixAccessor;
+    auto assemble (const sofa::core::MechanicalParams* mparams) -> const sofa::component::linearsolver::DefaultMultiMatrixAccessor &;
 
     /**
      * Reset the complete system (A, x and b are cleared).
@@ -71,6 +79,8 @@ public:
      * Gives the identifier of the right-hand side vector b. This identifier will be used to find the actual vector
      * in the mechanical objects of the system. The complete dense vector is accumulated from the mechanical objects
      * found in the graph subtree of the current context.
+     *
+     * When the system contains a single top level mechanical object, its vector is directly mapped without any copy.
      */
     void setSystemRHVector(sofa::core::MultiVecDerivId b_id) override;
 
@@ -78,6 +88,9 @@ public:
      * Gives the identifier of the left-hand side vector x. This identifier will be used to find the actual vector
      * in the mechanical objects of the system. The complete dense vector is accumulated from the mechanical objects
      * found in the graph subtree of the current context.
+     *
+     * When the system contains a single top level mechanical object, its vector is directly mapped without any copy,
+     * and the solution is written in place.
      */
     void setSystemLHVector(sofa::core::MultiVecDerivId x_id) override;
 
@@ -93,6 +106,13 @@ public:
     /** Explicitly states if this matrix is symmetric. */
     inline virtual void set_symmetric(bool is_symmetric) { p_is_symmetric = is_symmetric; }
 
+    /**
+     * States if the sparsity pattern of the system matrix is locked after its first assembly. When it is true, the
+     * following assemblies will accumulate the coefficients directly into the existing sparse storage instead of
+     * building and sorting a new list of triplets.
+     */
+    inline auto pattern_locked() const -> bool {return d_lock_pattern.getValue();}
+
     /** Get a readonly reference to the mechanical parameters */
     auto mechanical_params() const -> const sofa::core::MechanicalParams & { return p_mechanical_params; }
 
@@ -140,7 +160,32 @@ protected:
     void set_system_matrix(const sofa::defaulttype::BaseMatrix * A) override {
         p_A_ptr = dynamic_cast<const SofaCaribou::Algebra::EigenMatrix<Matrix> *>(A);
     }
+
+    /**
+     * Get an Eigen view of a vector that was either created by this solver, or that maps the vector of
+     * a mechanical object.
+     *
+     * @throws std::runtime_error if the vector is not an Eigen vector of this solver's scalar type.
+     */
+    static auto eigen_vector(const sofa::defaulttype::BaseVector * v) -> Eigen::Map<const Vector>;
+
+    /** @copydoc eigen_vector(const sofa::defaulttype::BaseVector *) */
+    static auto eigen_vector(sofa::defaulttype::BaseVector * v) -> Eigen::Map<Vector>;
+
 private:
+    /// Vector wrapper around the storage of a mechanical object vector.
+    using MappedVector = SofaCaribou::Algebra::EigenVector<Eigen::Map<Vector>>;
+
+    /**
+     * Map the vector identified by vec_id of the single top level mechanical object of the system.
+     *
+     * @param vec_id The identifier of the vector to map.
+     * @param mapped Will contain the mapped vector on success, and will be emptied otherwise.
+     * @return False if the system has more than one top level mechanical object, or if the storage of its vector can't
+     * be seen as a contiguous array of scalars. In this case, the vector must be copied using the matrix accessor.
+     */
+    bool map_mechanical_vector(const sofa::core::MultiVecDerivId & vec_id, std::optional<MappedVector> & mapped) const;
+
     /**
      * @see SofaCaribou::solver::LinearSolver::create_new_matrix
      */
@@ -149,6 +194,7 @@ private:
         if (symmetric()) {
             matrix->set_symmetric(symmetric());
         }
+        matrix->set_pattern_locked(pattern_locked());
         return matrix;
     }
 
@@ -160,6 +206,9 @@ private:
     }
 
 private:
+    /// INPUTS
+    sofa::core::objectmodel::Data<bool> d_lock_pattern;
+
     /// Private members
 
     /// The mechanical parameters containing the m, b and k coefficients.
@@ -168,6 +217,9 @@ private:
     /// Accessor used to determine the index of each mechanical object matrix and vector in the global system.
     sofa::component::linearsolver::DefaultMultiMatrixAccessor p_accessor;
 
+    /// Signature of the mechanical graph at the time the layout of the system was computed
+    MechanicalGraphSignature p_mechanical_graph_signature;
+
     /// The identifier of the b vector
     sofa::core::MultiVecDerivId p_b_id;
 
@@ -188,6 +240,15 @@ private:
     /// Global system right-hand side vector
     SofaCaribou::Algebra::EigenVector<Vector> p_b;
 
+    /// Solution vector mapped from the mechanical object (used instead of p_x when it is set)
+    std::optional<MappedVector> p_x_map;
+
+    /// Right-hand side vector mapped from the mechanical object (used instead of p_b when it is set)
+    std::optional<MappedVector> p_b_map;
+
+    /// The top level mechanical state of the system when it is the only one, nullptr otherwise
+    sofa::core::behavior::BaseMechanicalState * p_single_mechanical_state = nullptr;
+
     /// True if the solver has successfully factorize the system matrix
     bool p_A_is_factorized {};
 
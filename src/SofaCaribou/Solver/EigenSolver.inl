@@ -6,6 +6,8 @@
 #include <SofaCaribou/Visitor/ConstrainGlobalMatrix.h>
 
 DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/core/behavior/MechanicalState.h>
+#include <sofa/defaulttype/VecTypes.h>
 #include <sofa/helper/AdvancedTimer.h>
 #include <sofa/simulation/MechanicalOperations.h>
 #include <sofa/simulation/VectorOperations.h>
@@ -19,19 +21,67 @@ DISABLE_ALL_WARNINGS_END
 
 namespace SofaCaribou::solver {
 
+namespace {
+// Get a pointer to the scalars of the vector vec_id of a mechanical state of type DataTypes. The pointer is null if the
+// state is not of this type, or if its vector can't be seen as a contiguous array of Scalar.
+template <typename DataTypes, typename Scalar>
+auto mechanical_vector_data([[maybe_unused]] sofa::core::behavior::BaseMechanicalState * state,
+                            [[maybe_unused]] const sofa::core::VecDerivId & vec_id,
+                            [[maybe_unused]] Eigen::Index & size) -> Scalar * {
+    using Real = typename DataTypes::Real;
+    using Deriv = typename DataTypes::Deriv;
+
+    if constexpr (std::is_same_v<Real, Scalar> and sizeof(Deriv) == DataTypes::deriv_total_size*sizeof(Real)) {
+        auto * mechanical_state = dynamic_cast<sofa::core::behavior::MechanicalState<DataTypes> *>(state);
+        if (not mechanical_state) {
+            return nullptr;
+        }
+
+        auto * data = mechanical_state->write(vec_id);
+        if (not data) {
+            return nullptr;
+        }
+
+        auto & vector = *data->beginEdit();
+        Scalar * values = vector.empty() ? nullptr : vector[0].ptr();
+        size = static_cast<Eigen::Index>(vector.size()*DataTypes::deriv_total_size);
+        data->endEdit();
+
+        return values;
+    } else {
+        return nullptr;
+    }
+}
+}
+
+template <class EigenMatrix_t>
+EigenSolver<EigenMatrix_t>::EigenSolver()
+: d_lock_pattern(initData(&d_lock_pattern,
+    false,
+    "lock_pattern",
+    "Keep the sparsity pattern of the system matrix from its first assembly. Subsequent assemblies only zero "
+    "the values and accumulate the coefficients directly into the existing sparse storage, instead of "
+    "building and sorting a new list of triplets. Only use this option when the pattern of the system matrix "
+    "does not shrink during the simulation (for example, no topological changes)."))
+{}
+
 template <class EigenMatrix_t>
 void EigenSolver<EigenMatrix_t>::resetSystem() {
     p_A.resize(0, 0);
     p_x.resize(0);
     p_b.resize(0);
     p_accessor.clear();
+    p_mechanical_graph_signature.clear();
+    p_single_mechanical_state = nullptr;
+    p_x_map.reset();
+    p_b_map.reset();
 }
 
 template <class EigenMatrix_t>
-auto EigenSolver<EigenMatrix_t>::assemble (const sofa::core::MechanicalParams* mparams) -> sofa::component::linearsolver::DefaultMultiMatrixAccessor
+auto EigenSolver<EigenMatrix_t>::assemble (const sofa::core::MechanicalParams* mparams) -> const sofa::component::linearsolver::DefaultMultiMatrixAccessor &
 {
     using Timer = sofa::helper::AdvancedTimer;
-    sofa::component::linearsolver::DefaultMultiMatrixAccessor accessor;
+    auto & accessor = p_accessor;
 
     // Step 1. Preparation stage
     //         This stage go down on the sub-graph and gather the top-level mechanical objects (mechanical objects that
@@ -46,12 +96,15 @@ auto EigenSolver<EigenMatrix_t>::assemble (const sofa::core::MechanicalParams* m
 
     // Step 1.1 Get dimension of each top level mechanical states using BaseMechanicalState::getMatrixSize(),
     //          and accumulate mechanical objects and mapping matrices
+    //
+    //          The accessor is rebuilt at every assembly: the mapped and interaction matrices it owns are never zeroed,
+    //          hence reusing them would accumulate the contributions of the mapped states of the previous assemblies.
     Timer::stepBegin("Dimension");
+    accessor.clear();
     mops.getMatrixDimension(nullptr, nullptr, &accessor);
-    const auto n = static_cast<sofa::Index>(accessor.getGlobalDimension());
     Timer::stepEnd("Dimension");
 
-    // Step 2.2 Does nothing more than to accumulate from the previous step a list of
+    // Step 1.2 Does nothing more than to accumulate from the previous step a list of
     //          "MatrixRef = <MechanicalState*, MatrixIndex>" where MatrixIndex is the
     //          (i,i) position of the given top level MechanicalState* inside the global
     //          system matrix. This global matrix hence contains one sub-matrix per top
@@ -60,7 +113,29 @@ auto EigenSolver<EigenMatrix_t>::assemble (const sofa::core::MechanicalParams* m
     accessor.setupMatrices();
     Timer::stepEnd("SetupMatrixIndices");
 
+    // Step 1.3 Find out if the system has a single top level mechanical state, in which case its vectors can be
+    //          directly mapped instead of being copied into the global system vectors. This layout is kept from the
+    //          previous assembly unless the size of a mechanical state or the revision of a topology changed.
+    if (not p_mechanical_graph_signature.is_up_to_date()) {
+        const auto global_dimension = static_cast<sofa::Index>(accessor.getGlobalDimension());
+        std::size_t number_of_top_level_states = 0;
+        p_single_mechanical_state = nullptr;
+        for (auto * state : context->template getObjects<sofa::core::behavior::BaseMechanicalState>(sofa::core::objectmodel::BaseContext::SearchDown)) {
+            if (accessor.getGlobalOffset(state) >= 0) {
+                p_single_mechanical_state = state;
+                ++number_of_top_level_states;
+            }
+        }
+        if (number_of_top_level_states != 1 or static_cast<sofa::Index>(p_single_mechanical_state->getMatrixSize()) != global_dimension) {
+            p_single_mechanical_state = nullptr;
+        }
+
+        p_mechanical_graph_signature.capture(context);
+    }
+    const auto n = static_cast<sofa::Index>(accessor.getGlobalDimension());
+
     Timer::stepBegin("Clear");
+    p_A.set_pattern_locked(pattern_locked()); // Keeps the sparsity pattern when the dimensions are unchanged
     p_A.resize(n, n);
     p_A.set_symmetric(symmetric()); // Enables some optimization when the system matrix is symmetric
     accessor.setGlobalMatrix(&p_A);
@@ -124,7 +199,7 @@ void EigenSolver<EigenMatrix_t>::setSystemMBKMatrix(const sofa::core::Mechanical
 
     // Step 1. Assemble the system matrix
     auto previous_dimension = p_A.rowSize();
-    p_accessor = assemble(mparams);
+    assemble(mparams);
     auto current_dimension = p_A.rowSize();
 
     // Step 2. Let the solver analyse the matrix
@@ -160,9 +235,12 @@ void EigenSolver<EigenMatrix_t>::setSystemRHVector(sofa::core::MultiVecDerivId b
     sofa::simulation::common::MechanicalOperations mop(&p_mechanical_params, this->getContext());
     p_b_id = b_id;
 
-    // Copy the vectors of the mechanical objects into a global eigen vector.
-    p_b.resize(p_A.rowSize());
-    mop.multiVector2BaseVector(p_b_id, &p_b, &p_accessor);
+    // Map the vector of the mechanical object when it is the only one of the system. Otherwise, copy the vectors of
+    // the mechanical objects into a global eigen vector.
+    if (not map_mechanical_vector(p_b_id, p_b_map)) {
+        p_b.resize(p_A.rowSize());
+        mop.multiVector2BaseVector(p_b_id, &p_b, &p_accessor);
+    }
 
     Timer::stepEnd("EigenSolver::AssembleResidualVector");
 }
@@ -179,9 +257,12 @@ void EigenSolver<EigenMatrix_t>::setSystemLHVector(sofa::core::MultiVecDerivId x
     p_x_id = x_id;
 
 
-    // Copy the vectors of the mechanical objects into a global eigen vector.
-    p_x.resize(p_A.rowSize());
-    mop.multiVector2BaseVector(p_x_id, &p_x, &p_accessor);
+    // Map the vector of the mechanical object when it is the only one of the system. Otherwise, copy the vectors of
+    // the mechanical objects into a global eigen vector.
+    if (not map_mechanical_vector(p_x_id, p_x_map)) {
+        p_x.resize(p_A.rowSize());
+        mop.multiVector2BaseVector(p_x_id, &p_x, &p_accessor);
+    }
 
     Timer::stepEnd("EigenSolver::AssembleSolutionVector");
 }
@@ -195,15 +276,70 @@ void EigenSolver<EigenMatrix_t>::solveSystem() {
     sofa::simulation::common::MechanicalOperations mop( &p_mechanical_params, this->getContext() );
 
     Timer::stepBegin("EigenSolver::solve");
-    bool success = this->solve(&p_b, &p_x);
-    if (success) {
-        // Copy the solution into the mechanical objects of the current context sub-graph.
+    const sofa::defaulttype::BaseVector * b = p_b_map ? static_cast<const sofa::defaulttype::BaseVector *>(&(*p_b_map)) : &p_b;
+    sofa::defaulttype::BaseVector * x = p_x_map ? static_cast<sofa::defaulttype::BaseVector *>(&(*p_x_map)) : &p_x;
+    bool success = this->solve(b, x);
+    if (success and not p_x_map) {
+        // Copy the solution into the mechanical objects of the current context sub-graph. When the solution vector
+        // is mapped from the mechanical object, it has already been written in place.
         mop.baseVector2MultiVector(&p_x, p_x_id, &p_accessor);
     }
 
     Timer::stepEnd("EigenSolver::solve");
 }
 
+template <class EigenMatrix_t>
+bool EigenSolver<EigenMatrix_t>::map_mechanical_vector(const sofa::core::MultiVecDerivId & vec_id, std::optional<MappedVector> & mapped) const {
+    mapped.reset();
+    if (not p_single_mechanical_state) {
+        return false;
+    }
+
+    const auto id = vec_id.getId(p_single_mechanical_state);
+    Eigen::Index size = 0;
+    Scalar * values = mechanical_vector_data<sofa::defaulttype::Vec3Types, Scalar>(p_single_mechanical_state, id, size);
+    if (not values) {
+        values = mechanical_vector_data<sofa::defaulttype::Vec2Types, Scalar>(p_single_mechanical_state, id, size);
+    }
+    if (not values) {
+        values = mechanical_vector_data<sofa::defaulttype::Vec1Types, Scalar>(p_single_mechanical_state, id, size);
+    }
+
+    if (not values or size != static_cast<Eigen::Index>(p_A.rowSize())) {
+        return false;
+    }
+
+    Eigen::Map<Vector> vector (values, size);
+    mapped.emplace(vector);
+    return true;
+}
+
+template <class EigenMatrix_t>
+auto EigenSolver<EigenMatrix_t>::eigen_vector(const sofa::defaulttype::BaseVector * v) -> Eigen::Map<const Vector> {
+    if (const auto * vector = dynamic_cast<const SofaCaribou::Algebra::EigenVector<Vector> *>(v)) {
+        return Eigen::Map<const Vector>(vector->vector().data(), vector->vector().size());
+    }
+
+    if (const auto * vector = dynamic_cast<const MappedVector *>(v)) {
+        return Eigen::Map<const Vector>(vector->vector().data(), vector->vector().size());
+    }
+
+    throw std::runtime_error("Tried to use an incompatible vector (not an Eigen vector).");
+}
+
+template <class EigenMatrix_t>
+auto EigenSolver<EigenMatrix_t>::eigen_vector(sofa::defaulttype::BaseVector * v) -> Eigen::Map<Vector> {
+    if (auto * vector = dynamic_cast<SofaCaribou::Algebra::EigenVector<Vector> *>(v)) {
+        return Eigen::Map<Vector>(vector->vector().data(), vector->vector().size());
+    }
+
+    if (auto * vector = dynamic_cast<MappedVector *>(v)) {
+        return Eigen::Map<Vector>(vector->vector().data(), vector->vector().size());
+    }
+
+    throw std::runtime_error("Tried to use an incompatible vector (not an Eigen vector).");
+}
+
 template<typename EigenMatrix_t>
 std::string EigenSolver<EigenMatrix_t>::GetCustomTemplateName() {
     std::string namestring;
@@ -65,10 +65,10 @@ bool LLTSolver<EigenSolver_t>::factorize() {
 template<class EigenSolver_t>
 bool LLTSolver<EigenSolver_t>::solve(const sofa::defaulttype::BaseVector * F,
                                       sofa::defaulttype::BaseVector *X) {
-    auto F_ = dynamic_cast<const SofaCaribou::Algebra::EigenVector<Vector> *>(F);
-    auto X_ = dynamic_cast<SofaCaribou::Algebra::EigenVector<Vector> *>(X);
+    auto F_ = Base::eigen_vector(F);
+    auto X_ = Base::eigen_vector(X);
 
-    X_->vector() = p_solver.solve(F_->vector());
+    X_ = p_solver.solve(F_);
     return (p_solver.info() == Eigen::Success);
 }
 
@@ -0,0 +1,49 @@
+#include <SofaCaribou/Solver/MechanicalGraphSignature.h>
+
+namespace SofaCaribou::solver {
+
+using sofa::core::behavior::BaseMechanicalState;
+using sofa::core::objectmodel::BaseContext;
+using sofa::core::topology::BaseMeshTopology;
+
+void MechanicalGraphSignature::capture(BaseContext * context) {
+    clear();
+
+    for (auto * state : context->template getObjects<BaseMechanicalState>(BaseContext::SearchDown)) {
+        p_mechanical_states.emplace_back(state, static_cast<sofa::Size>(state->getSize()));
+    }
+
+    for (auto * topology : context->template getObjects<BaseMeshTopology>(BaseContext::SearchDown)) {
+        p_topologies.emplace_back(topology, topology->getRevision());
+    }
+
+    p_is_captured = true;
+}
+
+void MechanicalGraphSignature::clear() {
+    p_mechanical_states.clear();
+    p_topologies.clear();
+    p_is_captured = false;
+}
+
+bool MechanicalGraphSignature::is_up_to_date() const {
+    if (not p_is_captured) {
+        return false;
+    }
+
+    for (const auto & [state, size] : p_mechanical_states) {
+        if (static_cast<sofa::Size>(state->getSize()) != size) {
+            return false;
+        }
+    }
+
+    for (const auto & [topology, revision] : p_topologies) {
+        if (topology->getRevision() != revision) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace SofaCaribou::solver
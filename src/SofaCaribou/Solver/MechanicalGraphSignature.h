@@ -0,0 +1,64 @@
+#pragma once
+
+#include <SofaCaribou/config.h>
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/version.h>
+#include <sofa/core/behavior/BaseMechanicalState.h>
+#include <sofa/core/objectmodel/BaseContext.h>
+#include <sofa/core/topology/BaseMeshTopology.h>
+DISABLE_ALL_WARNINGS_END
+
+#include <utility>
+#include <vector>
+
+#if (defined(SOFA_VERSION) && SOFA_VERSION < 201200)
+namespace sofa { using Size = unsigned int; }
+#endif
+
+namespace SofaCaribou::solver {
+
+/**
+ * Snapshot of the mechanical states and topologies found in the sub-graph of a context.
+ *
+ * The layout of a global system (its dimension, and the offset of every top level mechanical state inside of it) only
+ * changes when the number of nodes of a mechanical state changes, which usually follows a topological change. Hence,
+ * instead of walking down the scene graph with mechanical visitors at every assembly, a solver can capture this
+ * signature once, and only recompute the layout of its system when the signature is not up to date anymore.
+ *
+ * Checking the signature is cheap: it only compares the current size of the captured mechanical states, and the
+ * current revision of the captured topologies, with the ones they had when captured.
+ *
+ * @note Mechanical states and topologies that are added to (or removed from) the scene graph after the capture are
+ *       not detected. The solvers using this signature must clear it when reinitialized.
+ */
+class MechanicalGraphSignature {
+public:
+    /** Capture the sizes of the mechanical states and the revisions of the topologies found under the given context. */
+    CARIBOU_API
+    void capture(sofa::core::objectmodel::BaseContext * context);
+
+    /** Forget the captured signature. The next call to is_up_to_date() will return false. */
+    CARIBOU_API
+    void clear();
+
+    /**
+     * True if a signature has been captured, and the mechanical states and topologies captured have not changed
+     * since then.
+     */
+    [[nodiscard]]
+    CARIBOU_API
+    bool is_up_to_date() const;
+
+private:
+    /// Mechanical states (top level and mapped) with their number of nodes at the time of the capture
+    std::vector<std::pair<sofa::core::behavior::BaseMechanicalState::SPtr, sofa::Size>> p_mechanical_states;
+
+    /// Topologies with their revision number at the time of the capture
+    std::vector<std::pair<sofa::core::topology::BaseMeshTopology::SPtr, int>> p_topologies;
+
+    /// Whether or not a signature has been captured
+    bool p_is_captured = false;
+};
+
+} // namespace SofaCaribou::solver
@@ -0,0 +1,57 @@
+#include <SofaCaribou/Visitor/ComputeResidualForce.h>
+#include <SofaCaribou/Ode/CombinedMBKdxProvider.h>
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/core/BaseMapping.h>
+#include <sofa/core/behavior/BaseForceField.h>
+#include <sofa/core/behavior/BaseMechanicalState.h>
+DISABLE_ALL_WARNINGS_END
+
+namespace SofaCaribou::visitor {
+using namespace sofa::core;
+
+auto ComputeResidualForce::fwdMechanicalState(sofa::simulation::Node* /*node*/, behavior::BaseMechanicalState* mm) -> Result {
+    // Same as the MechanicalComputeForceVisitor: start from the external forces of the mechanical state
+    mm->resetForce(this->mparams, p_f_id.getId(mm));
+    mm->accumulateForce(this->mparams, p_f_id.getId(mm));
+    return RESULT_CONTINUE;
+}
+
+auto ComputeResidualForce::fwdMappedMechanicalState(sofa::simulation::Node* /*node*/, behavior::BaseMechanicalState* mm) -> Result {
+    // Same as the MechanicalComputeForceVisitor: start from the external forces of the mechanical state
+    mm->resetForce(this->mparams, p_f_id.getId(mm));
+    mm->accumulateForce(this->mparams, p_f_id.getId(mm));
+    return RESULT_CONTINUE;
+}
+
+auto ComputeResidualForce::fwdForceField(sofa::simulation::Node* /*node*/, behavior::BaseForceField* ff) -> Result {
+    // Compliant force fields are neglected, as done by the MechanicalComputeForceVisitor
+    if (not ff->isCompliance.getValue()) {
+        ff->addForce(this->mparams, p_f_id);
+    }
+
+    if (auto * provider = dynamic_cast<ode::CombinedMBKdxProvider *>(ff)) {
+        provider->add_combined_MBKdx(p_mparams_1, p_mparams_2, p_f_id);
+    } else {
+        ff->addMBKdx(p_mparams_1, p_f_id);
+        ff->addMBKdx(p_mparams_2, p_f_id);
+    }
+
+    return RESULT_CONTINUE;
+}
+
+void ComputeResidualForce::bwdMechanicalMapping(sofa::simulation::Node* /*node*/, BaseMapping* map) {
+    // The mapping is linear with respect to the forces, hence the forces and the two MBK products of the mapped
+    // mechanical object can be accumulated into its parent at once
+    map->applyJT(this->mparams, p_f_id, p_f_id);
+
+    // Geometric stiffness of non-linear mappings
+    if (p_mparams_1->kFactor() != 0) {
+        map->applyDJT(p_mparams_1, p_f_id, p_f_id);
+    }
+    if (p_mparams_2->kFactor() != 0) {
+        map->applyDJT(p_mparams_2, p_f_id, p_f_id);
+    }
+}
+
+} // namespace SofaCaribou::visitor
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <SofaCaribou/config.h>
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/simulation/MechanicalVisitor.h>
+DISABLE_ALL_WARNINGS_END
+
+namespace SofaCaribou::visitor {
+
+/**
+ * Compute, in a single traversal of the scene graph, the residual force vector of implicit time integration schemes
+ *
+ *   f = F(x, v) + (m1 M + b1 B + k1 K) dx1 + (m2 M + b2 B + k2 K) dx2
+ *
+ * where the factors and the vectors dx1 and dx2 are taken from two sets of mechanical parameters.
+ *
+ * This visitor will, in order:
+ *   1. Reset the force vector f of every mechanical objects (mapped or not), and add their external forces to it.
+ *   2. Call `BaseForceField::addForce(mparams, f)` on every forcefields, and accumulate the two MBK products. For
+ *      components implementing the CombinedMBKdxProvider interface (for example, the HyperelasticForcefield and
+ *      the CaribouMass), `add_combined_MBKdx` is called to compute both products in a single pass. Otherwise,
+ *      `BaseForceField::addMBKdx` is called once with each set of mechanical parameters.
+ *   3. Go up from the leaves calling `applyJT` on every mechanical mappings (and `applyDJT` with each set of
+ *      mechanical parameters) to accumulate the forces of mapped mechanical objects into their parents.
+ *
+ * This replaces the two MechanicalResetForceVisitor, the MechanicalComputeForceVisitor and the two
+ * MechanicalAddMBKdxVisitor traversals otherwise needed.
+ */
+class ComputeResidualForce : public sofa::simulation::MechanicalVisitor {
+    using Base = sofa::simulation::MechanicalVisitor;
+    using MechanicalParams = sofa::core::MechanicalParams;
+    using MultiVecDerivId = sofa::core::MultiVecDerivId;
+public:
+    /**
+     * @param mparams Mechanical parameters of the force computation (positions, velocities, etc.)
+     * @param f_id Identifier of the residual force vector
+     * @param mparams_1 Mechanical parameters holding the factors m1, b1, k1 and the identifier of the vector dx1
+     * @param mparams_2 Mechanical parameters holding the factors m2, b2, k2 and the identifier of the vector dx2
+     */
+    ComputeResidualForce(const MechanicalParams* mparams, MultiVecDerivId f_id,
+                         const MechanicalParams* mparams_1, const MechanicalParams* mparams_2)
+    : Base(mparams), p_f_id(f_id), p_mparams_1(mparams_1), p_mparams_2(mparams_2) {}
+
+    CARIBOU_API
+    Result fwdMechanicalState(sofa::simulation::Node* node, sofa::core::behavior::BaseMechanicalState* mm) override;
+
+    CARIBOU_API
+    Result fwdMappedMechanicalState(sofa::simulation::Node* node, sofa::core::behavior::BaseMechanicalState* mm) override;
+
+    CARIBOU_API
+    Result fwdForceField(sofa::simulation::Node* node, sofa::core::behavior::BaseForceField* ff) override;
+
+    CARIBOU_API
+    void bwdMechanicalMapping(sofa::simulation::Node* node, sofa::core::BaseMapping* map) override;
+
+    const char* getClassName() const override { return "ComputeResidualForce"; }
+private:
+    MultiVecDerivId p_f_id;
+    const MechanicalParams * p_mparams_1;
+    const MechanicalParams * p_mparams_2;
+};
+
+} // namespace SofaCaribou::visitor
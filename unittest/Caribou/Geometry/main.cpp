@@ -59,6 +59,7 @@ template <typename Derived>
 #include "test_quad.h"
 #include "test_tetrahedron.h"
 #include "test_hexahedron.h"
+#include "test_element_batch.h"
 
 int main(int argc, char **argv) {
     testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <Caribou/constants.h>
+#include <Caribou/Geometry/ElementBatch.h>
+#include <Caribou/Geometry/Segment.h>
+#include <Caribou/Geometry/Triangle.h>
+#include <Caribou/Geometry/Quad.h>
+#include <Caribou/Geometry/Tetrahedron.h>
+#include <Caribou/Geometry/Hexahedron.h>
+#include <Caribou/Geometry/RectangularHexahedron.h>
+
+// Compare the quantities evaluated by an ElementBatch with the ones of every single element
+template <typename Element, INTEGER_TYPE BatchSize>
+void test_element_batch(const INTEGER_TYPE & number_of_elements) {
+    using namespace caribou::geometry;
+    using Batch = ElementBatch<Element, BatchSize>;
+    constexpr auto Dimension = Batch::Dimension;
+    constexpr auto CanonicalDimension = Batch::CanonicalDimension;
+    constexpr auto NumberOfNodes = Batch::NumberOfNodes;
+
+    // Distorted copies of the canonical element
+    std::vector<Element> elements;
+    Batch batch;
+    for (INTEGER_TYPE k = 0; k < number_of_elements; ++k) {
+        auto nodes = Batch::reference_element().nodes().eval();
+        for (Eigen::Index n = 0; n < nodes.rows(); ++n) {
+            for (Eigen::Index i = 0; i < nodes.cols(); ++i) {
+                nodes(n, i) = (1 + 0.1*k)*nodes(n, i) + 0.1*std::sin(1. + k + 3.*n + 7.*i) + k;
+            }
+        }
+        elements.emplace_back(nodes);
+        batch.push_back(elements.back());
+    }
+    EXPECT_EQ(batch.size(), number_of_elements);
+
+    for (const auto & gauss_node : Batch::reference_element().gauss_nodes()) {
+        const auto & xi = gauss_node.position;
+        typename Batch::Lanes detJ;
+        typename Batch::template BatchMatrix<NumberOfNodes, Dimension> dN_dx;
+        batch.evaluate(xi, detJ, dN_dx);
+        const auto J = batch.jacobians(xi);
+        const auto J_inv = Batch::inverses(J);
+
+        for (INTEGER_TYPE k = 0; k < number_of_elements; ++k) {
+            const auto & e = elements[static_cast<std::size_t>(k)];
+            const auto expected_J = e.jacobian(xi);
+            const auto expected_J_inv = e.inverse_jacobian(xi);
+            FLOATING_POINT_TYPE expected_detJ;
+            if constexpr (Dimension == CanonicalDimension) {
+                expected_detJ = expected_J.determinant();
+            } else {
+                expected_detJ = std::sqrt((expected_J.transpose()*expected_J).determinant());
+            }
+            const Eigen::Matrix<FLOATING_POINT_TYPE, NumberOfNodes, Dimension> expected_dN_dx = e.dL(xi) * expected_J_inv;
+
+            EXPECT_MATRIX_NEAR((Batch::template matrix_of<Dimension, CanonicalDimension>(J, k)), expected_J, 1e-10);
+            EXPECT_MATRIX_NEAR((Batch::template matrix_of<CanonicalDimension, Dimension>(J_inv, k)), expected_J_inv, 1e-10);
+            EXPECT_NEAR(detJ[k], expected_detJ, 1e-10);
+            EXPECT_MATRIX_NEAR((Batch::template matrix_of<NumberOfNodes, Dimension>(dN_dx, k)), expected_dN_dx, 1e-10);
+        }
+
+        // The lanes not used hold the first element
+        for (INTEGER_TYPE k = number_of_elements; k < BatchSize; ++k) {
+            EXPECT_DOUBLE_EQ(detJ[k], detJ[0]);
+        }
+    }
+
+    batch.clear();
+    EXPECT_EQ(batch.size(), 0);
+}
+
+TEST(ElementBatch, Batches) {
+    using namespace caribou;
+    using namespace caribou::geometry;
+
+    // Manifold elements
+    test_element_batch<Segment<3, Linear>, 4>(4);
+    test_element_batch<Triangle<3, Linear>, 8>(5);
+    test_element_batch<Triangle<3, Quadratic>, 8>(8);
+    test_element_batch<Quad<3, Linear>, 8>(3);
+
+    // Volumetric elements
+    test_element_batch<Segment<1, Quadratic>, 4>(3);
+    test_element_batch<Triangle<2, Linear>, 4>(4);
+    test_element_batch<Quad<2, Quadratic>, 8>(7);
+    test_element_batch<Tetrahedron<Linear>, 16>(16);
+    test_element_batch<Tetrahedron<Quadratic>, 8>(6);
+    test_element_batch<Hexahedron<Linear>, 8>(8);
+    test_element_batch<Hexahedron<Quadratic>, 16>(11);
+}
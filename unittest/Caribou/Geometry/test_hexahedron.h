@@ -117,6 +117,15 @@ TEST(Hexahedron, Linear) {
                 ASSERT_FALSE(h.contains_local(p, epsilon)) <<
                 "Local point [" << p[0] << ", " << p[1] << ", " << p[2] << "] is found inside the element, but it should be outside.";
             }
+
+            // Clamping the local coordinates onto the element
+            for (const auto & p : inside_points) {
+                EXPECT_MATRIX_NEAR(h.clamped_local_coordinates(p), p, epsilon);
+            }
+            for (const auto & p : outside_points) {
+                EXPECT_TRUE(h.contains_local(h.clamped_local_coordinates(p), epsilon));
+            }
+            EXPECT_MATRIX_NEAR(h.clamped_local_coordinates(LocalCoordinates(1.5, -2, 0.3)), LocalCoordinates(1, -1, 0.3), 1e-15);
         }
 
         // Integration
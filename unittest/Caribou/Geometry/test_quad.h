@@ -542,6 +542,16 @@ TEST(Quad, RectangularLinear) {
             EXPECT_MATRIX_NEAR(q.center(), center, 1e-10);
             EXPECT_MATRIX_NEAR(q.frame({0, 0}), R, 1e-10);
         }
+
+        // Closed-form inverse transformation
+        {
+            static_assert(geometry::element_is_affine_v<RectangularQuad>);
+            static_assert(not geometry::element_is_affine_v<Quad>);
+            RectangularQuad q(center, H, R);
+            for (const RectangularQuad::LocalCoordinates & x : {RectangularQuad::LocalCoordinates(0.3, -0.7), RectangularQuad::LocalCoordinates(1.5, 0.2)}) {
+                EXPECT_MATRIX_NEAR(q.local_coordinates(q.world_coordinates(x)), x, 1e-10);
+            }
+        }
     }
 
     // 3D
@@ -145,6 +145,11 @@ TEST(Segment, Linear) {
         EXPECT_DOUBLE_EQ(segment.center()[1], center_node[1]);
         EXPECT_DOUBLE_EQ(segment.center()[2], center_node[2]);
 
+        // Inverse transformation
+        for (const auto & gauss_node : segment.gauss_nodes()) {
+            EXPECT_MATRIX_NEAR(gauss_node.position, segment.local_coordinates(segment.world_coordinates(gauss_node.position)), 1e-5);
+        }
+
         // Interpolation
         Eigen::Matrix<FLOATING_POINT_TYPE, 2, 1> values (p1(segment.node(0)), p1(segment.node(1)));
         for (const auto & gauss_node : segment.gauss_nodes()) {
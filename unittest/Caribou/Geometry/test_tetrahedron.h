@@ -33,6 +33,14 @@ TEST(Tetrahedron, Linear) {
             EXPECT_MATRIX_NEAR(gauss_node.position, t.local_coordinates(t.world_coordinates(gauss_node.position)), 1e-5);
         }
 
+        // Closed-form inverse transformation (affine element), same as the Newton-Raphson iterations
+        static_assert(caribou::geometry::element_is_affine_v<Tetrahedron>);
+        for (const LocalCoordinates & x : {LocalCoordinates(0.1, 0.2, 0.3), LocalCoordinates(0.8, -0.4, 1.2)}) {
+            const WorldCoordinates p = t.world_coordinates(x);
+            EXPECT_MATRIX_NEAR(t.local_coordinates(p), x, 1e-10);
+            EXPECT_MATRIX_NEAR(t.local_coordinates(p), t.local_coordinates(p, LocalCoordinates::Zero(), 1e-12, 10), 1e-10);
+        }
+
         // Contains point
         {
             FLOATING_POINT_TYPE epsilon = 0.000001;
@@ -93,6 +101,18 @@ TEST(Tetrahedron, Linear) {
                 ASSERT_FALSE(t.contains_local(p, epsilon)) <<
                 "Local point [" << p[0] << ", " << p[1] << ", " << p[2] << "] is found inside the element, but it should be outside.";
             }
+
+            // Clamping the local coordinates onto the element
+            for (const auto & p : inside_points) {
+                EXPECT_MATRIX_NEAR(t.clamped_local_coordinates(p), p, epsilon);
+            }
+            for (const auto & p : outside_points) {
+                EXPECT_TRUE(t.contains_local(t.clamped_local_coordinates(p), epsilon));
+            }
+            EXPECT_MATRIX_NEAR(t.clamped_local_coordinates(LocalCoordinates(2, 0, 0)), LocalCoordinates(1, 0, 0), 1e-15);
+            EXPECT_MATRIX_NEAR(t.clamped_local_coordinates(LocalCoordinates(-1, 0.5, 0.2)), LocalCoordinates(0, 0.5, 0.2), 1e-15);
+            EXPECT_MATRIX_NEAR(t.clamped_local_coordinates(LocalCoordinates(0.8, 0.6, -0.5)), LocalCoordinates(0.6, 0.4, 0), 1e-15);
+            EXPECT_MATRIX_NEAR(t.clamped_local_coordinates(LocalCoordinates(1, 1, 1)), LocalCoordinates(1/3., 1/3., 1/3.), 1e-15);
         }
     }
 }
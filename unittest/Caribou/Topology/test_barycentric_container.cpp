@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 #include "topology_test.h"
 #include <Caribou/Geometry/Quad.h>
+#include <Caribou/Geometry/Triangle.h>
+#include <Caribou/Geometry/Hexahedron.h>
 #include <Caribou/Topology/Mesh.h>
 #include <Caribou/Topology/Domain.h>
 #include <Caribou/Topology/BarycentricContainer.h>
@@ -183,4 +185,428 @@ TEST(BarycentricContainer, _2D) {
 
     const auto outside_nodes = barycentric_container.outside_nodes();
     EXPECT_EQ(outside_nodes, std::vector<UNSIGNED_INTEGER_TYPE>({0, 3, 6, 7, 8}));
-}
\ No newline at end of file
+}
+
+TEST(BarycentricContainer, FlatHashGrid) {
+    using Mesh = Mesh<_3D>;
+    using Hexahedron = Hexahedron<Linear>;
+    using Domain = Domain<Hexahedron>;
+
+    // A 4x3x2 grid of hexahedrons of size 2x1x0.5
+    const std::array<UNSIGNED_INTEGER_TYPE, 3> n = {4, 3, 2};
+    const auto node_index = [&n](UNSIGNED_INTEGER_TYPE i, UNSIGNED_INTEGER_TYPE j, UNSIGNED_INTEGER_TYPE k) {
+        return static_cast<int>(i + (n[0]+1)*(j + (n[1]+1)*k));
+    };
+
+    std::vector<Mesh::WorldCoordinates> positions;
+    for (UNSIGNED_INTEGER_TYPE k = 0; k <= n[2]; ++k) {
+        for (UNSIGNED_INTEGER_TYPE j = 0; j <= n[1]; ++j) {
+            for (UNSIGNED_INTEGER_TYPE i = 0; i <= n[0]; ++i) {
+                positions.emplace_back(-4. + 2.*i, -1.5 + 1.*j, 0.5*k);
+            }
+        }
+    }
+    Mesh container_mesh (positions);
+
+    Domain::ElementsIndices hexahedron_indices(n[0]*n[1]*n[2], 8);
+    int element_id = 0;
+    for (UNSIGNED_INTEGER_TYPE k = 0; k < n[2]; ++k) {
+        for (UNSIGNED_INTEGER_TYPE j = 0; j < n[1]; ++j) {
+            for (UNSIGNED_INTEGER_TYPE i = 0; i < n[0]; ++i) {
+                hexahedron_indices.row(element_id++) <<
+                    node_index(i, j, k),   node_index(i+1, j, k),   node_index(i+1, j+1, k),   node_index(i, j+1, k),
+                    node_index(i, j, k+1), node_index(i+1, j, k+1), node_index(i+1, j+1, k+1), node_index(i, j+1, k+1);
+            }
+        }
+    }
+    const Domain * container_domain = container_mesh.add_domain<Hexahedron>("hexahedrons", hexahedron_indices);
+
+    // Points: the nodes, the element centers and gauss nodes, and a few points outside of the domain
+    std::vector<Mesh::WorldCoordinates> points (positions.begin(), positions.end());
+    for (UNSIGNED_INTEGER_TYPE id = 0; id < container_domain->number_of_elements(); ++id) {
+        const Hexahedron element = container_domain->element(id);
+        points.emplace_back(element.center());
+        for (const auto & gauss_node : element.gauss_nodes()) {
+            points.emplace_back(element.world_coordinates(gauss_node.position));
+        }
+    }
+    points.emplace_back(-5, 0, 0.5);
+    points.emplace_back(0, 2, 0.5);
+    points.emplace_back(0, 0, 1.5);
+
+    Eigen::Map<Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, 3, Eigen::RowMajor>> embedded_points(&points[0][0], points.size(), 3);
+    const auto hash_grid_container = container_domain->embed(embedded_points, SpatialIndex::HashGrid);
+    const auto flat_hash_grid_container = container_domain->embed(embedded_points, SpatialIndex::FlatHashGrid);
+    EXPECT_EQ(hash_grid_container.spatial_index(), SpatialIndex::HashGrid);
+    EXPECT_EQ(flat_hash_grid_container.spatial_index(), SpatialIndex::FlatHashGrid);
+
+    // Both spatial indices must find the same candidates, hence the same barycentric points
+    EXPECT_EQ(flat_hash_grid_container.outside_nodes(), hash_grid_container.outside_nodes());
+    EXPECT_EQ(flat_hash_grid_container.outside_nodes().size(), 3u);
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        const auto & expected = hash_grid_container.barycentric_points()[i];
+        const auto & bp = flat_hash_grid_container.barycentric_points()[i];
+        EXPECT_EQ(bp.element_index, expected.element_index);
+        EXPECT_MATRIX_NEAR(bp.local_coordinates, expected.local_coordinates, 1e-10);
+        EXPECT_EQ(flat_hash_grid_container.closest_elements(points[i]).size(), hash_grid_container.closest_elements(points[i]).size());
+    }
+
+    // Compare the candidates of the two grids directly
+    const FLOATING_POINT_TYPE cell_size = 0.75;
+    HashGrid<Hexahedron> hash_grid (cell_size, container_domain->number_of_elements());
+    FlatHashGrid<Hexahedron> flat_hash_grid (cell_size);
+    for (UNSIGNED_INTEGER_TYPE id = 0; id < container_domain->number_of_elements(); ++id) {
+        hash_grid.add(container_domain->element(id), id);
+    }
+    flat_hash_grid.build(container_domain->number_of_elements(), [container_domain](const UNSIGNED_INTEGER_TYPE & id) {
+        return container_domain->element(id);
+    });
+    EXPECT_GT(flat_hash_grid.number_of_cells(), 0u);
+    EXPECT_GE(flat_hash_grid.number_of_entries(), flat_hash_grid.number_of_cells());
+    for (const auto & p : points) {
+        EXPECT_EQ(flat_hash_grid.get(p), hash_grid.get(p));
+    }
+
+    // Batched queries must give the same results as the individual ones
+    for (const auto * container : {&hash_grid_container, &flat_hash_grid_container}) {
+        std::vector<BarycentricContainer<Domain>::BarycentricPoint> barycentric_points (points.size());
+        container->find_barycentric_points(embedded_points, barycentric_points);
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            const auto expected = container->barycentric_point(points[i]);
+            EXPECT_EQ(barycentric_points[i].element_index, expected.element_index);
+            EXPECT_MATRIX_EQUAL(barycentric_points[i].local_coordinates, expected.local_coordinates);
+        }
+
+        std::vector<BarycentricContainer<Domain>::BarycentricPoint> too_small (points.size() - 1);
+        EXPECT_THROW(container->find_barycentric_points(embedded_points, too_small), std::runtime_error);
+    }
+}
+
+TEST(BarycentricContainer, BVH) {
+    using Mesh = Mesh<_3D>;
+    using Hexahedron = Hexahedron<Linear>;
+    using Domain = Domain<Hexahedron>;
+
+    // A 6x3x2 grid of hexahedrons with a size growing quickly along the x axis
+    const std::vector<FLOATING_POINT_TYPE> x = {0, 0.01, 0.03, 0.1, 0.5, 2, 8};
+    const std::array<UNSIGNED_INTEGER_TYPE, 3> n = {x.size()-1, 3, 2};
+    const auto node_index = [&n](UNSIGNED_INTEGER_TYPE i, UNSIGNED_INTEGER_TYPE j, UNSIGNED_INTEGER_TYPE k) {
+        return static_cast<int>(i + (n[0]+1)*(j + (n[1]+1)*k));
+    };
+
+    std::vector<Mesh::WorldCoordinates> positions;
+    for (UNSIGNED_INTEGER_TYPE k = 0; k <= n[2]; ++k) {
+        for (UNSIGNED_INTEGER_TYPE j = 0; j <= n[1]; ++j) {
+            for (UNSIGNED_INTEGER_TYPE i = 0; i <= n[0]; ++i) {
+                positions.emplace_back(x[i], -1.5 + 1.*j, 0.5*k);
+            }
+        }
+    }
+    Mesh container_mesh (positions);
+
+    Domain::ElementsIndices hexahedron_indices(n[0]*n[1]*n[2], 8);
+    int element_id = 0;
+    for (UNSIGNED_INTEGER_TYPE k = 0; k < n[2]; ++k) {
+        for (UNSIGNED_INTEGER_TYPE j = 0; j < n[1]; ++j) {
+            for (UNSIGNED_INTEGER_TYPE i = 0; i < n[0]; ++i) {
+                hexahedron_indices.row(element_id++) <<
+                    node_index(i, j, k),   node_index(i+1, j, k),   node_index(i+1, j+1, k),   node_index(i, j+1, k),
+                    node_index(i, j, k+1), node_index(i+1, j, k+1), node_index(i+1, j+1, k+1), node_index(i, j+1, k+1);
+            }
+        }
+    }
+    const Domain * container_domain = container_mesh.add_domain<Hexahedron>("hexahedrons", hexahedron_indices);
+
+    // Points: the nodes, the element centers and gauss nodes, and a few points outside of the domain
+    std::vector<Mesh::WorldCoordinates> points (positions.begin(), positions.end());
+    for (UNSIGNED_INTEGER_TYPE id = 0; id < container_domain->number_of_elements(); ++id) {
+        const Hexahedron element = container_domain->element(id);
+        points.emplace_back(element.center());
+        for (const auto & gauss_node : element.gauss_nodes()) {
+            points.emplace_back(element.world_coordinates(gauss_node.position));
+        }
+    }
+    points.emplace_back(-0.005, 0, 0.5);
+    points.emplace_back(0.02, 2, 0.5);
+    points.emplace_back(4, 0, 1.5);
+
+    Eigen::Map<Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, 3, Eigen::RowMajor>> embedded_points(&points[0][0], points.size(), 3);
+    const auto hash_grid_container = container_domain->embed(embedded_points, SpatialIndex::HashGrid);
+    const auto bvh_container = container_domain->embed(embedded_points, SpatialIndex::BVH);
+    EXPECT_EQ(bvh_container.spatial_index(), SpatialIndex::BVH);
+
+    // The first element (by index) containing a point does not depend on the spatial index
+    EXPECT_EQ(bvh_container.outside_nodes(), hash_grid_container.outside_nodes());
+    EXPECT_EQ(bvh_container.outside_nodes().size(), 3u);
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        const auto & expected = hash_grid_container.barycentric_points()[i];
+        const auto & bp = bvh_container.barycentric_points()[i];
+        EXPECT_EQ(bp.element_index, expected.element_index);
+        EXPECT_MATRIX_NEAR(bp.local_coordinates, expected.local_coordinates, 1e-10);
+    }
+
+    // The candidates are exactly the elements having a bounding box containing the point
+    BVH<Hexahedron> bvh;
+    bvh.build(container_domain->number_of_elements(), [container_domain](const UNSIGNED_INTEGER_TYPE & id) {
+        return container_domain->element(id);
+    });
+    EXPECT_EQ(bvh.number_of_levels(), 5u); // 36 elements: 9 leaves, then 5, 3, 2 and 1 (root) nodes
+    EXPECT_EQ(bvh.number_of_nodes(), 20u);
+    for (const auto & p : points) {
+        std::set<UNSIGNED_INTEGER_TYPE> expected;
+        for (UNSIGNED_INTEGER_TYPE id = 0; id < container_domain->number_of_elements(); ++id) {
+            const auto nodes = container_domain->element(id).nodes();
+            const Mesh::WorldCoordinates lower = nodes.colwise().minCoeff().transpose();
+            const Mesh::WorldCoordinates upper = nodes.colwise().maxCoeff().transpose();
+            if (((p - lower).array() >= -1e-10).all() and ((upper - p).array() >= -1e-10).all()) {
+                expected.emplace(id);
+            }
+        }
+        EXPECT_EQ(bvh.get(p), expected);
+    }
+
+    // An empty tree does not contain anything
+    BVH<Hexahedron> empty_bvh;
+    empty_bvh.build({}, {});
+    EXPECT_TRUE(empty_bvh.get(points[0]).empty());
+}
+
+TEST(BarycentricContainer, CachedInverseJacobians) {
+    using Mesh = Mesh<_2D>;
+    using Triangle = Triangle<_2D, Linear>;
+    using Domain = Domain<Triangle>;
+
+    // A 4x4 grid of squares, each one split into two triangles
+    const UNSIGNED_INTEGER_TYPE n = 4;
+    std::vector<Mesh::WorldCoordinates> positions;
+    for (UNSIGNED_INTEGER_TYPE j = 0; j <= n; ++j) {
+        for (UNSIGNED_INTEGER_TYPE i = 0; i <= n; ++i) {
+            positions.emplace_back(0.5*i, 0.25*j*j);
+        }
+    }
+    Mesh container_mesh (positions);
+
+    Domain::ElementsIndices triangle_indices(2*n*n, 3);
+    int element_id = 0;
+    for (UNSIGNED_INTEGER_TYPE j = 0; j < n; ++j) {
+        for (UNSIGNED_INTEGER_TYPE i = 0; i < n; ++i) {
+            const auto node = [n](UNSIGNED_INTEGER_TYPE i, UNSIGNED_INTEGER_TYPE j) { return static_cast<int>(i + (n+1)*j); };
+            triangle_indices.row(element_id++) << node(i, j), node(i+1, j), node(i+1, j+1);
+            triangle_indices.row(element_id++) << node(i, j), node(i+1, j+1), node(i, j+1);
+        }
+    }
+    const Domain * container_domain = container_mesh.add_domain<Triangle>("triangles", triangle_indices);
+
+    // Points: a regular sampling of the domain and around it
+    std::vector<Mesh::WorldCoordinates> points;
+    for (int j = -1; j <= 20; ++j) {
+        for (int i = -1; i <= 20; ++i) {
+            points.emplace_back(0.1*i, 0.2*j);
+        }
+    }
+
+    Eigen::Map<Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, 2, Eigen::RowMajor>> embedded_points(&points[0][0], points.size(), 2);
+    auto container = container_domain->embed(embedded_points);
+    EXPECT_FALSE(container.inverse_jacobians_are_cached());
+    EXPECT_FALSE(container.outside_nodes().empty());
+
+    // The cached inverse Jacobians must give the same barycentric points as the elements
+    container.cache_inverse_jacobians();
+    EXPECT_TRUE(container.inverse_jacobians_are_cached());
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        const auto & expected = container.barycentric_points()[i];
+        const auto bp = container.barycentric_point(points[i]);
+        EXPECT_EQ(bp.element_index, expected.element_index);
+        EXPECT_MATRIX_NEAR(bp.local_coordinates, expected.local_coordinates, 1e-10);
+        if (bp.element_index >= 0) {
+            const Triangle e = container_domain->element(static_cast<UNSIGNED_INTEGER_TYPE>(bp.element_index));
+            EXPECT_MATRIX_NEAR(e.world_coordinates(bp.local_coordinates), points[i].transpose(), 1e-10);
+        }
+        for (const auto & closest : container.closest_elements(points[i])) {
+            const Triangle e = container_domain->element(static_cast<UNSIGNED_INTEGER_TYPE>(closest.element_index));
+            EXPECT_MATRIX_NEAR(e.world_coordinates(closest.local_coordinates), points[i].transpose(), 1e-10);
+        }
+    }
+}
+
+TEST(BarycentricContainer, UpdateEmbeddedPoints) {
+    using Mesh = Mesh<_3D>;
+    using Hexahedron = Hexahedron<Linear>;
+    using Domain = Domain<Hexahedron>;
+
+    // A 4x3x2 grid of slightly distorted hexahedrons
+    const std::array<UNSIGNED_INTEGER_TYPE, 3> n = {4, 3, 2};
+    const auto node_index = [&n](UNSIGNED_INTEGER_TYPE i, UNSIGNED_INTEGER_TYPE j, UNSIGNED_INTEGER_TYPE k) {
+        return static_cast<int>(i + (n[0]+1)*(j + (n[1]+1)*k));
+    };
+
+    std::vector<Mesh::WorldCoordinates> positions;
+    for (UNSIGNED_INTEGER_TYPE k = 0; k <= n[2]; ++k) {
+        for (UNSIGNED_INTEGER_TYPE j = 0; j <= n[1]; ++j) {
+            for (UNSIGNED_INTEGER_TYPE i = 0; i <= n[0]; ++i) {
+                positions.emplace_back(1.*i + 0.1*j*k, 1.*j + 0.05*i*i, 1.*k + 0.1*i*j);
+            }
+        }
+    }
+    Mesh container_mesh (positions);
+
+    Domain::ElementsIndices hexahedron_indices(n[0]*n[1]*n[2], 8);
+    int element_id = 0;
+    for (UNSIGNED_INTEGER_TYPE k = 0; k < n[2]; ++k) {
+        for (UNSIGNED_INTEGER_TYPE j = 0; j < n[1]; ++j) {
+            for (UNSIGNED_INTEGER_TYPE i = 0; i < n[0]; ++i) {
+                hexahedron_indices.row(element_id++) <<
+                    node_index(i, j, k),   node_index(i+1, j, k),   node_index(i+1, j+1, k),   node_index(i, j+1, k),
+                    node_index(i, j, k+1), node_index(i+1, j, k+1), node_index(i+1, j+1, k+1), node_index(i, j+1, k+1);
+            }
+        }
+    }
+    const Domain * container_domain = container_mesh.add_domain<Hexahedron>("hexahedrons", hexahedron_indices);
+
+    // Points inside of every elements
+    std::vector<Mesh::WorldCoordinates> points;
+    for (UNSIGNED_INTEGER_TYPE id = 0; id < container_domain->number_of_elements(); ++id) {
+        const Hexahedron element = container_domain->element(id);
+        for (const auto & gauss_node : element.gauss_nodes()) {
+            points.emplace_back(element.world_coordinates(gauss_node.position));
+        }
+    }
+
+    Eigen::Map<Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, 3, Eigen::RowMajor>> embedded_points(&points[0][0], points.size(), 3);
+    auto container = container_domain->embed(embedded_points);
+    EXPECT_TRUE(container.outside_nodes().empty());
+
+    // Move every other point: by a small distance (same or neighbour element), by a large distance (far element) or
+    // outside of the domain
+    std::vector<UNSIGNED_INTEGER_TYPE> indices;
+    std::vector<Mesh::WorldCoordinates> new_points;
+    for (UNSIGNED_INTEGER_TYPE i = 0; i < points.size(); i += 2) {
+        indices.emplace_back(i);
+        if (i % 6 == 0) {
+            new_points.emplace_back(points[i] + Mesh::WorldCoordinates(0.3, -0.2, 0.1));
+        } else if (i % 6 == 2) {
+            new_points.emplace_back(points[(i*7) % points.size()]);
+        } else {
+            new_points.emplace_back(points[i] + Mesh::WorldCoordinates(10, 0, 0));
+        }
+    }
+    Eigen::Map<Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, 3, Eigen::RowMajor>> new_positions(&new_points[0][0], new_points.size(), 3);
+    container.update_embedded_points(indices, new_positions);
+
+    std::vector<Mesh::WorldCoordinates> expected_points = points;
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+        expected_points[indices[i]] = new_points[i];
+    }
+
+    // Same results as a complete embedding of the new points
+    Eigen::Map<Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, 3, Eigen::RowMajor>> expected_positions(&expected_points[0][0], expected_points.size(), 3);
+    const auto expected_container = container_domain->embed(expected_positions);
+    EXPECT_EQ(container.outside_nodes(), expected_container.outside_nodes());
+    EXPECT_FALSE(container.outside_nodes().empty());
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        EXPECT_EQ(container.barycentric_points()[i].element_index, expected_container.barycentric_points()[i].element_index);
+        EXPECT_MATRIX_NEAR(container.barycentric_points()[i].local_coordinates, expected_container.barycentric_points()[i].local_coordinates, 1e-5);
+    }
+
+    // Moving back the points to their initial positions
+    std::vector<Mesh::WorldCoordinates> initial_points;
+    for (const auto & index : indices) {
+        initial_points.emplace_back(points[index]);
+    }
+    Eigen::Map<Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, 3, Eigen::RowMajor>> initial_positions(&initial_points[0][0], initial_points.size(), 3);
+    container.update_embedded_points(indices, initial_positions);
+    EXPECT_TRUE(container.outside_nodes().empty());
+
+    // Wrong sizes
+    EXPECT_THROW(container.update_embedded_points({0, 1}, new_positions), std::runtime_error);
+    EXPECT_THROW(container.update_embedded_points({points.size()}, new_positions.topRows(1)), std::runtime_error);
+
+    // Duplicated indices
+    EXPECT_THROW(container.update_embedded_points({0, 0}, new_positions.topRows(2)), std::runtime_error);
+}
+
+TEST(BarycentricContainer, ProjectOutsideNodes) {
+    using Mesh = Mesh<_3D>;
+    using Hexahedron = Hexahedron<Linear>;
+    using Domain = Domain<Hexahedron>;
+
+    // A 4x3x2 grid of unit hexahedrons
+    const std::array<UNSIGNED_INTEGER_TYPE, 3> n = {4, 3, 2};
+    const auto node_index = [&n](UNSIGNED_INTEGER_TYPE i, UNSIGNED_INTEGER_TYPE j, UNSIGNED_INTEGER_TYPE k) {
+        return static_cast<int>(i + (n[0]+1)*(j + (n[1]+1)*k));
+    };
+
+    std::vector<Mesh::WorldCoordinates> positions;
+    for (UNSIGNED_INTEGER_TYPE k = 0; k <= n[2]; ++k) {
+        for (UNSIGNED_INTEGER_TYPE j = 0; j <= n[1]; ++j) {
+            for (UNSIGNED_INTEGER_TYPE i = 0; i <= n[0]; ++i) {
+                positions.emplace_back(1.*i, 1.*j, 1.*k);
+            }
+        }
+    }
+    Mesh container_mesh (positions);
+
+    Domain::ElementsIndices hexahedron_indices(n[0]*n[1]*n[2], 8);
+    int element_id = 0;
+    for (UNSIGNED_INTEGER_TYPE k = 0; k < n[2]; ++k) {
+        for (UNSIGNED_INTEGER_TYPE j = 0; j < n[1]; ++j) {
+            for (UNSIGNED_INTEGER_TYPE i = 0; i < n[0]; ++i) {
+                hexahedron_indices.row(element_id++) <<
+                    node_index(i, j, k),   node_index(i+1, j, k),   node_index(i+1, j+1, k),   node_index(i, j+1, k),
+                    node_index(i, j, k+1), node_index(i+1, j, k+1), node_index(i+1, j+1, k+1), node_index(i, j+1, k+1);
+            }
+        }
+    }
+    const Domain * container_domain = container_mesh.add_domain<Hexahedron>("hexahedrons", hexahedron_indices);
+
+    // Points inside of the domain, and points outside of it paired to their projection onto the domain
+    std::vector<Mesh::WorldCoordinates> points = {
+        {0.5, 0.5, 0.5}, {3.2, 2.7, 1.1}, {-0.5, 1.2, 0.7}, {5, 4, 1}, {2.5, 1.5, 3.25}, {14, 1.5, -1}
+    };
+    const std::vector<Mesh::WorldCoordinates> projections = {
+        {0.5, 0.5, 0.5}, {3.2, 2.7, 1.1}, {0, 1.2, 0.7}, {4, 3, 1}, {2.5, 1.5, 2}, {4, 1.5, 0}
+    };
+
+    Eigen::Map<Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, 3, Eigen::RowMajor>> embedded_points(&points[0][0], points.size(), 3);
+    for (const auto & spatial_index : {SpatialIndex::HashGrid, SpatialIndex::FlatHashGrid, SpatialIndex::BVH}) {
+        auto container = container_domain->embed(embedded_points, spatial_index);
+        EXPECT_EQ(container.outside_nodes(), std::vector<UNSIGNED_INTEGER_TYPE>({2, 3, 4, 5}));
+
+        FLOATING_POINT_TYPE distance;
+        const auto bp = container.closest_barycentric_point(points[0].transpose(), distance);
+        EXPECT_EQ(bp.element_index, container.barycentric_points()[0].element_index);
+        EXPECT_NEAR(distance, 0, 1e-10);
+
+        const auto maximum_distance = container.project_outside_nodes(embedded_points);
+        EXPECT_NEAR(maximum_distance, 10*std::sqrt(1.01), 1e-10);
+        EXPECT_TRUE(container.outside_nodes().empty());
+
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            const auto & barycentric_point = container.barycentric_points()[i];
+            ASSERT_GE(barycentric_point.element_index, 0);
+            const Hexahedron element = container_domain->element(static_cast<UNSIGNED_INTEGER_TYPE>(barycentric_point.element_index));
+            EXPECT_TRUE(element.contains_local(barycentric_point.local_coordinates));
+            EXPECT_MATRIX_NEAR(element.world_coordinates(barycentric_point.local_coordinates), projections[i].transpose(), 1e-10);
+        }
+
+        // Wrong sizes
+        EXPECT_THROW(container.project_outside_nodes(embedded_points.topRows(2)), std::runtime_error);
+    }
+}
+
+TEST(HashGrid, SmallIndexSet) {
+    SmallIndexSet<UNSIGNED_INTEGER_TYPE, 4> set;
+    EXPECT_TRUE(set.empty());
+
+    // Duplicates are ignored, and the indices overflowing the inline storage are kept
+    for (UNSIGNED_INTEGER_TYPE i : {7, 3, 7, 5, 1, 3, 9, 0, 9, 4}) {
+        set.insert(i);
+    }
+    set.sort();
+    EXPECT_EQ(set.size(), 7u);
+    EXPECT_EQ(std::vector<UNSIGNED_INTEGER_TYPE>(set.begin(), set.end()), std::vector<UNSIGNED_INTEGER_TYPE>({0, 1, 3, 4, 5, 7, 9}));
+
+    set.clear();
+    set.insert(2);
+    EXPECT_EQ(std::vector<UNSIGNED_INTEGER_TYPE>(set.begin(), set.end()), std::vector<UNSIGNED_INTEGER_TYPE>({2}));
+}
@@ -6,6 +6,7 @@ DISABLE_ALL_WARNINGS_BEGIN
 #include <sofa/version.h>
 #include <SofaBaseLinearSolver/FullVector.h>
 #include <SofaCaribou/Algebra/BaseVectorOperations.h>
+#include <SofaCaribou/Algebra/EigenVector.h>
 DISABLE_ALL_WARNINGS_END
 
 #include <Eigen/Dense>
@@ -60,4 +61,68 @@ TEST(Algebra, SofaFullFFullDDotProduct) {
     }
 
     EXPECT_NEAR(SofaCaribou::Algebra::dot(&sofa_v1, &sofa_v2), v1.cast<double>().dot(v2), 1e-10);
-}
\ No newline at end of file
+}
+TEST(Algebra, EigenVectorDotProductAndNorm) {
+    // Large enough to be split into multiple chunks when compiled with OpenMP
+    const auto n = 2*SofaCaribou::Algebra::minimum_size_for_multithreading + 1;
+    const Eigen::VectorXd v1 = Eigen::VectorXd::Random(n);
+    const Eigen::VectorXd v2 = Eigen::VectorXd::Random(n);
+
+    SofaCaribou::Algebra::EigenVector<Eigen::VectorXd> eigen_v1 (n);
+    SofaCaribou::Algebra::EigenVector<Eigen::VectorXd> eigen_v2 (n);
+    eigen_v1.vector() = v1;
+    eigen_v2.vector() = v2;
+
+    EXPECT_NEAR(SofaCaribou::Algebra::dot(&eigen_v1, &eigen_v2), v1.dot(v2), 1e-8);
+    EXPECT_NEAR(SofaCaribou::Algebra::norm(&eigen_v1), v1.norm(), 1e-8);
+
+    // Mixed with a SOFA full vector
+    sofa::component::linearsolver::FullVector<double> sofa_v2 (n);
+    for (sofa::Index i = 0; i < static_cast<sofa::Index>(n); ++i) {
+        sofa_v2[i] = v2[static_cast<Eigen::Index>(i)];
+    }
+    EXPECT_NEAR(SofaCaribou::Algebra::dot(&eigen_v1, &sofa_v2), v1.dot(v2), 1e-8);
+}
+
+TEST(Algebra, BaseVectorAxpy) {
+    const auto n = 2*SofaCaribou::Algebra::minimum_size_for_multithreading + 1;
+    const Eigen::VectorXd x = Eigen::VectorXd::Random(n);
+    const Eigen::VectorXd y = Eigen::VectorXd::Random(n);
+
+    // EigenVector<double> - EigenVector<double>
+    SofaCaribou::Algebra::EigenVector<Eigen::VectorXd> eigen_x (n);
+    SofaCaribou::Algebra::EigenVector<Eigen::VectorXd> eigen_y (n);
+    eigen_x.vector() = x;
+    eigen_y.vector() = y;
+    SofaCaribou::Algebra::axpy(-2.5, &eigen_x, &eigen_y);
+    EXPECT_NEAR((eigen_y.vector() - (y - 2.5*x)).norm(), 0., 1e-10);
+
+    // FullVector<double> - EigenVector<float>
+    sofa::component::linearsolver::FullVector<double> sofa_x (n);
+    for (sofa::Index i = 0; i < static_cast<sofa::Index>(n); ++i) {
+        sofa_x[i] = x[static_cast<Eigen::Index>(i)];
+    }
+    SofaCaribou::Algebra::EigenVector<Eigen::VectorXf> eigen_yf (n);
+    eigen_yf.vector() = y.cast<float>();
+    SofaCaribou::Algebra::axpy(-2.5, &sofa_x, &eigen_yf);
+    EXPECT_NEAR((eigen_yf.vector().cast<double>() - (y - 2.5*x)).norm(), 0., 1e-3);
+}
+
+TEST(Algebra, BaseVectorScale) {
+    const auto n = 2*SofaCaribou::Algebra::minimum_size_for_multithreading + 1;
+    const Eigen::VectorXd x = Eigen::VectorXd::Random(n);
+
+    SofaCaribou::Algebra::EigenVector<Eigen::VectorXd> eigen_x (n);
+    eigen_x.vector() = x;
+    SofaCaribou::Algebra::scale(0.5, &eigen_x);
+    EXPECT_NEAR((eigen_x.vector() - 0.5*x).norm(), 0., 1e-10);
+
+    sofa::component::linearsolver::FullVector<float> sofa_x (n);
+    for (sofa::Index i = 0; i < static_cast<sofa::Index>(n); ++i) {
+        sofa_x[i] = static_cast<float>(x[static_cast<Eigen::Index>(i)]);
+    }
+    SofaCaribou::Algebra::scale(0.5, &sofa_x);
+    for (sofa::Index i = 0; i < static_cast<sofa::Index>(n); ++i) {
+        EXPECT_NEAR(sofa_x[i], 0.5*x[static_cast<Eigen::Index>(i)], 1e-6);
+    }
+}
@@ -23,6 +23,8 @@ DISABLE_ALL_WARNINGS_END
 #include <Eigen/Dense>
 #include <Eigen/Sparse>
 
+#include <random>
+
 template<int nRows, int nColumns>
 using Matrix = Eigen::Matrix<FLOATING_POINT_TYPE, nRows, nColumns>;
 
@@ -196,3 +198,95 @@ TEST(Algebra, SparseMatrixByReference) {
     EXPECT_EQ(mm(30, 30), 200);
     EXPECT_EQ(m.coeff(30, 30), 200);
 }
+
+TEST(Algebra, SparseMatrixLockedPattern) {
+    using EigenSparse = Eigen::SparseMatrix<double>;
+    using EigenMatrix = SofaCaribou::Algebra::EigenMatrix<EigenSparse>;
+
+    const size_t N = 12;
+    EigenMatrix mm(N, N);
+    mm.set_pattern_locked(true);
+    EXPECT_TRUE(mm.pattern_locked());
+
+    // First assembly (goes through the triplets)
+    mm.add(0, 0, Mat3x3d(1));
+    mm.add(3, 3, Mat3x3d(2));
+    mm.add(0, 3, Mat3x3d(3));
+    mm.add(3, 0, Mat3x3d(3));
+    mm.compress();
+    const auto non_zeros = mm.matrix().nonZeros();
+    EXPECT_EQ(non_zeros, 36);
+
+    // Clearing keeps the pattern
+    mm.clear();
+    EXPECT_EQ(mm.matrix().nonZeros(), non_zeros);
+    EXPECT_EQ(mm(0, 0), 0);
+    EXPECT_EQ(mm(3, 0), 0);
+
+    // Second assembly (goes directly into the locked pattern)
+    mm.add(0, 0, Mat3x3d(1));
+    mm.add(3, 3, Mat3x3f(2));
+    mm.add(0, 3, Mat3x3d(3));
+    mm.add(3, 0, Mat3x3d(3));
+    mm.add(4, 5, 10.);
+    mm.compress();
+    EXPECT_EQ(mm.matrix().nonZeros(), non_zeros);
+    EXPECT_EQ(mm(2, 2), 1);
+    EXPECT_EQ(mm(5, 5), 2);
+    EXPECT_EQ(mm(4, 5), 12);
+    EXPECT_EQ(mm(0, 5), 3);
+    EXPECT_EQ(mm(5, 0), 3);
+
+    // Entries outside of the locked pattern are still accepted and become part of the pattern
+    mm.add(9, 9, Mat3x3d(4));
+    mm.add(0, 11, 5.);
+    mm.compress();
+    EXPECT_EQ(mm.matrix().nonZeros(), non_zeros + 10);
+    EXPECT_EQ(mm(11, 11), 4);
+    EXPECT_EQ(mm(0, 11), 5);
+
+    // Resizing to the same dimensions keeps the pattern, resizing to other dimensions resets it
+    mm.resize(N, N);
+    EXPECT_EQ(mm.matrix().nonZeros(), non_zeros + 10);
+    mm.resize(N+3, N+3);
+    mm.compress();
+    EXPECT_EQ(mm.matrix().nonZeros(), 0);
+}
+
+template <typename EigenSparse>
+void test_parallel_set_from_triplets() {
+    const int N = 300;
+    std::mt19937 generator (0);
+    std::uniform_int_distribution<int> index (0, N-1);
+    std::uniform_real_distribution<double> value (-1, 1);
+
+    // Many duplicated entries
+    std::vector<Eigen::Triplet<double>> triplets;
+    for (int k = 0; k < 60000; ++k) {
+        triplets.emplace_back(index(generator), index(generator), value(generator));
+    }
+
+    EigenSparse expected(N, N);
+    expected.setFromTriplets(triplets.begin(), triplets.end());
+
+    EigenSparse m(N, N);
+    SofaCaribou::Algebra::parallel_set_from_triplets(m, triplets);
+
+    EXPECT_TRUE(m.isCompressed());
+    EXPECT_EQ(m.nonZeros(), expected.nonZeros());
+    EXPECT_NEAR((Eigen::MatrixXd(m) - Eigen::MatrixXd(expected)).norm(), 0, 1e-10);
+
+    // Through the wrapper (large enough for the multithreaded conversion when OpenMP is available)
+    SofaCaribou::Algebra::EigenMatrix<EigenSparse> mm(N, N);
+    for (const auto & t : triplets) {
+        mm.add(t.row(), t.col(), t.value());
+    }
+    mm.compress();
+    EXPECT_EQ(mm.matrix().nonZeros(), expected.nonZeros());
+    EXPECT_NEAR((Eigen::MatrixXd(mm.matrix()) - Eigen::MatrixXd(expected)).norm(), 0, 1e-10);
+}
+
+TEST(Algebra, SparseMatrixParallelSetFromTriplets) {
+    test_parallel_set_from_triplets<Eigen::SparseMatrix<double, Eigen::ColMajor>>();
+    test_parallel_set_from_triplets<Eigen::SparseMatrix<double, Eigen::RowMajor>>();
+}
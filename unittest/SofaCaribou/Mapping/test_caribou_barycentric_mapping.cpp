@@ -0,0 +1,325 @@
+#include <array>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <SofaCaribou/config.h>
+#include <SofaCaribou/Mapping/CaribouBarycentricMapping[Tetrahedron].h>
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/version.h>
+#include <sofa/helper/testing/BaseTest.h>
+#include <sofa/simulation/Node.h>
+#include <SofaSimulationGraph/DAGSimulation.h>
+#include <SofaSimulationGraph/SimpleApi.h>
+#include <SofaBaseMechanics/MechanicalObject.h>
+DISABLE_ALL_WARNINGS_END
+
+using namespace sofa::simulation;
+using namespace sofa::simpleapi;
+using namespace sofa::helper::logging;
+
+#if (defined(SOFA_VERSION) && SOFA_VERSION >= 201299)
+using namespace sofa::testing;
+#endif
+
+namespace {
+using Mapping = SofaCaribou::mapping::CaribouBarycentricMapping<caribou::geometry::Tetrahedron<caribou::Linear>, sofa::defaulttype::Vec3Types>;
+using MechanicalObject = sofa::component::container::MechanicalObject<sofa::defaulttype::Vec3Types>;
+using Coord = MechanicalObject::Coord;
+using Deriv = MechanicalObject::Deriv;
+using Real = MechanicalObject::Real;
+using Matrix = Eigen::Matrix<Real, Eigen::Dynamic, Eigen::Dynamic>;
+
+// Two linear tetrahedrons sharing their face (1, 2, 3). The first one is the canonical tetrahedron.
+const std::array<Coord, 5> container_nodes {{
+    Coord(0, 0, 0), Coord(1, 0, 0), Coord(0, 1, 0), Coord(0, 0, 1), Coord(1, 1, 1)
+}};
+
+const std::array<std::array<int, 4>, 2> container_elements {{
+    {0, 1, 2, 3}, {1, 2, 3, 4}
+}};
+
+// A mapped node given by its container element and its barycentric weights, which are the shape values of the linear
+// tetrahedron evaluated at the node
+struct EmbeddedNode {
+    std::size_t element;
+    std::array<Real, 4> weights;
+};
+
+auto position(const EmbeddedNode & node) -> Coord {
+    Coord p (0, 0, 0);
+    for (std::size_t i = 0; i < 4; ++i) {
+        p += container_nodes[static_cast<std::size_t>(container_elements[node.element][i])] * node.weights[i];
+    }
+    return p;
+}
+
+auto positions(const std::vector<EmbeddedNode> & nodes) -> std::vector<Coord> {
+    std::vector<Coord> p;
+    for (const auto & node : nodes) {
+        p.emplace_back(position(node));
+    }
+    return p;
+}
+
+// Dense mapping matrix assembled from the (mapped node, container node, weight) triplets
+auto mapping_matrix(const std::vector<EmbeddedNode> & nodes) -> Matrix {
+    std::vector<Eigen::Triplet<Real>> triplets;
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        for (std::size_t j = 0; j < 4; ++j) {
+            triplets.emplace_back(static_cast<int>(i), container_elements[nodes[i].element][j], nodes[i].weights[j]);
+        }
+    }
+    Eigen::SparseMatrix<Real> J (static_cast<Eigen::Index>(nodes.size()), static_cast<Eigen::Index>(container_nodes.size()));
+    J.setFromTriplets(triplets.begin(), triplets.end());
+    return Matrix(J);
+}
+
+// N x 3 matrix of a vector of N nodal values
+template <typename Vector>
+auto to_matrix(const Vector & v) -> Matrix {
+    Matrix m (static_cast<Eigen::Index>(v.size()), 3);
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        for (std::size_t j = 0; j < 3; ++j) {
+            m(static_cast<Eigen::Index>(i), static_cast<Eigen::Index>(j)) = v[i][j];
+        }
+    }
+    return m;
+}
+
+template <typename Vector>
+auto to_string(const Vector & v) -> std::string {
+    std::ostringstream s;
+    s << std::setprecision(std::numeric_limits<Real>::max_digits10);
+    for (const auto & p : v) {
+        s << p[0] << " " << p[1] << " " << p[2] << " ";
+    }
+    return s.str();
+}
+
+// Mechanical object of the two tetrahedrons, and a child mechanical object mapped at the given positions
+struct Embedding {
+    Node::SPtr root;
+    MechanicalObject * mo = nullptr;
+    MechanicalObject * mapped_mo = nullptr;
+    Mapping * mapping = nullptr;
+};
+
+auto create_embedding(const std::vector<Coord> & mapped_positions, bool project_outside_nodes = false) -> Embedding {
+    setSimulation(new sofa::simulation::graph::DAGSimulation());
+
+    Embedding embedding;
+    embedding.root = getSimulation()->createNewNode("root");
+    embedding.mo = dynamic_cast<MechanicalObject *>(createObject(embedding.root, "MechanicalObject", {{"name", "mo"}, {"position", to_string(container_nodes)}}).get());
+    createObject(embedding.root, "CaribouTopology", {{"name", "topology"}, {"template", "Tetrahedron"}, {"position", "@mo.rest_position"}, {"indices", "0 1 2 3 1 2 3 4"}});
+
+    auto mapped = createChild(embedding.root, "mapped");
+    embedding.mapped_mo = dynamic_cast<MechanicalObject *>(createObject(mapped, "MechanicalObject", {{"name", "mapped_mo"}, {"position", to_string(mapped_positions)}}).get());
+    embedding.mapping = dynamic_cast<Mapping *>(createObject(mapped, "CaribouBarycentricMapping", {
+        {"template", "Tetrahedron"}, {"topology", "@../topology"}, {"input", "@../mo"}, {"output", "@mapped_mo"},
+        {"project_outside_nodes", project_outside_nodes ? "1" : "0"}
+    }).get());
+
+    getSimulation()->init(embedding.root.get());
+
+    return embedding;
+}
+
+// Bend the container nodes, and map their new positions
+void bend(const Embedding & embedding) {
+    {
+        auto x = embedding.mo->writePositions();
+        for (std::size_t i = 0; i < x.size(); ++i) {
+            x[i][1] += 0.2 * x[i][0] * x[i][0];
+        }
+    }
+
+    embedding.mapping->apply(sofa::core::MechanicalParams::defaultInstance(),
+                             *embedding.mapped_mo->write(sofa::core::VecCoordId::position()),
+                             *embedding.mo->read(sofa::core::ConstVecCoordId::position()));
+}
+}
+
+/**
+ * Make sure that the positions, velocities and forces mapped with the row-major mapping matrix and its explicit
+ * transposed copy match the products with the dense matrix assembled from the barycentric weights.
+ */
+TEST(CaribouBarycentricMapping, MappingMatrixProducts) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    const std::vector<EmbeddedNode> nodes {
+        {0, {0.1, 0.2, 0.3, 0.4}},
+        {0, {0.4, 0.3, 0.2, 0.1}},
+        {1, {0.25, 0.25, 0.25, 0.25}},
+        {1, {0.1, 0.2, 0.3, 0.4}}
+    };
+    auto embedding = create_embedding(positions(nodes));
+    ASSERT_NE(embedding.mapping, nullptr);
+
+    const Matrix J = mapping_matrix(nodes);
+    const auto * mparams = sofa::core::MechanicalParams::defaultInstance();
+
+    // Positions mapped at initialization, and after a deformation of the container
+    EXPECT_LE((to_matrix(embedding.mapped_mo->readPositions()) - J*to_matrix(container_nodes)).norm(), 1e-12);
+    bend(embedding);
+    EXPECT_LE((to_matrix(embedding.mapped_mo->readPositions()) - J*to_matrix(embedding.mo->readPositions())).norm(), 1e-12);
+
+    // Velocities, v_mapped = J v
+    {
+        auto v = embedding.mo->writeVelocities();
+        for (std::size_t i = 0; i < v.size(); ++i) {
+            v[i] = Deriv(1. + i, 2. - i, 0.5*i*i);
+        }
+    }
+    embedding.mapping->applyJ(mparams,
+                              *embedding.mapped_mo->write(sofa::core::VecDerivId::velocity()),
+                              *embedding.mo->read(sofa::core::ConstVecDerivId::velocity()));
+    const Matrix v = to_matrix(embedding.mo->readVelocities());
+    EXPECT_LE((to_matrix(embedding.mapped_mo->readVelocities()) - J*v).norm(), 1e-12 * (J*v).norm());
+
+    // Forces, f += J^T f_mapped (the mapped forces are accumulated onto the existing ones)
+    {
+        auto f = embedding.mo->writeForces();
+        for (std::size_t i = 0; i < f.size(); ++i) {
+            f[i] = Deriv(1, 1, 1);
+        }
+        auto f_mapped = embedding.mapped_mo->writeForces();
+        for (std::size_t i = 0; i < f_mapped.size(); ++i) {
+            f_mapped[i] = Deriv(i, 1, -2.*i);
+        }
+    }
+    const Matrix f0 = to_matrix(embedding.mo->readForces());
+    embedding.mapping->applyJT(mparams,
+                               *embedding.mo->write(sofa::core::VecDerivId::force()),
+                               *embedding.mapped_mo->read(sofa::core::ConstVecDerivId::force()));
+    const Matrix f = f0 + J.transpose()*to_matrix(embedding.mapped_mo->readForces());
+    EXPECT_LE((to_matrix(embedding.mo->readForces()) - f).norm(), 1e-12 * f.norm());
+
+    getSimulation()->unload(embedding.root);
+}
+
+/**
+ * Make sure that updating the embedding of some mapped nodes from their new rest positions rewrites their rows of the
+ * mapping matrix and of its transposed copy, and that duplicated indices are rejected.
+ */
+TEST(CaribouBarycentricMapping, UpdateEmbedding) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    std::vector<EmbeddedNode> nodes {
+        {0, {0.1, 0.2, 0.3, 0.4}},
+        {0, {0.4, 0.3, 0.2, 0.1}},
+        {1, {0.25, 0.25, 0.25, 0.25}},
+        {1, {0.1, 0.2, 0.3, 0.4}}
+    };
+    auto embedding = create_embedding(positions(nodes));
+    ASSERT_NE(embedding.mapping, nullptr);
+
+    // Move the first node into the second element, and the last node into the first element
+    nodes[0] = {1, {0.4, 0.1, 0.2, 0.3}};
+    nodes[3] = {0, {0.7, 0.1, 0.1, 0.1}};
+    {
+        auto x0 = embedding.mapped_mo->writeRestPositions();
+        x0[0] = position(nodes[0]);
+        x0[3] = position(nodes[3]);
+    }
+    embedding.mapping->update_embedding({0, 3});
+
+    const Matrix J = mapping_matrix(nodes);
+    bend(embedding);
+    EXPECT_LE((to_matrix(embedding.mapped_mo->readPositions()) - J*to_matrix(embedding.mo->readPositions())).norm(), 1e-12);
+
+    {
+        auto f = embedding.mo->writeForces();
+        for (std::size_t i = 0; i < f.size(); ++i) {
+            f[i] = Deriv(0, 0, 0);
+        }
+        auto f_mapped = embedding.mapped_mo->writeForces();
+        for (std::size_t i = 0; i < f_mapped.size(); ++i) {
+            f_mapped[i] = Deriv(i, 1, -2.*i);
+        }
+    }
+    embedding.mapping->applyJT(sofa::core::MechanicalParams::defaultInstance(),
+                               *embedding.mo->write(sofa::core::VecDerivId::force()),
+                               *embedding.mapped_mo->read(sofa::core::ConstVecDerivId::force()));
+    const Matrix f = J.transpose()*to_matrix(embedding.mapped_mo->readForces());
+    EXPECT_LE((to_matrix(embedding.mo->readForces()) - f).norm(), 1e-12 * f.norm());
+
+    // A node given twice is rejected, and the embedding is left untouched
+    {
+        auto x0 = embedding.mapped_mo->writeRestPositions();
+        x0[1] = position({1, {0.1, 0.1, 0.1, 0.7}});
+    }
+    {
+        EXPECT_MSG_EMIT(Error);
+        embedding.mapping->update_embedding({1, 2, 1});
+    }
+    bend(embedding);
+    EXPECT_LE((to_matrix(embedding.mapped_mo->readPositions()) - J*to_matrix(embedding.mo->readPositions())).norm(), 1e-12);
+
+    getSimulation()->unload(embedding.root);
+}
+
+/**
+ * Make sure that the mapped nodes outside of the topology are only accepted when project_outside_nodes is enabled,
+ * that they follow their projection onto their closest element, and that the largest projection distance is reported.
+ */
+TEST(CaribouBarycentricMapping, ProjectOutsideNodes) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    std::vector<EmbeddedNode> nodes {
+        {0, {0.1, 0.2, 0.3, 0.4}},
+        {1, {0.25, 0.25, 0.25, 0.25}}
+    };
+
+    // Node at a distance of 0.5 from the face x = 0 of the first element. Its projection is (0, 0.2, 0.2).
+    auto mapped_positions = positions(nodes);
+    mapped_positions.emplace_back(-0.5, 0.2, 0.2);
+    nodes.push_back({0, {0.6, 0, 0.2, 0.2}});
+
+    {
+        EXPECT_MSG_EMIT(Error);
+        auto embedding = create_embedding(mapped_positions, false);
+        getSimulation()->unload(embedding.root);
+    }
+
+    auto embedding = create_embedding(mapped_positions, true);
+    ASSERT_NE(embedding.mapping, nullptr);
+
+    const auto * maximum_projection_distance =
+        dynamic_cast<const sofa::core::objectmodel::Data<Real> *>(embedding.mapping->findData("maximum_projection_distance"));
+    ASSERT_NE(maximum_projection_distance, nullptr);
+    EXPECT_NEAR(maximum_projection_distance->getValue(), 0.5, 1e-12);
+
+    const Matrix J = mapping_matrix(nodes);
+    bend(embedding);
+    EXPECT_LE((to_matrix(embedding.mapped_mo->readPositions()) - J*to_matrix(embedding.mo->readPositions())).norm(), 1e-12);
+
+    // Moving the outside node further away increases the maximum distance
+    {
+        auto x0 = embedding.mapped_mo->writeRestPositions();
+        x0[2] = Coord(-1, 0.2, 0.2);
+    }
+    embedding.mapping->update_embedding({2});
+    EXPECT_NEAR(maximum_projection_distance->getValue(), 1, 1e-12);
+
+    // Moving it back inside keeps the maximum distance of the previous projections
+    nodes[2] = {0, {0.7, 0.1, 0.1, 0.1}};
+    {
+        auto x0 = embedding.mapped_mo->writeRestPositions();
+        x0[2] = position(nodes[2]);
+    }
+    embedding.mapping->update_embedding({2});
+    EXPECT_NEAR(maximum_projection_distance->getValue(), 1, 1e-12);
+
+    const Matrix J_inside = mapping_matrix(nodes);
+    bend(embedding);
+    EXPECT_LE((to_matrix(embedding.mapped_mo->readPositions()) - J_inside*to_matrix(embedding.mo->readPositions())).norm(), 1e-12);
+
+    getSimulation()->unload(embedding.root);
+}
@@ -141,6 +141,47 @@ TEST(CaribouMass, LinearTetrahedron) {
 
     EXPECT_DOUBLE_EQ(f_caribou.norm(), f_caribou_dia.norm());
     EXPECT_DOUBLE_EQ(f_caribou_dia.norm(), f_sofa_dia.norm());
+
+    // The cached gravity force gives the total weight m*|g|
+    const auto total_weight = dynamic_cast<sofa::core::objectmodel::Data<Real> *>(caribou_mass->findData("total_weight"))->getValue();
+    EXPECT_NEAR(total_weight, M.sum() / 3. * root->getGravity().norm(), 1e-8 * M.sum());
+
+    // AccFromF : the gravity force being M.g, the acceleration a = M^(-1).f must be the gravity at every node
+    const auto g_sofa = root->getGravity();
+    const Eigen::Matrix<Real, 1, 3> g (g_sofa[0], g_sofa[1], g_sofa[2]);
+    caribou_mass->findData("lumped")->read("false");
+    for (const auto & solver : {CaribouMass<Tetrahedron<Linear>>::AccelerationSolver::CHOLESKY,
+                                CaribouMass<Tetrahedron<Linear>>::AccelerationSolver::CONJUGATE_GRADIENT}) {
+        caribou_mass->set_acceleration_solver(solver);
+        DataVecDeriv d_a (d_f_caribou.getValue());
+        caribou_mass->accFromF(&mechanical_parameters, d_a, d_f_caribou);
+
+        Eigen::Map<const Eigen::Matrix<Real, Eigen::Dynamic, 3, Eigen::RowMajor>> a ((d_a.getValue().data()->data()),  mo->getSize(), 3);
+        EXPECT_LT((a.rowwise() - g).norm() / (g.norm()*std::sqrt(mo->getSize())), 1e-8);
+    }
+
+    // AddMDx : the matrix-free product must be the same as the one using the assembled consistent mass matrix
+    const VecDeriv zeros (d_f_caribou.getValue().size());
+    DataVecDeriv d_Mdx (zeros);
+    DataVecDeriv d_Mdx_matrix_free (zeros);
+    caribou_mass->addMDx(&mechanical_parameters, d_Mdx, d_f_caribou, 2.);
+
+    caribou_mass->findData("matrix_free")->read("true");
+    caribou_mass->reinit();
+    caribou_mass->addMDx(&mechanical_parameters, d_Mdx_matrix_free, d_f_caribou, 2.);
+
+    Eigen::Map<const Eigen::Matrix<Real, Eigen::Dynamic, 3, Eigen::RowMajor>> Mdx ((d_Mdx.getValue().data()->data()),  mo->getSize(), 3);
+    Eigen::Map<const Eigen::Matrix<Real, Eigen::Dynamic, 3, Eigen::RowMajor>> Mdx_matrix_free ((d_Mdx_matrix_free.getValue().data()->data()),  mo->getSize(), 3);
+    EXPECT_LT((Mdx - Mdx_matrix_free).norm() / Mdx.norm(), 1e-12);
+
+    // The matrix-free contribution to the system matrix must be the same as the assembled one
+    SofaCaribou::Algebra::EigenMatrix<Eigen::SparseMatrix<double>> M3;
+    M3.resize((signed) mo->getSize()*3, (signed) mo->getSize()*3);
+    accessor.setGlobalMatrix(&M3);
+    caribou_mass->addMToMatrix(&mechanical_parameters, &accessor);
+    M3.compress();
+
+    EXPECT_LT((M3.matrix() - M2.matrix()).norm() / M2.matrix().norm(), 1e-12);
 }
 
 TEST(CaribouMass, LinearHexahedron) {
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <string>
+
+#include <SofaCaribou/config.h>
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/version.h>
+#include <sofa/simulation/Node.h>
+#include <SofaSimulationGraph/DAGSimulation.h>
+#include <SofaSimulationGraph/SimpleApi.h>
+#include <SofaBaseMechanics/MechanicalObject.h>
+DISABLE_ALL_WARNINGS_END
+
+namespace SofaCaribou::unittest {
+
+/**
+ * Cantilever beam of 15 x 15 x 80 discretized by 2 x 2 x 8 hexahedrons and clamped on its left side (z = 0). The
+ * node #76 is at the center of its free end (z = 80).
+ *
+ * The root node contains the grid, and the child node "meca" contains the mechanical object "mo", the hexahedral
+ * topology "mechanical_topology", a Saint-Venant-Kirchhoff hyperelastic forcefield and the fixed constraint. The ODE
+ * solver, the linear solver and the mass are added by the tests.
+ */
+struct Beam {
+    using MechanicalObject = sofa::component::container::MechanicalObject<sofa::defaulttype::Vec3Types>;
+
+    sofa::simulation::Node::SPtr root;
+    sofa::simulation::Node::SPtr meca;
+    MechanicalObject * mo = nullptr;
+
+    /** Copy of the current positions of the beam nodes. */
+    auto positions() const -> MechanicalObject::VecCoord {
+        return mo->read(sofa::core::ConstVecCoordId::position())->getValue();
+    }
+};
+
+/** Create the beam in a new simulation. */
+inline auto create_beam(const std::string & young_modulus, const std::string & poisson_ratio) -> Beam {
+    using namespace sofa::simpleapi;
+    using sofa::simulation::getSimulation;
+
+    sofa::simulation::setSimulation(new sofa::simulation::graph::DAGSimulation());
+
+    Beam beam;
+    beam.root = getSimulation()->createNewNode("root");
+#if (defined(SOFA_VERSION) && SOFA_VERSION >= 201200)
+    createObject(beam.root, "RequiredPlugin", {{"pluginName", "SofaBoundaryCondition SofaEngine"}});
+#else
+    createObject(beam.root, "RequiredPlugin", {{"pluginName", "SofaComponentAll"}});
+#endif
+#if (defined(SOFA_VERSION) && SOFA_VERSION > 201299)
+    createObject(beam.root, "RequiredPlugin", {{"pluginName", "SofaTopologyMapping"}});
+#endif
+    createObject(beam.root, "RegularGridTopology", {{"name", "grid"}, {"min", "-7.5 -7.5 0"}, {"max", "7.5 7.5 80"}, {"n", "3 3 9"}});
+
+    beam.meca = createChild(beam.root, "meca");
+    beam.mo = dynamic_cast<Beam::MechanicalObject *>(
+        createObject(beam.meca, "MechanicalObject", {{"name", "mo"}, {"src", "@../grid"}}).get()
+    );
+    createObject(beam.meca, "HexahedronSetTopologyContainer", {{"name", "mechanical_topology"}, {"src", "@../grid"}});
+    createObject(beam.meca, "SaintVenantKirchhoffMaterial", {{"young_modulus", young_modulus}, {"poisson_ratio", poisson_ratio}});
+    createObject(beam.meca, "HyperelasticForcefield", {{"topology", "@mechanical_topology"}});
+
+    // Fix the left side of the beam
+    createObject(beam.meca, "BoxROI", {{"name", "fixed_roi"}, {"box", "-7.5 -7.5 -0.9 7.5 7.5 0.1"}});
+    createObject(beam.meca, "FixedConstraint", {{"indices", "@fixed_roi.indices"}});
+
+    return beam;
+}
+
+/**
+ * Apply a downward traction on the free end of the beam, increased by 20% of its total value at every load increment
+ * (the full traction is reached after 5 increments).
+ */
+inline void add_traction(const Beam & beam) {
+    using namespace sofa::simpleapi;
+    createObject(beam.meca, "BoxROI", {{"name", "top_roi"}, {"quad", "@surface_topology.quad"}, {"box", "-7.5 -7.5 79.9 7.5 7.5 80.1"}});
+    createObject(beam.meca, "QuadSetTopologyContainer", {{"name", "traction_container"}, {"quads", "@top_roi.quadInROI"}});
+    createObject(beam.meca, "TractionForcefield", {{"traction", "0 -30 0"}, {"slope", "0.2"}, {"topology", "@traction_container"}});
+}
+
+} // namespace SofaCaribou::unittest
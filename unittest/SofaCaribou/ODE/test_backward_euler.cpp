@@ -1,8 +1,12 @@
 #include <array>
+#include <map>
+#include <string>
 
 #include <SofaCaribou/config.h>
 #include <SofaCaribou/Ode/BackwardEulerODESolver.h>
 
+#include "beam.h"
+
 DISABLE_ALL_WARNINGS_BEGIN
 #include <sofa/version.h>
 #include <sofa/helper/testing/BaseTest.h>
@@ -172,3 +176,142 @@ TEST(BackwardEulerODESolver, Beam) {
 
     getSimulation()->unload(root);
 }
+
+namespace {
+// Simulate the beam falling under the gravity, with a time-dependent load on its free end, during the given number
+// of time steps, and return the final positions
+auto simulate_falling_beam(const std::map<std::string, std::string> & ode_parameters, double dt, unsigned int number_of_steps,
+                           unsigned int & number_of_accepted_steps, unsigned int & number_of_rejected_steps) {
+    auto beam = SofaCaribou::unittest::create_beam("15000", "0.3");
+    auto solver = dynamic_cast<SofaCaribou::ode::BackwardEulerODESolver *>(
+        createObject(beam.meca, "BackwardEulerODESolver", ode_parameters).get()
+    );
+    createObject(beam.meca, "LLTSolver", {{"Backend", "Pardiso"}});
+    createObject(beam.meca, "CaribouMass", {{"topology", "@mechanical_topology"}, {"density", "0.2"}, {"lumped", "true"}});
+
+    // The load on the free end increases linearly with the time
+    createObject(beam.meca, "LinearForceField", {{"points", "76"}, {"times", "0 10"}, {"forces", "0 0 0  0 -100 0"}});
+
+    getSimulation()->init(beam.root.get());
+    for (unsigned int step_id = 0; step_id < number_of_steps; ++step_id) {
+        getSimulation()->animate(beam.root.get(), dt);
+    }
+
+    number_of_accepted_steps = solver->number_of_accepted_steps();
+    number_of_rejected_steps = solver->number_of_rejected_steps();
+    auto positions = beam.positions();
+    getSimulation()->unload(beam.root);
+
+    return positions;
+}
+}
+
+/** Make sure the adaptive sub-steps integrate the time step exactly as fixed time steps of the same size would */
+TEST(BackwardEulerODESolver, AdaptiveTimeStepping) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    std::map<std::string, std::string> parameters = {
+        {"newton_iterations", "10"}, {"correction_tolerance_threshold", "1e-8"}, {"residual_tolerance_threshold", "1e-8"}
+    };
+
+    // Reference: fixed time steps of 0.5
+    unsigned int accepted, rejected;
+    const auto x_reference = simulate_falling_beam(parameters, 0.5, 8, accepted, rejected);
+    EXPECT_EQ(accepted, 8u);
+
+    // Time steps of 1 divided into sub-steps of at most 0.5. The sub-steps of the second half of the time steps must
+    // see the load at their own time.
+    parameters["adaptive_time_stepping"] = "true";
+    parameters["minimum_time_step"] = "0.01";
+    parameters["maximum_time_step"] = "0.5";
+    const auto x = simulate_falling_beam(parameters, 1, 4, accepted, rejected);
+    EXPECT_EQ(accepted, 8u);
+    EXPECT_EQ(rejected, 0u);
+
+    ASSERT_EQ(x.size(), x_reference.size());
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        EXPECT_LE((x[i] - x_reference[i]).norm(), 1e-8) << "Node #" << i;
+    }
+
+    // The beam bends under the gravity and the load
+    EXPECT_LT(x[76][1], 0);
+}
+
+/** Make sure a rejected sub-step restores the state at its beginning before being tried again with a smaller size */
+TEST(BackwardEulerODESolver, RejectedSteps) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    // Two Newton iterations can never reach these tolerances, hence every step fails to converge
+    std::map<std::string, std::string> parameters = {
+        {"newton_iterations", "2"}, {"correction_tolerance_threshold", "1e-30"}, {"residual_tolerance_threshold", "1e-30"}
+    };
+
+    // Reference: fixed time steps of 0.25, each one made of two Newton iterations
+    unsigned int accepted, rejected;
+    const auto x_reference = simulate_falling_beam(parameters, 0.25, 12, accepted, rejected);
+    EXPECT_EQ(accepted, 12u);
+
+    // The first sub-step of 0.5 is rejected and reduced to the minimum of 0.25, where the steps are accepted anyway.
+    // The reduced sub-step is kept for the next time steps.
+    parameters["adaptive_time_stepping"] = "true";
+    parameters["minimum_time_step"] = "0.25";
+    parameters["maximum_time_step"] = "0.5";
+    parameters["reduction_factor"] = "0.5";
+    const auto x = simulate_falling_beam(parameters, 1, 3, accepted, rejected);
+    EXPECT_EQ(rejected, 1u);
+    EXPECT_EQ(accepted, 12u);
+
+    // The two Newton iterations of the rejected step must leave no trace in the solution
+    ASSERT_EQ(x.size(), x_reference.size());
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        EXPECT_LE((x[i] - x_reference[i]).norm(), 1e-8) << "Node #" << i;
+    }
+}
+
+/** Make sure the fused residual gives the same solution than the residual computed with one traversal per term */
+TEST(BackwardEulerODESolver, FusedResidual) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    using MechanicalObject = SofaCaribou::unittest::Beam::MechanicalObject;
+    const auto simulate = [](bool fused, bool with_external_force) {
+        auto beam = SofaCaribou::unittest::create_beam("15000", "0.3");
+        createObject(beam.meca, "BackwardEulerODESolver", {
+            {"newton_iterations", "10"}, {"correction_tolerance_threshold", "1e-8"}, {"residual_tolerance_threshold", "1e-8"},
+            {"rayleigh_stiffness", "0.1"}, {"rayleigh_mass", "0.1"}, {"fused_residual", fused ? "true" : "false"}
+        });
+        createObject(beam.meca, "LLTSolver", {{"Backend", "Pardiso"}});
+        createObject(beam.meca, "CaribouMass", {{"topology", "@mechanical_topology"}, {"density", "0.2"}});
+
+        getSimulation()->init(beam.root.get());
+        for (unsigned int step_id = 0; step_id < 5; ++step_id) {
+            if (with_external_force) {
+                // The external forces of the mechanical object are cleared at the end of every time step
+                sofa::helper::WriteAccessor<sofa::core::objectmodel::Data<MechanicalObject::VecDeriv>> f =
+                    *beam.mo->write(sofa::core::VecDerivId::externalForce());
+                f.resize(beam.mo->getSize());
+                f[76] = MechanicalObject::Deriv(0, -50, 0);
+            }
+            getSimulation()->animate(beam.root.get(), 1);
+        }
+
+        const auto x = beam.positions();
+        getSimulation()->unload(beam.root);
+
+        return std::vector<sofa::type::Vec3>(x.begin(), x.end());
+    };
+
+    const auto positions_without_fusion = simulate(false, true);
+    const auto positions_with_fusion = simulate(true, true);
+
+    ASSERT_EQ(positions_without_fusion.size(), positions_with_fusion.size());
+    for (std::size_t i = 0; i < positions_without_fusion.size(); ++i) {
+        EXPECT_LE((positions_without_fusion[i] - positions_with_fusion[i]).norm(), 1e-6) << "Node #" << i;
+    }
+
+    // The external force must have been applied
+    const auto positions_without_external_force = simulate(true, false);
+    EXPECT_GT((positions_with_fusion[76] - positions_without_external_force[76]).norm(), 1e-3);
+}
@@ -0,0 +1,171 @@
+#include <SofaCaribou/config.h>
+#include <SofaCaribou/Ode/CentralDifferenceODESolver.h>
+#include <SofaCaribou/Ode/StableTimeStepEstimator.h>
+
+#include "beam.h"
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/version.h>
+#include <sofa/helper/testing/BaseTest.h>
+#include <sofa/simulation/Node.h>
+#include <SofaSimulationGraph/DAGSimulation.h>
+#include <SofaSimulationGraph/SimpleApi.h>
+DISABLE_ALL_WARNINGS_END
+
+using namespace sofa::simulation;
+using namespace sofa::simpleapi;
+using namespace sofa::helper::logging;
+using namespace SofaCaribou::unittest;
+
+#if (defined(SOFA_VERSION) && SOFA_VERSION >= 201299)
+using namespace sofa::testing;
+#endif
+
+/** Make sure the critical time step is estimated from the elements and that the time step is sub-cycled */
+TEST(CentralDifferenceODESolver, Beam) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    // The smallest node distance of the 7.5x7.5x10 hexahedrons is 7.5, and the dilatational wave speed is
+    // c = sqrt((lambda + 2mu) / rho) with lambda = E*nu / ((1+nu)(1-2nu)) and mu = E / (2(1+nu))
+    const double E = 15000, nu = 0.3, rho = 0.2;
+    const double lambda = E*nu / ((1+nu)*(1-2*nu));
+    const double mu = E / (2*(1+nu));
+    const double c = std::sqrt((lambda + 2*mu) / rho);
+    const double critical_time_step = 0.9 * 7.5 / c;
+    const auto number_of_sub_steps = static_cast<unsigned int>(std::ceil(0.1 / critical_time_step));
+
+    // Let the beam fall under gravity during 10 time steps of dt, with or without the sub-cycling of the time steps
+    const auto simulate = [](double dt, unsigned int number_of_steps, bool sub_cycling, unsigned int & sub_steps, double & critical_dt) {
+        auto beam = create_beam("15000", "0.3");
+        beam.root->setDt(dt);
+        auto solver = dynamic_cast<SofaCaribou::ode::CentralDifferenceODESolver *>(
+            createObject(beam.meca, "CentralDifferenceODESolver", {{"sub_cycling", sub_cycling ? "true" : "false"}, {"safety_factor", "0.9"}}).get()
+        );
+        createObject(beam.meca, "CaribouMass", {{"topology", "@mechanical_topology"}, {"density", "0.2"}, {"lumped", "true"}});
+
+        getSimulation()->init(beam.root.get());
+        for (unsigned int step = 0; step < number_of_steps; ++step) {
+            getSimulation()->animate(beam.root.get(), dt);
+        }
+
+        sub_steps = solver->number_of_sub_steps();
+        critical_dt = solver->critical_time_step();
+        auto positions = beam.positions();
+        getSimulation()->unload(beam.root);
+        return positions;
+    };
+
+    unsigned int sub_steps;
+    double critical_dt;
+    const auto x = simulate(0.1, 10, true, sub_steps, critical_dt);
+    EXPECT_NEAR(critical_dt, critical_time_step, 1e-10);
+    EXPECT_EQ(sub_steps, number_of_sub_steps);
+
+    // The sub-cycled time steps must give the same solution as the stable time step h = dt / number_of_sub_steps
+    const auto x_reference = simulate(0.1 / number_of_sub_steps, 10*number_of_sub_steps, false, sub_steps, critical_dt);
+    EXPECT_EQ(sub_steps, 1u);
+
+    ASSERT_EQ(x.size(), x_reference.size());
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        EXPECT_LE((x[i] - x_reference[i]).norm(), 1e-8) << "Node #" << i;
+    }
+
+    // The free end of the beam moves downward
+    EXPECT_LT(x[76][1], 0);
+}
+
+/** Make sure the critical time step is taken from the largest eigenvalue of M^-1 K when an estimator is present */
+TEST(CentralDifferenceODESolver, StableTimeStepEstimator) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    auto beam = create_beam("15000", "0.3");
+    beam.root->setDt(0.1);
+    auto solver = dynamic_cast<SofaCaribou::ode::CentralDifferenceODESolver *>(
+        createObject(beam.meca, "CentralDifferenceODESolver", {{"sub_cycling", "true"}, {"safety_factor", "0.9"}}).get()
+    );
+    auto estimator = dynamic_cast<SofaCaribou::ode::StableTimeStepEstimator *>(
+        createObject(beam.meca, "StableTimeStepEstimator", {{"update_interval", "1"}, {"maximum_number_of_iterations", "200"}, {"tolerance", "1e-6"}}).get()
+    );
+    createObject(beam.meca, "CaribouMass", {{"topology", "@mechanical_topology"}, {"density", "0.2"}, {"lumped", "true"}});
+
+    getSimulation()->init(beam.root.get());
+    getSimulation()->animate(beam.root.get(), beam.root->getDt());
+
+    EXPECT_GT(estimator->largest_eigenvalue(), 0);
+    EXPECT_NEAR(estimator->critical_time_step(), 2. / std::sqrt(estimator->largest_eigenvalue()), 1e-10);
+    EXPECT_NEAR(solver->critical_time_step(), 0.9 * estimator->critical_time_step(), 1e-10);
+    EXPECT_EQ(solver->number_of_sub_steps(), static_cast<unsigned int>(std::ceil(0.1 / solver->critical_time_step())));
+    const auto number_of_iterations = estimator->number_of_iterations();
+
+    // The next estimation starts from the previous eigenvector and should converge faster
+    getSimulation()->animate(beam.root.get(), beam.root->getDt());
+    EXPECT_LE(estimator->number_of_iterations(), number_of_iterations);
+
+    getSimulation()->unload(beam.root);
+}
+
+/** Make sure the critical time step of a mass-spring system is its analytic value 2 / sqrt(k/m) */
+TEST(StableTimeStepEstimator, MassSpring) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    setSimulation(new sofa::simulation::graph::DAGSimulation());
+    auto root = getSimulation()->createNewNode("root");
+#if (defined(SOFA_VERSION) && SOFA_VERSION >= 201200)
+    createObject(root, "RequiredPlugin", {{"pluginName", "SofaDeformable"}});
+#else
+    createObject(root, "RequiredPlugin", {{"pluginName", "SofaComponentAll"}});
+#endif
+    root->setDt(1);
+    auto solver = dynamic_cast<SofaCaribou::ode::CentralDifferenceODESolver *>(
+        createObject(root, "CentralDifferenceODESolver", {{"sub_cycling", "true"}, {"safety_factor", "0.9"}}).get()
+    );
+    auto estimator = dynamic_cast<SofaCaribou::ode::StableTimeStepEstimator *>(
+        createObject(root, "StableTimeStepEstimator", {{"tolerance", "1e-12"}}).get()
+    );
+
+    // Two nodes of mass m = 2 attached to their rest positions by springs of stiffness k = 800, hence M^-1 K = 400 I
+    createObject(root, "MechanicalObject", {{"position", "0 0 0  1 0 0"}});
+    createObject(root, "UniformMass", {{"totalMass", "4"}});
+    createObject(root, "RestShapeSpringsForceField", {{"stiffness", "800"}});
+
+    getSimulation()->init(root.get());
+    getSimulation()->animate(root.get(), root->getDt());
+
+    EXPECT_NEAR(estimator->largest_eigenvalue(), 400, 1e-8);
+    EXPECT_NEAR(estimator->critical_time_step(), 0.1, 1e-12);
+
+    // The safety factor is only applied once, by the solver
+    EXPECT_NEAR(solver->critical_time_step(), 0.09, 1e-12);
+    EXPECT_EQ(solver->number_of_sub_steps(), 12u);
+
+    getSimulation()->unload(root);
+}
+
+/** Make sure the user is warned when the critical time step cannot be estimated */
+TEST(CentralDifferenceODESolver, UnknownCriticalTimeStep) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+    EXPECT_MSG_EMIT(Warning);
+
+    setSimulation(new sofa::simulation::graph::DAGSimulation());
+    auto root = getSimulation()->createNewNode("root");
+    root->setDt(1);
+    auto solver = dynamic_cast<SofaCaribou::ode::CentralDifferenceODESolver *>(
+        createObject(root, "CentralDifferenceODESolver", {{"sub_cycling", "true"}}).get()
+    );
+
+    // Without any force field, there is nothing to estimate the critical time step from
+    createObject(root, "MechanicalObject", {{"position", "0 0 0"}});
+    createObject(root, "UniformMass", {{"totalMass", "1"}});
+
+    getSimulation()->init(root.get());
+    getSimulation()->animate(root.get(), root->getDt());
+
+    EXPECT_EQ(solver->critical_time_step(), 0);
+    EXPECT_EQ(solver->number_of_sub_steps(), 1u);
+
+    getSimulation()->unload(root);
+}
@@ -0,0 +1,256 @@
+#include <fstream>
+#include <string>
+
+#include <SofaCaribou/config.h>
+#include <SofaCaribou/Ode/ReducedStaticODESolver.h>
+#include <SofaCaribou/Ode/SnapshotRecorder.h>
+#include <SofaCaribou/Ode/HyperReducible.h>
+#include <SofaCaribou/Algebra/ReducedBasis.h>
+
+#include "beam.h"
+#include "../sofacaribou_test.h"
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/version.h>
+#include <sofa/helper/testing/BaseTest.h>
+#include <sofa/simulation/Node.h>
+#include <SofaSimulationGraph/DAGSimulation.h>
+#include <SofaSimulationGraph/SimpleApi.h>
+#include <SofaBaseMechanics/MechanicalObject.h>
+DISABLE_ALL_WARNINGS_END
+
+using namespace sofa::simulation;
+using namespace sofa::simpleapi;
+using namespace sofa::helper::logging;
+
+#if (defined(SOFA_VERSION) && SOFA_VERSION >= 201299)
+using namespace sofa::testing;
+#endif
+
+/** Make sure that the reduced solver reproduces the full order solution from a basis extracted from its snapshots */
+TEST(ReducedStaticODESolver, Beam) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    // 1. Training: full order simulation, recording the snapshots
+    auto full = SofaCaribou::unittest::create_beam("3000", "0.499");
+    SofaCaribou::unittest::add_traction(full);
+    createObject(full.meca, "StaticODESolver", {{"name", "ode"}, {"newton_iterations", "10"}, {"correction_tolerance_threshold", "1e-10"}, {"residual_tolerance_threshold", "1e-10"}});
+    createObject(full.meca, "LDLTSolver");
+    auto recorder = dynamic_cast<SofaCaribou::ode::SnapshotRecorder *>(
+        createObject(full.meca, "SnapshotRecorder", {{"basis_tolerance", "1e-10"}}).get()
+    );
+
+    getSimulation()->init(full.root.get());
+    for (unsigned int step_id = 0; step_id < 5; ++step_id) {
+        getSimulation()->animate(full.root.get(), 1);
+    }
+
+    EXPECT_EQ(recorder->number_of_snapshots(), 5u);
+    const auto basis = recorder->compute_basis();
+    EXPECT_EQ(basis.rows(), static_cast<Eigen::Index>(full.mo->getMatrixSize()));
+    EXPECT_GT(basis.cols(), 0);
+    EXPECT_LE(basis.cols(), 5);
+    EXPECT_NEAR((basis.transpose()*basis - Eigen::MatrixXd::Identity(basis.cols(), basis.cols())).norm(), 0, 1e-10);
+
+    const auto full_positions = full.positions();
+    getSimulation()->unload(full.root);
+
+    // 2. Online: same load increments, solved in the reduced space
+    auto reduced = SofaCaribou::unittest::create_beam("3000", "0.499");
+    SofaCaribou::unittest::add_traction(reduced);
+    createObject(reduced.meca, "ReducedStaticODESolver", {{"name", "ode"}, {"newton_iterations", "10"}, {"correction_tolerance_threshold", "1e-10"}, {"residual_tolerance_threshold", "1e-10"}});
+    createObject(reduced.meca, "LDLTSolver");
+    auto solver = dynamic_cast<SofaCaribou::ode::ReducedStaticODESolver *>(reduced.meca->getObject("ode"));
+
+    getSimulation()->init(reduced.root.get());
+    solver->set_basis(basis);
+    for (unsigned int step_id = 0; step_id < 5; ++step_id) {
+        getSimulation()->animate(reduced.root.get(), 1);
+        EXPECT_TRUE(solver->converged());
+
+        // The residuals of the reduced iterations are reported
+        EXPECT_FALSE(solver->squared_residuals().empty());
+        EXPECT_EQ(solver->iteration_times().size(), solver->squared_residuals().size());
+    }
+
+    EXPECT_EQ(solver->number_of_reduced_steps(), 5u);
+    EXPECT_EQ(solver->number_of_full_order_steps(), 0u);
+
+    const auto reduced_positions = reduced.positions();
+    ASSERT_EQ(reduced_positions.size(), full_positions.size());
+    for (std::size_t i = 0; i < reduced_positions.size(); ++i) {
+        for (std::size_t j = 0; j < 3; ++j) {
+            EXPECT_NEAR(reduced_positions[i][j], full_positions[i][j], 1e-5);
+        }
+    }
+
+    getSimulation()->unload(reduced.root);
+}
+
+/** Make sure that the increments are solved at full order when the basis does not span the solution */
+TEST(ReducedStaticODESolver, FullOrderFallback) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    auto beam = SofaCaribou::unittest::create_beam("3000", "0.499");
+    SofaCaribou::unittest::add_traction(beam);
+    createObject(beam.meca, "ReducedStaticODESolver", {{"name", "ode"}, {"newton_iterations", "10"}, {"correction_tolerance_threshold", "1e-10"}, {"residual_tolerance_threshold", "1e-10"}});
+    createObject(beam.meca, "LDLTSolver");
+    auto solver = dynamic_cast<SofaCaribou::ode::ReducedStaticODESolver *>(beam.meca->getObject("ode"));
+
+    getSimulation()->init(beam.root.get());
+
+    // A basis made of the first degree of freedom only, which is fixed
+    Eigen::MatrixXd basis = Eigen::MatrixXd::Zero(beam.mo->getMatrixSize(), 1);
+    basis(0, 0) = 1;
+    solver->set_basis(basis);
+
+    getSimulation()->animate(beam.root.get(), 1);
+    EXPECT_TRUE(solver->converged());
+    EXPECT_EQ(solver->number_of_reduced_steps(), 0u);
+    EXPECT_EQ(solver->number_of_full_order_steps(), 1u);
+
+    getSimulation()->unload(beam.root);
+}
+
+/** Make sure that the hyper reduced forcefield reproduces the reduced solution with a subset of its elements */
+TEST(ReducedStaticODESolver, HyperReduction) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    // 1. Training: full order simulation, recording the snapshots
+    auto full = SofaCaribou::unittest::create_beam("3000", "0.499");
+    SofaCaribou::unittest::add_traction(full);
+    createObject(full.meca, "StaticODESolver", {{"name", "ode"}, {"newton_iterations", "10"}, {"correction_tolerance_threshold", "1e-10"}, {"residual_tolerance_threshold", "1e-10"}});
+    createObject(full.meca, "LDLTSolver");
+    auto recorder = dynamic_cast<SofaCaribou::ode::SnapshotRecorder *>(
+        createObject(full.meca, "SnapshotRecorder", {{"basis_tolerance", "1e-10"}}).get()
+    );
+
+    getSimulation()->init(full.root.get());
+    for (unsigned int step_id = 0; step_id < 5; ++step_id) {
+        getSimulation()->animate(full.root.get(), 1);
+    }
+
+    const auto snapshots = recorder->snapshots();
+    const auto basis = recorder->compute_basis();
+    const auto full_positions = full.positions();
+    getSimulation()->unload(full.root);
+
+    // 2. Online: same load increments, solved in the reduced space with the hyper reduced forcefield
+    auto reduced = SofaCaribou::unittest::create_beam("3000", "0.499");
+    SofaCaribou::unittest::add_traction(reduced);
+    createObject(reduced.meca, "ReducedStaticODESolver", {{"name", "ode"}, {"newton_iterations", "10"}, {"correction_tolerance_threshold", "1e-10"}, {"residual_tolerance_threshold", "1e-10"}});
+    createObject(reduced.meca, "LDLTSolver");
+    auto solver = dynamic_cast<SofaCaribou::ode::ReducedStaticODESolver *>(reduced.meca->getObject("ode"));
+    solver->findData("fallback_residual_threshold")->read("-1");
+
+    getSimulation()->init(reduced.root.get());
+    solver->set_basis(basis);
+
+    sofa::core::objectmodel::BaseObject * forcefield = nullptr;
+    SofaCaribou::ode::HyperReducible * hyper_reducible = nullptr;
+    for (auto & object : reduced.meca->object) {
+        if (auto * component = dynamic_cast<SofaCaribou::ode::HyperReducible *>(object.get())) {
+            forcefield = object.get();
+            hyper_reducible = component;
+        }
+    }
+    ASSERT_NE(hyper_reducible, nullptr);
+    EXPECT_FALSE(hyper_reducible->hyper_reduction_is_active());
+    ASSERT_TRUE(hyper_reducible->train_hyper_reduction(snapshots, basis, 1e-8));
+    EXPECT_TRUE(hyper_reducible->hyper_reduction_is_active());
+
+    // The beam has 2x2x8 hexahedrons
+    const auto number_of_integrated_elements = std::stoul(forcefield->findData("number_of_integrated_elements")->getValueString());
+    EXPECT_GT(number_of_integrated_elements, 0u);
+    EXPECT_LT(number_of_integrated_elements, 32u);
+
+    for (unsigned int step_id = 0; step_id < 5; ++step_id) {
+        getSimulation()->animate(reduced.root.get(), 1);
+        EXPECT_TRUE(solver->converged());
+    }
+
+    EXPECT_EQ(solver->number_of_reduced_steps(), 5u);
+
+    const auto reduced_positions = reduced.positions();
+    ASSERT_EQ(reduced_positions.size(), full_positions.size());
+    for (std::size_t i = 0; i < reduced_positions.size(); ++i) {
+        for (std::size_t j = 0; j < 3; ++j) {
+            EXPECT_NEAR(reduced_positions[i][j], full_positions[i][j], 1e-3);
+        }
+    }
+
+    getSimulation()->unload(reduced.root);
+}
+
+/** Make sure that the hyper reduction weights are only used when the node is solved in a reduced space */
+TEST(ReducedStaticODESolver, HyperReductionActivation) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    const auto weights_filename = executable_directory_path + "/hyper_reduction_weights.txt";
+    {
+        std::ofstream file (weights_filename);
+        file << "0 2.5\n17 4.\n";
+    }
+
+    const auto hyper_reduction_is_active = [&](const std::string & ode_solver) {
+        auto beam = SofaCaribou::unittest::create_beam("3000", "0.499");
+        createObject(beam.meca, ode_solver, {{"name", "ode"}});
+        createObject(beam.meca, "LDLTSolver");
+
+        SofaCaribou::ode::HyperReducible * hyper_reducible = nullptr;
+        for (auto & object : beam.meca->object) {
+            if (auto * component = dynamic_cast<SofaCaribou::ode::HyperReducible *>(object.get())) {
+                object->findData("hyper_reduction_weights")->read(weights_filename);
+                hyper_reducible = component;
+            }
+        }
+
+        getSimulation()->init(beam.root.get());
+        const bool is_active = hyper_reducible and hyper_reducible->hyper_reduction_is_active();
+        getSimulation()->unload(beam.root);
+
+        return is_active;
+    };
+
+    EXPECT_TRUE(hyper_reduction_is_active("ReducedStaticODESolver"));
+    {
+        EXPECT_MSG_EMIT(Warning);
+        EXPECT_FALSE(hyper_reduction_is_active("StaticODESolver"));
+    }
+}
+
+/** Make sure that the basis is extracted and written at the end of the last time step of the training */
+TEST(SnapshotRecorder, EndOfTraining) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error, Warning);
+
+    const auto basis_filename = executable_directory_path + "/snapshot_recorder_basis.txt";
+    auto beam = SofaCaribou::unittest::create_beam("3000", "0.499");
+    SofaCaribou::unittest::add_traction(beam);
+    createObject(beam.meca, "StaticODESolver", {{"name", "ode"}, {"newton_iterations", "10"}, {"correction_tolerance_threshold", "1e-10"}, {"residual_tolerance_threshold", "1e-10"}});
+    createObject(beam.meca, "LDLTSolver");
+    auto recorder = dynamic_cast<SofaCaribou::ode::SnapshotRecorder *>(
+        createObject(beam.meca, "SnapshotRecorder", {{"basis_tolerance", "1e-10"}, {"basis_filename", basis_filename}, {"number_of_steps", "3"}}).get()
+    );
+
+    getSimulation()->init(beam.root.get());
+    for (unsigned int step_id = 0; step_id < 2; ++step_id) {
+        getSimulation()->animate(beam.root.get(), 1);
+    }
+    EXPECT_EQ(recorder->basis_size(), 0u);
+
+    getSimulation()->animate(beam.root.get(), 1);
+    EXPECT_EQ(recorder->number_of_snapshots(), 3u);
+    EXPECT_GT(recorder->basis_size(), 0u);
+
+    Eigen::MatrixXd basis;
+    ASSERT_TRUE(SofaCaribou::Algebra::read_column_vectors(basis_filename, basis));
+    EXPECT_EQ(basis.cols(), static_cast<Eigen::Index>(recorder->basis_size()));
+    EXPECT_NEAR((basis - recorder->compute_basis()).norm(), 0, 1e-10);
+
+    getSimulation()->unload(beam.root);
+}
@@ -1,8 +1,12 @@
 #include <array>
+#include <deque>
+#include <vector>
 
 #include <SofaCaribou/config.h>
 #include <SofaCaribou/Ode/StaticODESolver.h>
 
+#include "beam.h"
+
 DISABLE_ALL_WARNINGS_BEGIN
 #include <sofa/version.h>
 #include <sofa/helper/testing/BaseTest.h>
@@ -148,4 +152,136 @@ TEST(StaticODESolver, Beam) {
     EXPECT_NEAR(middle_point[2],  76.190, 1e-3); // z
 
     getSimulation()->unload(root);
-}
\ No newline at end of file
+}
+
+/** Make sure the predicted solution increments give the same solution with fewer Newton iterations */
+TEST(StaticODESolver, Predictor) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    // Simulate the beam of the previous test during 5 load increments, and return the final positions with the total
+    // number of Newton iterations
+    const auto simulate = [](const std::string & predictor, double & iterations_saved) {
+        auto beam = SofaCaribou::unittest::create_beam("3000", "0.499");
+        SofaCaribou::unittest::add_traction(beam);
+        auto solver = dynamic_cast<SofaCaribou::ode::StaticODESolver *>(
+            createObject(beam.meca, "StaticODESolver", {{"newton_iterations", "20"}, {"correction_tolerance_threshold", "1e-10"}, {"residual_tolerance_threshold", "1e-10"}, {"predictor", predictor}}).get()
+        );
+        createObject(beam.meca, "LDLTSolver");
+
+        getSimulation()->init(beam.root.get());
+
+        std::size_t number_of_iterations = 0;
+        for (unsigned int step_id = 0; step_id < 5; ++step_id) {
+            getSimulation()->animate(beam.root.get(), 1);
+            EXPECT_TRUE(solver->converged());
+            number_of_iterations += solver->squared_residuals().size();
+        }
+
+        iterations_saved = solver->newton_iterations_saved();
+        auto positions = beam.positions();
+        getSimulation()->unload(beam.root);
+
+        return std::make_pair(positions, number_of_iterations);
+    };
+
+    double iterations_saved_without_predictor, iterations_saved_with_predictor;
+    const auto [positions_without_predictor, iterations_without_predictor] = simulate("NONE", iterations_saved_without_predictor);
+    const auto [positions_with_predictor, iterations_with_predictor] = simulate("LINEAR", iterations_saved_with_predictor);
+
+    EXPECT_EQ(iterations_saved_without_predictor, 0);
+    EXPECT_LT(iterations_with_predictor, iterations_without_predictor);
+    EXPECT_GT(iterations_saved_with_predictor, 0);
+
+    ASSERT_EQ(positions_with_predictor.size(), positions_without_predictor.size());
+    for (std::size_t i = 0; i < positions_with_predictor.size(); ++i) {
+        for (std::size_t j = 0; j < 3; ++j) {
+            EXPECT_NEAR(positions_with_predictor[i][j], positions_without_predictor[i][j], 1e-5);
+        }
+    }
+}
+
+/** Predicted increments with unequal time steps */
+TEST(StaticODESolver, PredictorWeights) {
+    using Predictor = SofaCaribou::ode::NewtonRaphsonSolver::Predictor;
+    using SofaCaribou::ode::NewtonRaphsonSolver;
+
+    // Previous steps [-0.5, 0], [-1.5, -0.5] and [-1.75, -1.5] (the most recent first), and the new step [0, 0.25]
+    const std::deque<SReal> previous_dt {0.5, 1., 0.25};
+    const SReal dt = 0.25;
+
+    // Increments of the previous steps and of the new step for the displacement u(t)
+    const auto increments = [&](const auto & u) {
+        std::vector<SReal> U;
+        SReal end_of_step = 0;
+        for (const auto & h : previous_dt) {
+            U.emplace_back(u(end_of_step) - u(end_of_step - h));
+            end_of_step -= h;
+        }
+        return std::make_pair(U, u(dt) - u(0.));
+    };
+
+    const auto predict = [&](const Predictor & predictor, const std::vector<SReal> & U) {
+        const auto weights = NewtonRaphsonSolver::predictor_weights(predictor, dt, previous_dt);
+        SReal prediction = 0;
+        for (std::size_t i = 0; i < weights.size(); ++i) {
+            prediction += weights[i] * U[i];
+        }
+        return prediction;
+    };
+
+    EXPECT_TRUE(NewtonRaphsonSolver::predictor_weights(Predictor::NONE, dt, previous_dt).empty());
+    EXPECT_TRUE(NewtonRaphsonSolver::predictor_weights(Predictor::LINEAR, dt, {}).empty());
+
+    // The secant prediction is exact for a constant rate
+    {
+        const auto [U, expected] = increments([](const SReal & t) { return 3*t + 1; });
+        EXPECT_EQ(NewtonRaphsonSolver::predictor_weights(Predictor::SECANT, dt, previous_dt).size(), 1u);
+        EXPECT_NEAR(predict(Predictor::SECANT, U), expected, 1e-12);
+    }
+
+    // The linear prediction is exact for a linear rate (quadratic displacement): w = {0.75, -0.125}
+    {
+        const auto weights = NewtonRaphsonSolver::predictor_weights(Predictor::LINEAR, dt, previous_dt);
+        ASSERT_EQ(weights.size(), 2u);
+        EXPECT_NEAR(weights[0], 0.75, 1e-12);
+        EXPECT_NEAR(weights[1], -0.125, 1e-12);
+
+        const auto [U, expected] = increments([](const SReal & t) { return t*t; });
+        EXPECT_NEAR(expected, 0.0625, 1e-12);
+        EXPECT_NEAR(predict(Predictor::LINEAR, U), expected, 1e-12);
+    }
+
+    // The quadratic prediction extrapolates the mean rates U_i / h_i of the steps, placed at their middle, with a parabola
+    {
+        const auto r = [](const SReal & t) { return 2*t*t - t + 5; };
+        const std::vector<SReal> U {0.5 * r(-0.25), 1. * r(-1.), 0.25 * r(-1.625)};
+        EXPECT_EQ(NewtonRaphsonSolver::predictor_weights(Predictor::QUADRATIC, dt, previous_dt).size(), 3u);
+        EXPECT_NEAR(predict(Predictor::QUADRATIC, U), dt * r(dt / 2.), 1e-12);
+
+        // And remains exact for a linear rate (quadratic displacement)
+        const auto [U2, expected] = increments([](const SReal & t) { return t*t; });
+        EXPECT_NEAR(predict(Predictor::QUADRATIC, U2), expected, 1e-12);
+    }
+
+    // The order is reduced while the history is filled
+    EXPECT_EQ(NewtonRaphsonSolver::predictor_weights(Predictor::QUADRATIC, dt, {0.5, 1.}).size(), 2u);
+
+    // State values (for example, accelerations) placed at the end of their step are extrapolated without scaling
+    {
+        const auto a = [](const SReal & t) { return 2*t*t - t + 5; };
+        const std::vector<SReal> values {a(0.), a(-0.5), a(-1.5)};
+        const auto predict_value = [&](const Predictor & predictor) {
+            const auto weights = NewtonRaphsonSolver::predictor_weights(predictor, dt, previous_dt, false);
+            SReal prediction = 0;
+            for (std::size_t i = 0; i < weights.size(); ++i) {
+                prediction += weights[i] * values[i];
+            }
+            return prediction;
+        };
+
+        EXPECT_NEAR(predict_value(Predictor::SECANT), a(0.), 1e-12);
+        EXPECT_NEAR(predict_value(Predictor::LINEAR), a(0.) + dt * (a(0.) - a(-0.5)) / 0.5, 1e-12);
+        EXPECT_NEAR(predict_value(Predictor::QUADRATIC), a(dt), 1e-12);
+    }
+}
@@ -0,0 +1,212 @@
+#include <string>
+#include <vector>
+
+#include <SofaCaribou/config.h>
+#include <SofaCaribou/Solver/EigenSolver.inl>
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/version.h>
+#include <sofa/helper/testing/BaseTest.h>
+#include <sofa/simulation/Node.h>
+#include <sofa/simulation/MechanicalOperations.h>
+#include <SofaSimulationGraph/DAGSimulation.h>
+#include <SofaSimulationGraph/SimpleApi.h>
+#include <SofaBaseMechanics/MechanicalObject.h>
+DISABLE_ALL_WARNINGS_END
+
+using namespace sofa::simulation;
+using namespace sofa::simpleapi;
+using namespace sofa::helper::logging;
+
+#if (defined(SOFA_VERSION) && SOFA_VERSION >= 201299)
+using namespace sofa::testing;
+#endif
+
+namespace {
+using SparseMatrix = Eigen::SparseMatrix<FLOATING_POINT_TYPE, Eigen::ColMajor, int>;
+using EigenSolver = SofaCaribou::solver::EigenSolver<SparseMatrix>;
+using MechanicalObject = sofa::component::container::MechanicalObject<sofa::defaulttype::Vec3Types>;
+
+// Cube of 2 x 2 x 2 hexahedrons for which the internal forces are computed on a mechanical state mapped (identity
+// mapping) from the top level one. The stiffness matrix of the system is hence only made of a mapped matrix.
+struct MappedCube {
+    Node::SPtr root;
+    EigenSolver * solver = nullptr;
+    MechanicalObject * mo = nullptr;
+    MechanicalObject * mapped_mo = nullptr;
+};
+
+auto create_mapped_cube() -> MappedCube {
+    setSimulation(new sofa::simulation::graph::DAGSimulation());
+
+    MappedCube cube;
+    cube.root = getSimulation()->createNewNode("root");
+    createObject(cube.root, "RegularGridTopology", {{"name", "grid"}, {"min", "0 0 0"}, {"max", "1 1 1"}, {"n", "3 3 3"}});
+
+    auto meca = createChild(cube.root, "meca");
+    cube.solver = dynamic_cast<EigenSolver *>(createObject(meca, "LDLTSolver").get());
+    cube.mo = dynamic_cast<MechanicalObject *>(createObject(meca, "MechanicalObject", {{"name", "mo"}, {"src", "@../grid"}}).get());
+
+    auto mapped = createChild(meca, "mapped");
+    cube.mapped_mo = dynamic_cast<MechanicalObject *>(createObject(mapped, "MechanicalObject", {{"name", "mapped_mo"}, {"src", "@../../grid"}}).get());
+    createObject(mapped, "HexahedronSetTopologyContainer", {{"name", "topology"}, {"src", "@../../grid"}});
+    createObject(mapped, "SaintVenantKirchhoffMaterial", {{"young_modulus", "3000"}, {"poisson_ratio", "0.3"}});
+    createObject(mapped, "HyperelasticForcefield", {{"topology", "@topology"}});
+    createObject(mapped, "IdentityMapping", {{"input", "@../mo"}, {"output", "@mapped_mo"}});
+
+    getSimulation()->init(cube.root.get());
+
+    return cube;
+}
+
+// Independent cubes of 2 x 2 x 2 hexahedrons clamped on their x = 0 face, each one in its own child node of the
+// node containing the linear solver. The system hence has one top level mechanical state per cube.
+struct Cubes {
+    Node::SPtr root;
+    EigenSolver * solver = nullptr;
+    std::vector<MechanicalObject *> mos;
+};
+
+auto create_cubes(std::size_t number_of_cubes) -> Cubes {
+    setSimulation(new sofa::simulation::graph::DAGSimulation());
+
+    Cubes cubes;
+    cubes.root = getSimulation()->createNewNode("root");
+#if (defined(SOFA_VERSION) && SOFA_VERSION >= 201200)
+    createObject(cubes.root, "RequiredPlugin", {{"pluginName", "SofaBoundaryCondition SofaEngine"}});
+#else
+    createObject(cubes.root, "RequiredPlugin", {{"pluginName", "SofaComponentAll"}});
+#endif
+    createObject(cubes.root, "RegularGridTopology", {{"name", "grid"}, {"min", "0 0 0"}, {"max", "1 1 1"}, {"n", "3 3 3"}});
+
+    auto system = createChild(cubes.root, "system");
+    cubes.solver = dynamic_cast<EigenSolver *>(createObject(system, "LDLTSolver").get());
+
+    for (std::size_t i = 0; i < number_of_cubes; ++i) {
+        auto cube = createChild(system, "cube_" + std::to_string(i));
+        cubes.mos.emplace_back(dynamic_cast<MechanicalObject *>(createObject(cube, "MechanicalObject", {{"name", "mo"}, {"src", "@../../grid"}}).get()));
+        createObject(cube, "HexahedronSetTopologyContainer", {{"name", "topology"}, {"src", "@../../grid"}});
+        createObject(cube, "SaintVenantKirchhoffMaterial", {{"young_modulus", "3000"}, {"poisson_ratio", "0.3"}});
+        createObject(cube, "HyperelasticForcefield", {{"topology", "@topology"}});
+        createObject(cube, "BoxROI", {{"name", "fixed_roi"}, {"box", "-0.1 -0.1 -0.1 0.1 1.1 1.1"}});
+        createObject(cube, "FixedConstraint", {{"indices", "@fixed_roi.indices"}});
+    }
+
+    getSimulation()->init(cubes.root.get());
+
+    return cubes;
+}
+
+// Solve K dx = f for every cube, where f pulls each node downward proportionally to its distance to the clamped face
+void solve(const Cubes & cubes) {
+    sofa::core::MechanicalParams mechanical_parameters;
+    mechanical_parameters.setKFactor(1.);
+    cubes.solver->setSystemMBKMatrix(&mechanical_parameters);
+
+    for (auto * mo : cubes.mos) {
+        const auto & x = mo->read(sofa::core::ConstVecCoordId::position())->getValue();
+        auto f = sofa::helper::write(*mo->write(sofa::core::VecDerivId::force()));
+        for (std::size_t i = 0; i < x.size(); ++i) {
+            f[i] = MechanicalObject::Deriv(0, -x[i][0], 0);
+        }
+    }
+
+    cubes.solver->setSystemRHVector(sofa::core::VecDerivId::force());
+    cubes.solver->setSystemLHVector(sofa::core::VecDerivId::dx());
+    cubes.solver->solveSystem();
+}
+
+// Concatenation of the given vector of every cube
+auto gather(const Cubes & cubes, sofa::core::ConstVecDerivId id) -> Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, 1> {
+    Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, 1> v (static_cast<Eigen::Index>(3*cubes.mos.size()*cubes.mos[0]->getSize()));
+    Eigen::Index offset = 0;
+    for (const auto * mo : cubes.mos) {
+        for (const auto & node : mo->read(id)->getValue()) {
+            for (std::size_t j = 0; j < 3; ++j) {
+                v[offset++] = node[j];
+            }
+        }
+    }
+    return v;
+}
+
+// Assemble the stiffness matrix of the cube at the given positions
+auto assemble_stiffness(const MappedCube & cube, const MechanicalObject::VecCoord & x) -> SparseMatrix {
+    cube.mo->write(sofa::core::VecCoordId::position())->setValue(x);
+    cube.mapped_mo->write(sofa::core::VecCoordId::position())->setValue(x);
+
+    sofa::core::MechanicalParams mechanical_parameters;
+    mechanical_parameters.setKFactor(1.);
+
+    // The hyperelastic forcefield updates its stiffness matrix with its internal forces
+    sofa::simulation::common::MechanicalOperations mop (&mechanical_parameters, cube.root.get());
+    mop.computeForce(sofa::core::MultiVecDerivId(sofa::core::VecDerivId::force()));
+
+    cube.solver->assemble(&mechanical_parameters);
+    return cube.solver->A()->matrix();
+}
+}
+
+/** Make sure that the mapped matrices of a previous assembly are not accumulated into the next one */
+TEST(EigenSolver, MappedStateReassembly) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    auto cube = create_mapped_cube();
+    const auto x0 = cube.mo->read(sofa::core::ConstVecCoordId::position())->getValue();
+
+    // Bend the cube
+    auto x = x0;
+    for (auto & p : x) {
+        p[1] += 0.2 * p[0] * p[0];
+    }
+
+    // Assemble at rest, and then at the deformed positions
+    assemble_stiffness(cube, x0);
+    const SparseMatrix K = assemble_stiffness(cube, x);
+    getSimulation()->unload(cube.root);
+
+    // First assembly of a new system at the deformed positions
+    auto fresh_cube = create_mapped_cube();
+    const SparseMatrix K_reference = assemble_stiffness(fresh_cube, x);
+    getSimulation()->unload(fresh_cube.root);
+
+    ASSERT_EQ(K.rows(), static_cast<Eigen::Index>(3*x0.size()));
+    ASSERT_EQ(K_reference.rows(), K.rows());
+    EXPECT_GT(K_reference.norm(), 0);
+    EXPECT_LE((K - K_reference).norm(), 1e-10 * K_reference.norm());
+}
+
+/**
+ * Make sure that the right-hand side and solution vectors mapped from the single top level mechanical state give the
+ * same solution as the vectors copied by the matrix accessor when the system has more than one top level state.
+ */
+TEST(EigenSolver, MappedAndCopiedVectors) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    // Single top level mechanical state, the vectors are mapped
+    auto single = create_cubes(1);
+    solve(single);
+    const auto f = gather(single, sofa::core::ConstVecDerivId::force());
+    const auto dx = gather(single, sofa::core::ConstVecDerivId::dx());
+    const Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, Eigen::Dynamic> K = single.solver->A()->matrix();
+    getSimulation()->unload(single.root);
+
+    // The right-hand side must not be modified by the solve, and the solution must be written back in place
+    ASSERT_GT(f.norm(), 0);
+    EXPECT_LE((K*dx - f).norm(), 1e-10 * f.norm());
+
+    // Two top level mechanical states, the vectors are copied
+    auto two = create_cubes(2);
+    solve(two);
+    const auto f_copied = gather(two, sofa::core::ConstVecDerivId::force());
+    const auto dx_copied = gather(two, sofa::core::ConstVecDerivId::dx());
+    getSimulation()->unload(two.root);
+
+    ASSERT_EQ(dx_copied.size(), 2*dx.size());
+    EXPECT_LE((f_copied.head(f.size()) - f).norm(), 1e-10 * f.norm());
+    EXPECT_LE((f_copied.tail(f.size()) - f).norm(), 1e-10 * f.norm());
+    EXPECT_LE((dx_copied.head(dx.size()) - dx).norm(), 1e-10 * dx.norm());
+    EXPECT_LE((dx_copied.tail(dx.size()) - dx).norm(), 1e-10 * dx.norm());
+}